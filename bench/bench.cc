@@ -0,0 +1,240 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// runner of the benchmarks in bench/, see bench.h
+#include <unistd.h>
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "gflags/gflags.h"
+
+#include "utils.h"
+#include "timer.h"
+#include "bench.h"
+
+DEFINE_string(bench_filter, "",
+              "run the benchmarks whose name contains this string");
+DEFINE_double(bench_min_time, 0.5,
+              "minimum time of the measured loop per benchmark (sec)");
+DEFINE_string(bench_json, "",
+              "write the results as JSON (google benchmark format) here");
+
+namespace lamp_search {
+namespace bench {
+
+void State::PauseTiming() {
+  wall_ += FastClock::Now() - start_wall_;
+  cpu_ += FastClock::Cpu() - start_cpu_;
+}
+
+void State::ResumeTiming() {
+  start_wall_ = FastClock::Now();
+  start_cpu_ = FastClock::Cpu();
+}
+
+Benchmark * Benchmark::Args(long long int a0) {
+  args_.push_back(std::vector<long long int>(1, a0));
+  return this;
+}
+
+Benchmark * Benchmark::Args(long long int a0, long long int a1) {
+  Args(a0);
+  args_.back().push_back(a1);
+  return this;
+}
+
+Benchmark * Benchmark::Args(long long int a0, long long int a1,
+                            long long int a2) {
+  Args(a0, a1);
+  args_.back().push_back(a2);
+  return this;
+}
+
+namespace {
+
+std::vector<Benchmark *> & Registry() {
+  static std::vector<Benchmark *> registry;
+  return registry;
+}
+
+struct Result {
+  std::string name;
+  long long int iterations;
+  double real_time; // nano sec per iteration
+  double cpu_time;
+  double items_per_second; // 0 if not set
+  double bytes_per_second;
+  std::string label;
+};
+
+std::string Name(const Benchmark & b, const std::vector<long long int> & args) {
+  std::stringstream name;
+  name << b.Name();
+  for (std::size_t i = 0; i < args.size(); i++)
+    name << "/" << args[i];
+  return name.str();
+}
+
+Result Run(const Benchmark & b, const std::vector<long long int> & args) {
+  const double min_time = FLAGS_bench_min_time * GIGA;
+  long long int iterations = 1;
+  while (true) {
+    State state(args, iterations);
+    b.Func()(state);
+    long long int wall = state.Wall();
+    long long int cpu = state.Cpu();
+
+    if (wall >= min_time || iterations >= 1000000000ll) {
+      Result r;
+      r.name = Name(b, args);
+      r.iterations = iterations;
+      r.real_time = (double) wall / iterations;
+      r.cpu_time = (double) cpu / iterations;
+      double sec = std::max((double) wall, 1.0) / GIGA;
+      r.items_per_second = state.ItemsProcessed() / sec;
+      r.bytes_per_second = state.BytesProcessed() / sec;
+      r.label = state.Label();
+      return r;
+    }
+    // as google benchmark: aim at 1.4 times min_time, at most 10 times more
+    double multiplier = (wall > 0) ? 1.4 * min_time / wall : 10.0;
+    multiplier = std::min(std::max(multiplier, 1.5), 10.0);
+    iterations = (long long int) (iterations * multiplier) + 1;
+  }
+}
+
+std::string Quote(const std::string & s) {
+  std::string q = "\"";
+  for (std::size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '"' || s[i] == '\\')
+      q += '\\';
+    q += s[i];
+  }
+  return q + "\"";
+}
+
+void WriteJson(std::ostream & out, const std::vector<Result> & results,
+               const char * executable) {
+  char host[256] = "";
+  gethostname(host, sizeof(host) - 1);
+  char date[64] = "";
+  std::time_t now = std::time(NULL);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+                std::localtime(&now));
+
+  out << std::setprecision(6) << "{\n  \"context\": {\n"
+      << "    \"date\": " << Quote(date) << ",\n"
+      << "    \"host_name\": " << Quote(host) << ",\n"
+      << "    \"executable\": " << Quote(executable) << ",\n"
+      << "    \"num_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n"
+      << "    \"tsc_clock\": " << (FastClock::UsesTsc() ? "true" : "false")
+      << ",\n"
+#ifdef NDEBUG
+      << "    \"library_build_type\": \"release\"\n"
+#else
+      << "    \"library_build_type\": \"debug\"\n"
+#endif
+      << "  },\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const Result & r = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\n"
+        << "      \"name\": " << Quote(r.name) << ",\n"
+        << "      \"run_name\": " << Quote(r.name) << ",\n"
+        << "      \"run_type\": \"iteration\",\n"
+        << "      \"iterations\": " << r.iterations << ",\n"
+        << "      \"real_time\": " << std::fixed << r.real_time << ",\n"
+        << "      \"cpu_time\": " << r.cpu_time << ",\n"
+        << "      \"time_unit\": \"ns\"";
+    if (r.items_per_second > 0.0)
+      out << ",\n      \"items_per_second\": " << r.items_per_second;
+    if (r.bytes_per_second > 0.0)
+      out << ",\n      \"bytes_per_second\": " << r.bytes_per_second;
+    if (!r.label.empty())
+      out << ",\n      \"label\": " << Quote(r.label);
+    out << std::defaultfloat << "\n    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+Benchmark * Register(const std::string & name, Function f) {
+  Benchmark * b = new Benchmark(name, f);
+  Registry().push_back(b);
+  return b;
+}
+
+} // namespace bench
+} // namespace lamp_search
+
+using namespace lamp_search;
+using namespace lamp_search::bench;
+
+int main(int argc, char ** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<Result> results;
+  std::cout << std::left << std::setw(44) << "# benchmark" << std::right
+            << std::setw(14) << "wall (ns)" << std::setw(14) << "cpu (ns)"
+            << std::setw(12) << "iterations" << std::setw(14) << "items/s"
+            << std::endl;
+  for (std::size_t i = 0; i < Registry().size(); i++) {
+    const Benchmark & b = *Registry()[i];
+    std::vector<std::vector<long long int> > args = b.ArgList();
+    if (args.empty())
+      args.push_back(std::vector<long long int>());
+    for (std::size_t k = 0; k < args.size(); k++) {
+      if (Name(b, args[k]).find(FLAGS_bench_filter) == std::string::npos)
+        continue;
+      Result r = Run(b, args[k]);
+      results.push_back(r);
+      std::cout << std::left << std::setw(44) << r.name << std::right
+                << std::fixed << std::setprecision(1) << std::setw(14)
+                << r.real_time << std::setw(14) << r.cpu_time
+                << std::setw(12) << r.iterations << std::setw(14)
+                << std::scientific << std::setprecision(3)
+                << r.items_per_second << " " << r.label << std::endl;
+    }
+  }
+
+  if (!FLAGS_bench_json.empty()) {
+    std::ofstream ofs(FLAGS_bench_json.c_str());
+    if (!ofs) {
+      std::cerr << "cannot write " << FLAGS_bench_json << std::endl;
+      return 1;
+    }
+    WriteJson(ofs, results, argv[0]);
+  }
+  return 0;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _LAMP_SEARCH_BENCH_H_
+#define _LAMP_SEARCH_BENCH_H_
+
+#include <string>
+#include <vector>
+
+namespace lamp_search {
+namespace bench {
+
+// Small harness in the manner of google benchmark:
+//
+//   void BM_Foo(State & state) {
+//     setup...
+//     while (state.KeepRunning()) kernel...
+//   }
+//
+// only the loop is timed. The runner raises the number of iterations until
+// the loop takes --bench_min_time, and reports wall and cpu time per
+// iteration. --bench_json writes the results in the JSON format of google
+// benchmark, so the usual comparison scripts work on them.
+class State {
+ public:
+  State(const std::vector<long long int> & args, long long int iterations)
+      : args_(args), iterations_(iterations), done_(0ll),
+        items_(0ll), bytes_(0ll), start_wall_(0ll), start_cpu_(0ll),
+        wall_(0ll), cpu_(0ll) {}
+
+  // true iterations times. the time runs from the first call to the last
+  bool KeepRunning() {
+    if (done_ == 0ll) ResumeTiming();
+    if (done_ < iterations_) {
+      done_++;
+      return true;
+    }
+    PauseTiming();
+    return false;
+  }
+
+  long long int Iterations() const { return iterations_; }
+  long long int Arg(std::size_t i) const { return args_[i]; }
+
+  // per run (all iterations), for items_per_second and bytes_per_second
+  void SetItemsProcessed(long long int n) { items_ = n; }
+  void SetBytesProcessed(long long int n) { bytes_ = n; }
+  void SetLabel(const std::string & label) { label_ = label; }
+
+  // exclude setup inside the loop from the time
+  void PauseTiming();
+  void ResumeTiming();
+
+  long long int ItemsProcessed() const { return items_; }
+  long long int BytesProcessed() const { return bytes_; }
+  const std::string & Label() const { return label_; }
+  // nano sec in the loop
+  long long int Wall() const { return wall_; }
+  long long int Cpu() const { return cpu_; }
+
+ private:
+  std::vector<long long int> args_;
+  long long int iterations_;
+  long long int done_;
+  long long int items_;
+  long long int bytes_;
+  std::string label_;
+  long long int start_wall_;
+  long long int start_cpu_;
+  long long int wall_;
+  long long int cpu_;
+};
+
+typedef void (*Function)(State & state);
+
+class Benchmark {
+ public:
+  Benchmark(const std::string & name, Function f) : name_(name), f_(f) {}
+
+  // one run per Args call, named name/arg0/arg1...
+  Benchmark * Args(long long int a0);
+  Benchmark * Args(long long int a0, long long int a1);
+  Benchmark * Args(long long int a0, long long int a1, long long int a2);
+
+  const std::string & Name() const { return name_; }
+  Function Func() const { return f_; }
+  const std::vector<std::vector<long long int> > & ArgList() const {
+    return args_;
+  }
+
+ private:
+  std::string name_;
+  Function f_;
+  std::vector<std::vector<long long int> > args_;
+};
+
+Benchmark * Register(const std::string & name, Function f);
+
+// deterministic data for the benchmarks (xorshift64)
+class Random {
+ public:
+  explicit Random(unsigned long long int seed) : x_(seed ? seed : 1ull) {}
+  unsigned long long int Next() {
+    x_ ^= x_ << 13;
+    x_ ^= x_ >> 7;
+    x_ ^= x_ << 17;
+    return x_;
+  }
+  // true with probability permille / 1000
+  bool Bernoulli(int permille) { return (int) (Next() % 1000) < permille; }
+
+ private:
+  unsigned long long int x_;
+};
+
+// keeps the compiler from removing the computation of value
+template<typename T>
+inline void DoNotOptimize(const T & value) {
+  asm volatile("" : : "g"(value) : "memory");
+}
+
+} // namespace bench
+} // namespace lamp_search
+
+#define LAMP_BENCH_CONCAT2(a, b) a##b
+#define LAMP_BENCH_CONCAT(a, b) LAMP_BENCH_CONCAT2(a, b)
+// LAMP_BENCHMARK(BM_Foo)->Args(1)->Args(2);
+#define LAMP_BENCHMARK(f)                                               \
+  static ::lamp_search::bench::Benchmark * LAMP_BENCH_CONCAT(           \
+      bench_registered_, __LINE__) __attribute__((unused)) =            \
+      ::lamp_search::bench::Register(#f, f)
+
+#endif // _LAMP_SEARCH_BENCH_H_
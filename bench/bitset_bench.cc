@@ -0,0 +1,125 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// VariableBitsetHelper kernels over widths (bits) and densities (permille)
+#include <sstream>
+
+#include "variable_bitset_array.h"
+#include "bench.h"
+
+using namespace lamp_search;
+using namespace lamp_search::bench;
+
+namespace {
+
+// two random bitsets of state.Arg(0) bits with state.Arg(1) permille set
+struct BitsetPair {
+  explicit BitsetPair(const State & state)
+      : bsh(state.Arg(0)), a(bsh.New()), b(bsh.New()), c(bsh.New()) {
+    Random r(state.Arg(0) * 1000 + state.Arg(1));
+    for (std::size_t i = 0; i < bsh.nu_bits; i++) {
+      if (r.Bernoulli(state.Arg(1))) bsh.Doset(i, a);
+      if (r.Bernoulli(state.Arg(1))) bsh.Doset(i, b);
+    }
+  }
+  ~BitsetPair() {
+    bsh.Delete(a);
+    bsh.Delete(b);
+    bsh.Delete(c);
+  }
+  void SetCounters(State & state) const {
+    state.SetItemsProcessed(state.Iterations());
+    state.SetBytesProcessed(state.Iterations() * 2 * bsh.NuBlocks() *
+                            sizeof(uint64));
+  }
+
+  VariableBitsetHelper<uint64> bsh;
+  uint64 * a;
+  uint64 * b;
+  uint64 * c;
+};
+
+void BM_BitsetAnd(State & state) {
+  BitsetPair p(state);
+  while (state.KeepRunning()) {
+    p.bsh.Copy(p.b, p.c);
+    p.bsh.And(p.a, p.c);
+    DoNotOptimize(p.c[0]);
+  }
+  p.SetCounters(state);
+}
+
+void BM_BitsetAndCount(State & state) {
+  BitsetPair p(state);
+  std::size_t sum = 0;
+  while (state.KeepRunning()) {
+    sum += p.bsh.AndCount(p.a, p.b);
+    DoNotOptimize(sum);
+  }
+  p.SetCounters(state);
+}
+
+// the kernel of the child support in the search: copy parent, and, count
+void BM_BitsetAndCountUpdate(State & state) {
+  BitsetPair p(state);
+  std::size_t sum = 0;
+  while (state.KeepRunning()) {
+    p.bsh.Copy(p.b, p.c);
+    sum += p.bsh.AndCountUpdate(p.a, p.c);
+    DoNotOptimize(sum);
+  }
+  p.SetCounters(state);
+}
+
+// a & b is a subset of a, so every block is scanned (the worst case)
+void BM_BitsetIsSubsetOf(State & state) {
+  BitsetPair p(state);
+  p.bsh.Copy(p.b, p.c);
+  p.bsh.And(p.a, p.c);
+  int n = 0;
+  while (state.KeepRunning()) {
+    n += p.bsh.IsSubsetOf(p.c, p.a);
+    DoNotOptimize(n);
+  }
+  p.SetCounters(state);
+}
+
+#define BITSET_ARGS(b)                                                  \
+  Args(64, b)->Args(1024, b)->Args(16384, b)->Args(262144, b)
+
+LAMP_BENCHMARK(BM_BitsetAnd)
+    ->BITSET_ARGS(10)->BITSET_ARGS(100)->BITSET_ARGS(500);
+LAMP_BENCHMARK(BM_BitsetAndCount)
+    ->BITSET_ARGS(10)->BITSET_ARGS(100)->BITSET_ARGS(500);
+LAMP_BENCHMARK(BM_BitsetAndCountUpdate)
+    ->BITSET_ARGS(10)->BITSET_ARGS(100)->BITSET_ARGS(500);
+LAMP_BENCHMARK(BM_BitsetIsSubsetOf)
+    ->BITSET_ARGS(10)->BITSET_ARGS(100)->BITSET_ARGS(500);
+
+} // namespace
@@ -0,0 +1,71 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// ContDatabase::GetChildrenFreq, the kernel of the continuous search
+#include <sstream>
+
+#include "contdatabase.h"
+#include "bench.h"
+
+using namespace lamp_search;
+using namespace lamp_search::bench;
+
+namespace {
+
+// args: transactions, items
+void BM_ContGetChildrenFreq(State & state) {
+  const int nu_trans = state.Arg(0);
+  const int nu_items = state.Arg(1);
+  Random r(nu_trans * 1000 + nu_items);
+  std::stringstream features;
+  std::stringstream classes;
+  for (int i = 0; i < nu_trans; i++) {
+    for (int j = 0; j < nu_items; j++)
+      features << (j > 0 ? "," : "") << (r.Next() % 1000000) / 1000000.0;
+    features << "\n";
+    classes << (r.Bernoulli(500) ? 1 : 0) << "\n";
+  }
+  ContDatabase d(features, classes); // Ftype is double
+
+  std::vector<double> parent(nu_trans, 1.0);
+  int item = 0;
+  while (state.KeepRunning()) {
+    std::vector<double> child = d.GetChildrenFreq(parent, item);
+    DoNotOptimize(child[0]);
+    if (++item == nu_items) item = 0;
+  }
+  state.SetItemsProcessed(state.Iterations());
+  state.SetBytesProcessed(state.Iterations() * nu_trans *
+                          sizeof(double));
+}
+
+LAMP_BENCHMARK(BM_ContGetChildrenFreq)
+    ->Args(100, 16)->Args(1000, 16)->Args(10000, 4)->Args(100000, 2);
+
+} // namespace
@@ -0,0 +1,206 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// closure check (LampGraph::PPCExtension) and p-value of Database
+// on generated databases
+#include <sstream>
+
+#include "variable_bitset_array.h"
+#include "variable_length_itemset.h"
+#include "database.h"
+#include "lamp_graph.h"
+#include "bench.h"
+
+using namespace lamp_search;
+using namespace lamp_search::bench;
+
+namespace {
+
+// random database of nu_trans x nu_items with density permille, read from
+// csv text as the item and positive files. half of the transactions are
+// positive. the constructor builds the p-value table, which takes
+// O(transactions^3), so a few thousand transactions at most
+Database<uint64> * GenerateDatabase(int nu_trans, int nu_items, int permille) {
+  Random r(((unsigned long long int) nu_trans << 32) + nu_items * 1000 +
+           permille);
+  std::stringstream item_file;
+  std::stringstream pos_file;
+  item_file << "#gene";
+  for (int j = 0; j < nu_items; j++) item_file << ",I" << j;
+  item_file << "\n";
+  pos_file << "#gene,expression\n";
+  for (int i = 0; i < nu_trans; i++) {
+    item_file << "T" << i;
+    for (int j = 0; j < nu_items; j++)
+      item_file << (r.Bernoulli(permille) ? ",1" : ",0");
+    item_file << "\n";
+    pos_file << "T" << i << (r.Bernoulli(500) ? ",1" : ",0") << "\n";
+  }
+
+  VariableBitsetHelper<uint64> * bsh = NULL;
+  uint64 * data = NULL;
+  uint64 * positive = NULL;
+  int nu_pos_total = 0;
+  int max_item_in_transaction;
+  std::vector<std::string> * item_names = new std::vector<std::string>;
+  std::vector<std::string> * trans_names = new std::vector<std::string>;
+
+  DatabaseReader<uint64> reader;
+  reader.ReadItems(item_file, &nu_trans, &nu_items, &bsh, &data, item_names,
+                   trans_names, &max_item_in_transaction);
+  reader.ReadPosNeg(pos_file, nu_trans, trans_names, &nu_pos_total, bsh,
+                    &positive);
+  // the database owns data, positive and the names, not bsh
+  return new Database<uint64>(bsh, data, nu_trans, nu_items, positive,
+                              nu_pos_total, max_item_in_transaction,
+                              item_names, trans_names);
+}
+
+void DeleteDatabase(Database<uint64> * d) {
+  const VariableBitsetHelper<uint64> * bsh = &d->VBSHelper();
+  delete d;
+  delete bsh;
+}
+
+// enumerates the closed sets with support >= lambda in the same way as
+// the 1st phase of the search. return the number of PPCExtension calls
+long long int EnumerateClosedSets(const LampGraph<uint64> & g, int lambda,
+                                  VariableLengthItemsetStack * st,
+                                  long long int * closed_set_num) {
+  const Database<uint64> & d = g.GetDatabase();
+  const VariableBitsetHelper<uint64> & bsh = d.VBSHelper();
+  uint64 * sup_buf = bsh.New();
+  uint64 * child_sup_buf = bsh.New();
+  std::vector<int> itemset_buf(VariableLengthItemsetStack::kMaxItemsPerSet);
+  int * itemset = &itemset_buf[0];
+  long long int nu_ppc = 0ll;
+
+  st->Clear();
+  st->PushPre();
+  st->SetSup(st->Top(), d.NuTransaction());
+  st->PushPostNoSort();
+
+  while (!st->Empty()) {
+    st->CopyItem(st->Top(), itemset);
+    st->Pop();
+
+    bsh.Set(sup_buf);
+    int n = st->GetItemNum(itemset);
+    for (int i = 0; i < n; i++)
+      bsh.And(d.NthData(st->GetNthItem(itemset, i)), sup_buf);
+
+    int core_i = g.CoreIndex(*st, itemset);
+    for (int new_item = d.NuItems() - 1; new_item >= core_i + 1;
+         new_item--) {
+      if (st->Exist(itemset, new_item)) continue;
+
+      bsh.Copy(sup_buf, child_sup_buf);
+      int sup_num = bsh.AndCountUpdate(d.NthData(new_item), child_sup_buf);
+      if (sup_num < lambda) continue;
+
+      st->PushPre();
+      int * ext = st->Top();
+      bool res = g.PPCExtension(st, itemset, child_sup_buf, core_i, new_item,
+                                ext);
+      nu_ppc++;
+      st->SetSup(ext, sup_num);
+      st->PushPostNoSort();
+      if (!res) {
+        st->Pop();
+      } else {
+        st->SortTop();
+        (*closed_set_num)++;
+        if (sup_num <= lambda) st->Pop();
+      }
+    }
+  }
+
+  bsh.Delete(sup_buf);
+  bsh.Delete(child_sup_buf);
+  return nu_ppc;
+}
+
+// args: transactions, items, density (permille). min. sup is 5%
+void BM_ClosedSetEnumeration(State & state) {
+  Database<uint64> * d =
+      GenerateDatabase(state.Arg(0), state.Arg(1), state.Arg(2));
+  LampGraph<uint64> g(*d);
+  VariableLengthItemsetStack st(16 * 1024 * 1024);
+  int lambda = std::max(2, d->NuTransaction() / 20);
+
+  long long int nu_ppc = 0ll;
+  long long int closed_set_num = 0ll;
+  while (state.KeepRunning())
+    nu_ppc += EnumerateClosedSets(g, lambda, &st, &closed_set_num);
+
+  std::stringstream label;
+  label << "closed_sets=" << closed_set_num / state.Iterations();
+  state.SetLabel(label.str());
+  state.SetItemsProcessed(nu_ppc); // PPCExtension per second
+  DeleteDatabase(d);
+}
+
+LAMP_BENCHMARK(BM_ClosedSetEnumeration)
+    ->Args(256, 32, 300)->Args(1024, 48, 200)->Args(2048, 32, 200);
+
+// one p-value per iteration, over all (sup, pos_sup) of the table
+void BM_PValCalLog(State & state) {
+  Database<uint64> * d = GenerateDatabase(state.Arg(0), 8, 500);
+  int sup = 1, pos_sup = 0;
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += d->PValCalLog(sup, pos_sup);
+    DoNotOptimize(sum);
+    if (++pos_sup > std::min(sup, d->PosTotal())) {
+      pos_sup = 0;
+      if (++sup > d->NuTransaction()) sup = 1;
+    }
+  }
+  state.SetItemsProcessed(state.Iterations());
+  DeleteDatabase(d);
+}
+
+LAMP_BENCHMARK(BM_PValCalLog)->Args(100)->Args(300)->Args(1000);
+
+// pmin and p-value tables built by Database::Init
+void BM_PValTableBuild(State & state) {
+  Database<uint64> * d = GenerateDatabase(state.Arg(0), 8, 500);
+  while (state.KeepRunning()) {
+    d->InitPMinLogTable();
+    d->InitPValTableLog();
+    DoNotOptimize(d->PVal(d->MaxX(), 0));
+  }
+  state.SetItemsProcessed(state.Iterations() * (d->MaxX() + 1ll) *
+                          (d->MaxT() + 1ll));
+  DeleteDatabase(d);
+}
+
+LAMP_BENCHMARK(BM_PValTableBuild)->Args(100)->Args(300)->Args(1000);
+
+} // namespace
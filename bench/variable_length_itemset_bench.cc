@@ -0,0 +1,78 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// VariableLengthItemsetStack push, pop and copy of itemsets
+#include <vector>
+
+#include "variable_length_itemset.h"
+#include "bench.h"
+
+using namespace lamp_search;
+using namespace lamp_search::bench;
+
+namespace {
+
+// push and pop of an itemset of state.Arg(0) items
+void BM_ItemsetPushPop(State & state) {
+  const int n = state.Arg(0);
+  VariableLengthItemsetStack st(1024 * 1024);
+  while (state.KeepRunning()) {
+    st.PushPre();
+    for (int k = 0; k < n; k++) st.PushOneItem(k);
+    st.SetSup(st.Top(), n);
+    st.PushPostNoSort();
+    DoNotOptimize(st.Top());
+    st.Pop();
+  }
+  state.SetItemsProcessed(state.Iterations());
+}
+
+LAMP_BENCHMARK(BM_ItemsetPushPop)->Args(1)->Args(8)->Args(64)->Args(512);
+
+// copy of the top itemset of state.Arg(0) items to a buffer
+void BM_ItemsetCopyItem(State & state) {
+  const int n = state.Arg(0);
+  VariableLengthItemsetStack st(1024 * 1024);
+  st.PushPre();
+  for (int k = 0; k < n; k++) st.PushOneItem(k);
+  st.SetSup(st.Top(), n);
+  st.PushPostNoSort();
+  std::vector<int> buf(n + VariableLengthItemsetStack::ITM);
+  while (state.KeepRunning()) {
+    st.CopyItem(st.Top(), &buf[0]);
+    DoNotOptimize(buf[0]);
+  }
+  state.SetItemsProcessed(state.Iterations());
+  state.SetBytesProcessed(state.Iterations() *
+                          (n + VariableLengthItemsetStack::ITM) * sizeof(int));
+}
+
+LAMP_BENCHMARK(BM_ItemsetCopyItem)->Args(1)->Args(8)->Args(64)->Args(512);
+
+} // namespace
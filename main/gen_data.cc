@@ -0,0 +1,253 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// generates synthetic data for benchmarks, with planted significant itemsets
+//
+// transactions are written one by one, so the memory does not depend on
+// --trans. formats (--format, comma separated):
+//   csv:  <out>.csv (item file) and <out>_pos.csv
+//   lcm:  <out>.lcm (item file for --lcm) and <out>_pos.csv
+//   cont: <out>.data and <out>.class (cont-lamp)
+//
+// items are split into --groups groups. each transaction draws one hidden
+// bit per group with probability --density, and each item copies the bit of
+// its group with probability --corr or draws its own bit otherwise. so the
+// density of every item is --density and items in a group are correlated
+// (about corr^2).
+//
+// the class is positive with probability --pos_ratio. each of the --planted
+// itemsets of --planted_size items is put in a transaction with probability
+// --planted_sup, and --planted_pos of the transactions with it are positive.
+// the effect size of a planted itemset is planted_pos / pos_ratio.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/random.hpp>
+
+#include "gflags/gflags.h"
+
+DEFINE_string(out, "synth", "prefix of the output files");
+DEFINE_string(format, "csv", "csv, lcm or cont, comma separated for several");
+DEFINE_int32(trans, 1000, "number of transactions");
+DEFINE_int32(items, 100, "number of items");
+DEFINE_double(density, 0.1, "probability of each item in a transaction");
+DEFINE_int32(groups, 10, "number of groups of correlated items");
+DEFINE_double(corr, 0.0, "probability that an item follows its group");
+DEFINE_double(pos_ratio, 0.5, "ratio of positive transactions");
+DEFINE_int32(planted, 1, "number of planted itemsets");
+DEFINE_int32(planted_size, 3, "items per planted itemset");
+DEFINE_double(planted_sup, 0.05,
+              "ratio of transactions with each planted itemset");
+DEFINE_double(planted_pos, 0.9,
+              "ratio of positives in the transactions with a planted itemset");
+DEFINE_int32(seed, 1, "random seed. the same seed gives the same files");
+
+namespace {
+
+std::string ItemName(int i) {
+  std::stringstream s;
+  s << "I" << (i + 1);
+  return s.str();
+}
+
+std::string TransName(long long int t) {
+  std::stringstream s;
+  s << "T" << (t + 1);
+  return s.str();
+}
+
+bool Open(std::ofstream * ofs, const std::string & name) {
+  ofs->open(name.c_str(), std::ios::out);
+  if (!(*ofs)) {
+    std::cerr << "cannot open " << name << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  bool csv = false, lcm = false, cont = false;
+  {
+    std::stringstream ss(FLAGS_format);
+    std::string f;
+    while (std::getline(ss, f, ',')) {
+      if (f == "csv") csv = true;
+      else if (f == "lcm") lcm = true;
+      else if (f == "cont") cont = true;
+      else {
+        std::cerr << "unknown format: " << f << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  const int nu_items = FLAGS_items;
+  const int nu_groups = std::max(1, std::min(FLAGS_groups, nu_items));
+  if (nu_items <= 0 || FLAGS_trans <= 0 ||
+      FLAGS_planted * FLAGS_planted_size > nu_items) {
+    std::cerr << "need --trans > 0, --items > 0 and "
+              << "--planted * --planted_size <= --items" << std::endl;
+    return 1;
+  }
+  // P(planted | class) so that P(planted) = planted_sup and
+  // P(pos | planted) = planted_pos
+  double p_planted_pos = FLAGS_planted_sup * FLAGS_planted_pos / FLAGS_pos_ratio;
+  double p_planted_neg = FLAGS_planted_sup * (1.0 - FLAGS_planted_pos) /
+      (1.0 - FLAGS_pos_ratio);
+  if (FLAGS_planted > 0 && (p_planted_pos > 1.0 || p_planted_neg > 1.0)) {
+    std::cerr << "--planted_sup * --planted_pos is more than --pos_ratio"
+              << " (or the same for negatives)" << std::endl;
+    return 1;
+  }
+
+  boost::mt19937 rng(FLAGS_seed);
+  boost::uniform_01<boost::mt19937 &> uni(rng);
+  // separate stream, so that the items do not depend on --format
+  boost::mt19937 cont_rng(FLAGS_seed + 1);
+  boost::uniform_01<boost::mt19937 &> cont_uni(cont_rng);
+
+  // planted itemsets are disjoint sets of random items
+  std::vector<int> perm(nu_items);
+  for (int i = 0; i < nu_items; i++) perm[i] = i;
+  for (int i = nu_items - 1; i > 0; i--)
+    std::swap(perm[i], perm[(int) (uni() * (i + 1))]);
+  std::vector<std::vector<int> > planted(FLAGS_planted);
+  for (int k = 0; k < FLAGS_planted; k++) {
+    planted[k].assign(perm.begin() + k * FLAGS_planted_size,
+                      perm.begin() + (k + 1) * FLAGS_planted_size);
+    std::sort(planted[k].begin(), planted[k].end());
+  }
+
+  std::ofstream csv_file, lcm_file, pos_file, data_file, class_file;
+  if (csv && !Open(&csv_file, FLAGS_out + ".csv")) return 1;
+  if (lcm && !Open(&lcm_file, FLAGS_out + ".lcm")) return 1;
+  if ((csv || lcm) && !Open(&pos_file, FLAGS_out + "_pos.csv")) return 1;
+  if (cont && !Open(&data_file, FLAGS_out + ".data")) return 1;
+  if (cont && !Open(&class_file, FLAGS_out + ".class")) return 1;
+
+  if (csv) {
+    csv_file << "#gene";
+    for (int i = 0; i < nu_items; i++) csv_file << "," << ItemName(i);
+    csv_file << "\n";
+  }
+  if (csv || lcm) pos_file << "#gene,expression\n";
+
+  std::vector<char> group_bit(nu_groups);
+  std::vector<char> row(nu_items);
+  std::vector<long long int> planted_sup(FLAGS_planted, 0ll);
+  std::vector<long long int> planted_pos_sup(FLAGS_planted, 0ll);
+  long long int nu_pos = 0ll, nu_ones = 0ll;
+
+  for (long long int t = 0; t < FLAGS_trans; t++) {
+    bool pos = uni() < FLAGS_pos_ratio;
+    for (int g = 0; g < nu_groups; g++) group_bit[g] = uni() < FLAGS_density;
+    for (int i = 0; i < nu_items; i++) {
+      if (uni() < FLAGS_corr) row[i] = group_bit[i % nu_groups];
+      else row[i] = uni() < FLAGS_density;
+    }
+    for (int k = 0; k < FLAGS_planted; k++)
+      if (uni() < (pos ? p_planted_pos : p_planted_neg))
+        for (std::size_t j = 0; j < planted[k].size(); j++)
+          row[planted[k][j]] = 1;
+
+    // actual counts, including the transactions with the items by chance
+    for (int k = 0; k < FLAGS_planted; k++) {
+      bool all = true;
+      for (std::size_t j = 0; j < planted[k].size(); j++)
+        all = all && row[planted[k][j]];
+      if (all) {
+        planted_sup[k]++;
+        if (pos) planted_pos_sup[k]++;
+      }
+    }
+    if (pos) nu_pos++;
+
+    if (csv) {
+      csv_file << TransName(t);
+      for (int i = 0; i < nu_items; i++) csv_file << (row[i] ? ",1" : ",0");
+      csv_file << "\n";
+    }
+    if (lcm) {
+      bool first = true;
+      for (int i = 0; i < nu_items; i++) {
+        if (!row[i]) continue;
+        lcm_file << (first ? "" : " ") << ItemName(i);
+        first = false;
+      }
+      lcm_file << "\n";
+    }
+    if (csv || lcm) pos_file << TransName(t) << (pos ? ",1" : ",0") << "\n";
+    if (cont) {
+      // cont-lamp ranks the values, so items present are ranked high
+      for (int i = 0; i < nu_items; i++)
+        data_file << (i > 0 ? "," : "") << std::setprecision(6)
+                  << (row[i] + cont_uni()) / 2.0;
+      data_file << "\n";
+      class_file << (pos ? 1 : 0) << "\n";
+    }
+    for (int i = 0; i < nu_items; i++) nu_ones += row[i];
+  }
+
+  std::cout << "# transactions=" << FLAGS_trans << "\titems=" << nu_items
+            << "\tpositives=" << nu_pos << "\tdensity="
+            << (double) nu_ones / ((double) FLAGS_trans * nu_items)
+            << "\tseed=" << FLAGS_seed << std::endl;
+  for (int k = 0; k < FLAGS_planted; k++) {
+    std::cout << "# planted";
+    for (std::size_t j = 0; j < planted[k].size(); j++)
+      std::cout << " " << ItemName(planted[k][j]);
+    std::cout << "\tsup=" << planted_sup[k] << "\tpos_sup="
+              << planted_pos_sup[k] << std::endl;
+  }
+
+  bool ok = true;
+  if (csv) ok = ok && csv_file.good();
+  if (lcm) ok = ok && lcm_file.good();
+  if (csv || lcm) ok = ok && pos_file.good();
+  if (cont) ok = ok && data_file.good() && class_file.good();
+  if (!ok) {
+    std::cerr << "write error" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/* Local Variables:  */
+/* compile-command: "scons -u" */
+/* End:              */
@@ -40,8 +40,12 @@
 #include "lcm_dfs_vba.h"
 
 #include "database.h"
+#include "binary_database.h"
 
 DEFINE_string(item, "", "filename of item set");
+DEFINE_string(pos, "", "filename of positive transactions, for --bin");
+DEFINE_string(bin, "", "write a binary database for bin-lamp to this file "
+              "instead of printing");
 
 using namespace lamp_search;
 
@@ -76,6 +80,22 @@ int main(int argc, char ** argv)
                       item_names, &max_item_in_transaction);
   ifs1.close();
 
+  if (FLAGS_bin != "") {
+    uint64 * positive = NULL;
+    int nu_pos_total = 0;
+    if (FLAGS_pos != "") {
+      std::ifstream ifs2;
+      ifs2.open(FLAGS_pos.c_str(), std::ios::in);
+      reader.ReadPosNeg(ifs2, nu_trans, NULL, &nu_pos_total, bsh, &positive);
+      ifs2.close();
+    }
+    // no transaction names in the lcm format
+    BinaryDatabase<uint64>::Write(FLAGS_bin, bsh, data, nu_trans, nu_items,
+                                  positive, nu_pos_total, max_item_in_transaction,
+                                  item_names, NULL);
+    return 0;
+  }
+
   reader.PrintCSV(std::cout, nu_trans, nu_items, bsh, item_names, data);
 
   return 0;
@@ -58,6 +58,7 @@ DECLARE_bool(log); // false, "show log", mp-lamp.cc , true, "show log"
 
 DECLARE_bool(second_phase);// true, "do second phase"
 DECLARE_bool(third_phase);// true, "do third phase"
+DECLARE_bool(progress_thread); // false, "receive messages in a separate thread", ParallelDFS.cc
 
 DEFINE_int32(n, 1000, "granularity of one Node process");
 DEFINE_bool(n_is_ms, true, "true: n is milli sec, false: n is num task");
@@ -73,8 +74,12 @@ using
 namespace lamp_search;
 
 int main(int argc, char **argv) {
-	MPI_Init(&argc, &argv);
+	// flags first: the thread level depends on --progress_thread
 	google::ParseCommandLineFlags(&argc, &argv, true);
+	int thread_provided;
+	MPI_Init_thread(&argc, &argv,
+			FLAGS_progress_thread ? MPI_THREAD_MULTIPLE : MPI_THREAD_SINGLE,
+			&thread_provided);
 
 	if (FLAGS_sleep > 0) {
 		sleep(FLAGS_sleep);
@@ -95,14 +100,20 @@ int main(int argc, char **argv) {
 			return 1;
 		}
 
-		if (FLAGS_pos == "" && FLAGS_posnum == 0) {
+		// written by csv2lcm or lcm2csv with --bin
+		int binary = 0;
+		if (rank == 0)
+			binary = BinaryDatabase<uint64>::IsBinary(FLAGS_item);
+		MPI_Bcast(&binary, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+		if (FLAGS_pos == "" && FLAGS_posnum == 0 && !binary) {
 			if (rank == 0)
 				std::cout << "specify --pos or --posnum" << std::endl;
 			MPI_Finalize();
 			return 1;
 		}
 
-		if (FLAGS_third_phase && FLAGS_pos == "") {
+		if (FLAGS_third_phase && FLAGS_pos == "" && !binary) {
 			if (rank == 0)
 				std::cout << "specify positive file by --pos for third phase"
 						<< std::endl;
@@ -116,10 +127,12 @@ int main(int argc, char **argv) {
 
 		if (rank == 0) {
 			std::cout << "# item file    : " << FLAGS_item << std::endl;
-			if (FLAGS_pos == "")
-				std::cout << "# pos num: " << FLAGS_posnum << std::endl;
-			else
+			if (binary)
+				std::cout << "# binary database" << std::endl;
+			if (FLAGS_pos != "")
 				std::cout << "# positive file: " << FLAGS_pos << std::endl;
+			else if (FLAGS_posnum > 0 || !binary)
+				std::cout << "# pos num: " << FLAGS_posnum << std::endl;
 		}
 
 		Timer::GetInstance()->Start();
@@ -139,7 +152,9 @@ int main(int argc, char **argv) {
 		}
 
 		try {
-			if (FLAGS_pos != "") {
+			if (binary) {
+				search->InitDatabaseBinary(FLAGS_item, FLAGS_pos, FLAGS_posnum);
+			} else if (FLAGS_pos != "") {
 				if (rank == 0) {
 					std::ifstream item_file, positive_file;
 					item_file.open(FLAGS_item.c_str(), std::ios::in);
@@ -58,6 +58,7 @@ DECLARE_bool(log); // false, "show log", mp-lamp.cc , true, "show log"
 
 //DECLARE_bool(second_phase);// true, "do second phase"
 DECLARE_bool(third_phase);// true, "do third phase"
+DECLARE_bool(progress_thread); // false, "receive messages in a separate thread", ParallelDFS.cc
 //
 DEFINE_int32(n, 1000, "granularity of one Node process");
 DEFINE_bool(n_is_ms, true,
@@ -78,8 +79,12 @@ using
 namespace lamp_search;
 
 int main(int argc, char **argv) {
-	MPI_Init(&argc, &argv);
+	// flags first: the thread level depends on --progress_thread
 	google::ParseCommandLineFlags(&argc, &argv, true);
+	int thread_provided;
+	MPI_Init_thread(&argc, &argv,
+			FLAGS_progress_thread ? MPI_THREAD_MULTIPLE : MPI_THREAD_SINGLE,
+			&thread_provided);
 
 	int rank, nu_proc;
 	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -92,6 +97,8 @@ int main(int argc, char **argv) {
 	long long int search_start_time, search_end_time;
 
 	{
+		Timer::GetInstance()->Start();
+
 		std::ifstream item_file;
 		item_file.open(FLAGS_item.c_str(), std::ios::in);
 		std::ifstream class_file;
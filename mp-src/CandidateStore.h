@@ -0,0 +1,127 @@
+/*
+ * CandidateStore.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_CANDIDATESTORE_H_
+#define MP_SRC_CANDIDATESTORE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/variable_length_itemset.h"
+
+namespace lamp_search {
+
+/**
+ * Closed sets found in phase 1 with their positive support (--fused).
+ *
+ * One entry is the pos_sup followed by the itemset in the format of
+ * VariableLengthItemsetStack ([NUM][SUP][ITM...]), so the static getters
+ * of VariableLengthItemsetStack work on the pointers of First/Next.
+ *
+ * Entries with support below the threshold are dropped by Compact, which
+ * runs when the store is full. If it is still full the store gives up:
+ * Overflow() becomes true and the entries are freed, phase 2 then runs
+ * the second enumeration as usual.
+ */
+class CandidateStore {
+public:
+	CandidateStore() :
+			max_size_(0), overflow_(false), compact_num_(0ll), peak_size_(
+					0ll) {
+	}
+
+	// max_size: in ints
+	void Init(long long int max_size) {
+		data_.clear();
+		max_size_ = max_size;
+		overflow_ = false;
+		compact_num_ = 0ll;
+		peak_size_ = 0ll;
+	}
+
+	bool Overflow() const {
+		return overflow_;
+	}
+
+	// closed set found with the threshold (sets with sup >= threshold kept)
+	void Push(const int * itemset, int pos_sup, int threshold) {
+		if (overflow_)
+			return;
+		long long int len = kPos + VariableLengthItemsetStack::ITM
+				+ VariableLengthItemsetStack::GetItemNum(itemset);
+		if ((long long int) data_.size() + len > max_size_) {
+			Compact(threshold);
+			if ((long long int) data_.size() + len > max_size_) {
+				overflow_ = true;
+				std::vector<int>().swap(data_);
+				return;
+			}
+		}
+		data_.push_back(pos_sup);
+		data_.insert(data_.end(), itemset, itemset + len - kPos);
+		if ((long long int) data_.size() > peak_size_)
+			peak_size_ = data_.size();
+	}
+
+	// drop the entries with sup < threshold
+	void Compact(int threshold) {
+		compact_num_++;
+		std::size_t dst = 0, src = 0;
+		while (src < data_.size()) {
+			const int * set = &(data_[src]) + kPos;
+			std::size_t len = kPos + VariableLengthItemsetStack::ITM
+					+ VariableLengthItemsetStack::GetItemNum(set);
+			if (VariableLengthItemsetStack::GetSup(set) >= threshold) {
+				if (dst != src)
+					std::copy(data_.begin() + src, data_.begin() + src + len,
+							data_.begin() + dst);
+				dst += len;
+			}
+			src += len;
+		}
+		data_.resize(dst);
+	}
+
+	void Clear() {
+		std::vector<int>().swap(data_);
+	}
+
+	// itemsets in insertion order, NULL at the end
+	const int * First() const {
+		return data_.empty() ? NULL : &(data_[0]) + kPos;
+	}
+	const int * Next(const int * set) const {
+		const int * next = set + VariableLengthItemsetStack::ITM
+				+ VariableLengthItemsetStack::GetItemNum(set) + kPos;
+		return (next - &(data_[0]) < (long) data_.size()) ? next : NULL;
+	}
+	static int PosSup(const int * set) {
+		return set[-kPos];
+	}
+
+	long long int Size() const {
+		return data_.size();
+	}
+	long long int CompactNum() const {
+		return compact_num_;
+	}
+	long long int PeakSize() const {
+		return peak_size_;
+	}
+
+private:
+	static const int kPos = 1; // pos_sup before the itemset
+
+	std::vector<int> data_;
+	long long int max_size_;
+	bool overflow_;
+	long long int compact_num_;
+	long long int peak_size_;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_CANDIDATESTORE_H_ */
@@ -0,0 +1,160 @@
+/*
+ * Checkpoint.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Checkpoint.h"
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "../src/variable_length_itemset.h"
+
+namespace lamp_search {
+
+namespace {
+
+volatile sig_atomic_t signal_request = Checkpoint::NONE;
+
+void SignalHandler(int sig) {
+	if (sig == SIGUSR2)
+		signal_request = Checkpoint::STOP;
+	else if (signal_request == Checkpoint::NONE)
+		signal_request = Checkpoint::CONTINUE;
+}
+
+} // namespace
+
+Checkpoint::Checkpoint() :
+		nu_proc_(0), phase_(0), lambda_(0), lambda_max_(0), closed_set_num_(
+				0ll), sig_level_(0.0) {
+}
+
+void Checkpoint::InstallSignalHandlers() {
+	std::signal(SIGUSR1, SignalHandler);
+	std::signal(SIGUSR2, SignalHandler);
+}
+
+int Checkpoint::TakeSignal() {
+	int request = signal_request;
+	signal_request = NONE;
+	return request;
+}
+
+std::string Checkpoint::FileName(const std::string& prefix, int rank) {
+	std::stringstream s;
+	s << prefix << "." << rank << ".ckpt";
+	return s.str();
+}
+
+bool Checkpoint::Write(const std::string& file_name, int rank) const {
+	std::ofstream ofs(file_name.c_str(), std::ios::out | std::ios::binary);
+	if (ofs.fail())
+		return false;
+
+	Header h;
+	h.magic_ = kMagic;
+	h.version_ = kVersion;
+	h.nu_proc_ = nu_proc_;
+	h.rank_ = rank;
+	h.phase_ = phase_;
+	h.lambda_ = lambda_;
+	h.lambda_max_ = lambda_max_;
+	h.nu_accum_ = accum_.size();
+	h.closed_set_num_ = closed_set_num_;
+	h.sig_level_ = sig_level_;
+	h.node_size_ = node_.size();
+	h.freq_size_ = freq_.size();
+	h.nu_freq_ = pval_.size();
+	ofs.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+	return WriteArray(ofs, accum_) && WriteArray(ofs, node_)
+			&& WriteArray(ofs, freq_) && WriteArray(ofs, pval_);
+}
+
+bool Checkpoint::Read(const std::string& file_name) {
+	std::ifstream ifs(file_name.c_str(), std::ios::in | std::ios::binary);
+	if (ifs.fail())
+		return false;
+
+	Header h;
+	ifs.read(reinterpret_cast<char *>(&h), sizeof(h));
+	if (!ifs.good() || h.magic_ != kMagic || h.version_ != kVersion)
+		return false;
+	nu_proc_ = h.nu_proc_;
+	phase_ = h.phase_;
+	lambda_ = h.lambda_;
+	lambda_max_ = h.lambda_max_;
+	closed_set_num_ = h.closed_set_num_;
+	sig_level_ = h.sig_level_;
+
+	return ReadArray(ifs, &accum_, h.nu_accum_)
+			&& ReadArray(ifs, &node_, h.node_size_)
+			&& ReadArray(ifs, &freq_, h.freq_size_)
+			&& ReadArray(ifs, &pval_, h.nu_freq_);
+}
+
+bool Checkpoint::Load(const std::string& prefix, int rank, int nu_proc) {
+	Checkpoint file;
+	if (!file.Read(FileName(prefix, 0)))
+		return false;
+	int old_nu_proc = file.nu_proc_;
+
+	nu_proc_ = nu_proc;
+	phase_ = file.phase_;
+	lambda_ = file.lambda_;
+	lambda_max_ = file.lambda_max_;
+	sig_level_ = file.sig_level_;
+	accum_ = file.accum_; // same in all files
+	closed_set_num_ = 0ll;
+	node_.clear();
+	freq_.clear();
+	pval_.clear();
+
+	long long int node_index = 0ll, freq_index = 0ll;
+	for (int r = 0; r < old_nu_proc; r++) {
+		if (r > 0 && !file.Read(FileName(prefix, r)))
+			return false;
+		if (file.phase_ != phase_ || file.nu_proc_ != old_nu_proc)
+			return false;
+		if (r % nu_proc == rank)
+			closed_set_num_ += file.closed_set_num_;
+		Stripe(file.node_.empty() ? NULL : &(file.node_[0]),
+				file.node_.size(), rank, nu_proc, &node_index, &node_,
+				NULL, NULL);
+		Stripe(file.freq_.empty() ? NULL : &(file.freq_[0]),
+				file.freq_.size(), rank, nu_proc, &freq_index, &freq_,
+				file.pval_.empty() ? NULL : &(file.pval_[0]), &pval_);
+	}
+	return true;
+}
+
+long long int Checkpoint::Bytes() const {
+	return sizeof(Header) + accum_.size() * sizeof(long long int)
+			+ (node_.size() + freq_.size()) * sizeof(int)
+			+ pval_.size() * sizeof(double);
+}
+
+void Checkpoint::Stripe(const int * src, long long int size, int rank,
+		int nu_proc, long long int * index, std::vector<int> * dst,
+		const double * pval, std::vector<double> * dst_pval) {
+	long long int i = 0ll;
+	int n = 0; // itemset in this file
+	while (i < size) {
+		long long int len = VariableLengthItemsetStack::ITM
+				+ VariableLengthItemsetStack::GetItemNum(src + i);
+		if ((*index) % nu_proc == rank) {
+			dst->insert(dst->end(), src + i, src + i + len);
+			if (pval != NULL)
+				dst_pval->push_back(pval[n]);
+		}
+		(*index)++;
+		n++;
+		i += len;
+	}
+}
+
+} /* namespace lamp_search */
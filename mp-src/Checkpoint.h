@@ -0,0 +1,111 @@
+/*
+ * Checkpoint.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_CHECKPOINT_H_
+#define MP_SRC_CHECKPOINT_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace lamp_search {
+
+/**
+ * Search state of one rank at a quiescent point, and its file.
+ *
+ * One binary file per rank, <prefix>.<rank>.ckpt:
+ *   Header
+ *   accum (lambda_max + 1 long long, the reduced closed set counts, phase 1)
+ *   node stack (node_size ints, itemsets as in VariableLengthItemsetStack)
+ *   freq stack (freq_size ints, testable itemsets, phase 2)
+ *   pval (nu_freq doubles, one for each itemset in the freq stack)
+ *
+ * Load reads the files of all the ranks of the checkpoint and keeps every
+ * nu_proc-th itemset, so the number of ranks can differ on restart.
+ */
+class Checkpoint {
+public:
+	enum Request {
+		NONE = 0, CONTINUE, STOP,
+	};
+
+	Checkpoint();
+
+	// SIGUSR1: checkpoint and continue, SIGUSR2: checkpoint and stop
+	static void InstallSignalHandlers();
+	// Request by a signal since the last call
+	static int TakeSignal();
+
+	static std::string FileName(const std::string& prefix, int rank);
+
+	// return false on I/O error
+	bool Write(const std::string& file_name, int rank) const;
+	bool Read(const std::string& file_name);
+	// this rank's share of the checkpoint at prefix
+	bool Load(const std::string& prefix, int rank, int nu_proc);
+
+	// total bytes in the file
+	long long int Bytes() const;
+
+	int nu_proc_; // ranks when written
+	int phase_; // 1, 2
+	int lambda_; // phase 1: lambda, phase 2: freqThreshold_
+	int lambda_max_;
+	long long int closed_set_num_;
+	double sig_level_; // phase 2
+
+	std::vector<long long int> accum_;
+	std::vector<int> node_;
+	std::vector<int> freq_;
+	std::vector<double> pval_;
+
+	// append every nu_proc-th itemset of src[0..size) to dst,
+	// counting from *index
+	static void Stripe(const int * src, long long int size, int rank,
+			int nu_proc, long long int * index, std::vector<int> * dst,
+			const double * pval, std::vector<double> * dst_pval);
+
+	// raw arrays of the files (also of ClosedSetFile)
+	template<class T>
+	static bool WriteArray(std::ofstream& ofs, const std::vector<T>& v) {
+		if (!v.empty())
+			ofs.write(reinterpret_cast<const char *>(&(v[0])),
+					v.size() * sizeof(T));
+		return ofs.good();
+	}
+	template<class T>
+	static bool ReadArray(std::ifstream& ifs, std::vector<T> * v,
+			long long int n) {
+		v->resize(n);
+		if (n > 0)
+			ifs.read(reinterpret_cast<char *>(&((*v)[0])), n * sizeof(T));
+		return ifs.good();
+	}
+
+private:
+	static const int kMagic = 0x4b434d4c; // "LMCK"
+	static const int kVersion = 1;
+
+	struct Header {
+		int magic_;
+		int version_;
+		int nu_proc_;
+		int rank_;
+		int phase_;
+		int lambda_;
+		int lambda_max_;
+		int nu_accum_;
+		long long int closed_set_num_;
+		double sig_level_;
+		long long int node_size_;
+		long long int freq_size_;
+		long long int nu_freq_;
+	};
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_CHECKPOINT_H_ */
@@ -0,0 +1,99 @@
+/*
+ * ClosedSetFile.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ClosedSetFile.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "Checkpoint.h"
+
+namespace lamp_search {
+
+ClosedSetFile::ClosedSetFile() :
+		nu_proc_(0), min_sup_(0), lambda_max_(0), nu_items_(0), nu_trans_(0), item_hash_(
+				kHashInit) {
+}
+
+std::string ClosedSetFile::FileName(const std::string& prefix, int rank) {
+	std::stringstream s;
+	s << prefix << "." << rank << ".cs";
+	return s.str();
+}
+
+unsigned long long int ClosedSetFile::Hash(const unsigned long long int * data,
+		std::size_t n, unsigned long long int h) {
+	for (std::size_t i = 0; i < n; i++) {
+		h ^= data[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+bool ClosedSetFile::Write(const std::string& file_name, int rank) const {
+	std::ofstream ofs(file_name.c_str(), std::ios::out | std::ios::binary);
+	if (ofs.fail())
+		return false;
+
+	Header h;
+	h.magic_ = kMagic;
+	h.version_ = kVersion;
+	h.nu_proc_ = nu_proc_;
+	h.rank_ = rank;
+	h.min_sup_ = min_sup_;
+	h.lambda_max_ = lambda_max_;
+	h.nu_items_ = nu_items_;
+	h.nu_trans_ = nu_trans_;
+	h.item_hash_ = item_hash_;
+	h.nu_accum_ = accum_.size();
+	h.set_size_ = sets_.size();
+	ofs.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+	return Checkpoint::WriteArray(ofs, accum_)
+			&& Checkpoint::WriteArray(ofs, sets_);
+}
+
+bool ClosedSetFile::Read(const std::string& file_name) {
+	std::ifstream ifs(file_name.c_str(), std::ios::in | std::ios::binary);
+	if (ifs.fail())
+		return false;
+
+	Header h;
+	ifs.read(reinterpret_cast<char *>(&h), sizeof(h));
+	if (!ifs.good() || h.magic_ != kMagic || h.version_ != kVersion)
+		return false;
+	nu_proc_ = h.nu_proc_;
+	min_sup_ = h.min_sup_;
+	lambda_max_ = h.lambda_max_;
+	nu_items_ = h.nu_items_;
+	nu_trans_ = h.nu_trans_;
+	item_hash_ = h.item_hash_;
+
+	return Checkpoint::ReadArray(ifs, &accum_, h.nu_accum_)
+			&& Checkpoint::ReadArray(ifs, &sets_, h.set_size_);
+}
+
+bool ClosedSetFile::Load(const std::string& prefix, int rank, int nu_proc) {
+	ClosedSetFile file;
+	if (!file.Read(FileName(prefix, 0)))
+		return false;
+	*this = file; // header and accum are the same in all files
+	nu_proc_ = nu_proc;
+	sets_.clear();
+
+	long long int index = 0ll;
+	for (int r = 0; r < file.nu_proc_; r++) {
+		if (r > 0 && !file.Read(FileName(prefix, r)))
+			return false;
+		if (file.min_sup_ != min_sup_ || file.item_hash_ != item_hash_)
+			return false;
+		Checkpoint::Stripe(file.sets_.empty() ? NULL : &(file.sets_[0]),
+				file.sets_.size(), rank, nu_proc, &index, &sets_, NULL, NULL);
+	}
+	return true;
+}
+
+} /* namespace lamp_search */
@@ -0,0 +1,81 @@
+/*
+ * ClosedSetFile.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_CLOSEDSETFILE_H_
+#define MP_SRC_CLOSEDSETFILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lamp_search {
+
+/**
+ * Output of phase 1 kept for later runs (--phase1_save, --phase1_load).
+ *
+ * The closed sets and their supports depend only on the item file, so a
+ * run with other positives or another alpha can take lambda from the
+ * stored counts and test the stored sets, without enumerating again. This
+ * holds as long as its min. sup is not below the stored one.
+ *
+ * One binary file per rank, <prefix>.<rank>.cs:
+ *   Header
+ *   accum (lambda_max + 1 long long, closed sets with sup >= l, exact for
+ *          l >= min_sup)
+ *   sets (set_size ints, closed sets with sup >= min_sup as in
+ *         VariableLengthItemsetStack)
+ *
+ * Load reads the files of all the ranks and keeps every nu_proc-th set, so
+ * the number of ranks can differ.
+ */
+class ClosedSetFile {
+public:
+	ClosedSetFile();
+
+	static std::string FileName(const std::string& prefix, int rank);
+	// FNV-1a of n words, continuing from h. identifies the item file
+	static unsigned long long int Hash(const unsigned long long int * data,
+			std::size_t n, unsigned long long int h);
+	static const unsigned long long int kHashInit = 14695981039346656037ull;
+
+	// return false on I/O error
+	bool Write(const std::string& file_name, int rank) const;
+	bool Read(const std::string& file_name);
+	// this rank's share of the sets at prefix
+	bool Load(const std::string& prefix, int rank, int nu_proc);
+
+	int nu_proc_; // ranks when written
+	int min_sup_; // final lambda - 1 of the run that wrote it
+	int lambda_max_;
+	int nu_items_;
+	int nu_trans_;
+	unsigned long long int item_hash_;
+
+	std::vector<long long int> accum_;
+	std::vector<int> sets_;
+
+private:
+	static const int kMagic = 0x53434d4c; // "LMCS"
+	static const int kVersion = 1;
+
+	struct Header {
+		int magic_;
+		int version_;
+		int nu_proc_;
+		int rank_;
+		int min_sup_;
+		int lambda_max_;
+		int nu_items_;
+		int nu_trans_;
+		unsigned long long int item_hash_;
+		long long int nu_accum_;
+		long long int set_size_;
+	};
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_CLOSEDSETFILE_H_ */
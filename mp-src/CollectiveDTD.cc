@@ -0,0 +1,48 @@
+/*
+ * CollectiveDTD.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CollectiveDTD.h"
+
+#include <cassert>
+
+namespace lamp_search {
+
+CollectiveDTD::CollectiveDTD(MPI_Comm comm) :
+		comm_(comm), send_(PAYLOAD, 0ll), recv_(PAYLOAD, 0ll), request_(
+				MPI_REQUEST_NULL), active_(false) {
+}
+
+CollectiveDTD::~CollectiveDTD() {
+	// a round is never left open at the end of a phase
+	assert(!active_);
+}
+
+long long int * CollectiveDTD::Prepare(int payload_size) {
+	assert(!active_);
+	send_.assign(PAYLOAD + payload_size, 0ll);
+	recv_.assign(PAYLOAD + payload_size, 0ll);
+	return &(send_[0]);
+}
+
+void CollectiveDTD::Start() {
+	assert(!active_);
+	int error = MPI_Iallreduce(&(send_[0]), &(recv_[0]), send_.size(),
+			MPI_LONG_LONG_INT, MPI_SUM, comm_, &request_);
+	if (error != MPI_SUCCESS)
+		MPI_Abort(comm_, 1);
+	active_ = true;
+}
+
+bool CollectiveDTD::Test() {
+	assert(active_);
+	int flag = 0;
+	MPI_Test(&request_, &flag, MPI_STATUS_IGNORE);
+	if (flag)
+		active_ = false;
+	return flag != 0;
+}
+
+} /* namespace lamp_search */
@@ -0,0 +1,69 @@
+/*
+ * CollectiveDTD.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_COLLECTIVEDTD_H_
+#define MP_SRC_COLLECTIVEDTD_H_
+
+#include <vector>
+
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * Termination detection and lambda update with nonblocking collectives
+ * (--dtd_engine=1).
+ *
+ * Instead of the echo over bcast_targets_, every rank contributes to a
+ * round of MPI_Iallreduce(SUM) of
+ *   0: count, 1: time warp flag, 2: empty flag, 3: checkpoint request,
+ *   4--: domain payload
+ * (the closed set counts in phase 1) and tests it from Probe. A round is
+ * one wave of DTD: the time zone is incremented on contribution, so the
+ * time warp flag of Mattern's algorithm still tells whether a message
+ * crossed the wave, and all ranks see the same result at the same round.
+ * The next round is started after the previous one completed, so a rank
+ * is never more than one time zone ahead of another.
+ */
+class CollectiveDTD {
+public:
+	enum Header {
+		COUNT = 0, TIME_WARP, NOT_EMPTY, CHECKPOINT, PAYLOAD,
+	};
+
+	CollectiveDTD(MPI_Comm comm);
+	~CollectiveDTD();
+
+	bool Active() const {
+		return active_;
+	}
+
+	// send buffer for a round with payload_size extra elements
+	long long int * Prepare(int payload_size);
+	void Start();
+	// true if the round has completed. Result() is valid until Prepare
+	bool Test();
+	const long long int * Result() const {
+		return &(recv_[0]);
+	}
+
+	// CHECKPOINT is only set by rank 0 and not part of termination
+	bool Terminated() const {
+		return recv_[COUNT] == 0ll && recv_[TIME_WARP] == 0ll
+				&& recv_[NOT_EMPTY] == 0ll;
+	}
+
+private:
+	MPI_Comm comm_;
+	std::vector<long long int> send_;
+	std::vector<long long int> recv_;
+	MPI_Request request_;
+	bool active_;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_COLLECTIVEDTD_H_ */
@@ -0,0 +1,149 @@
+/*
+ * CsAccumHistogram.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_CSACCUMHISTOGRAM_H_
+#define MP_SRC_CSACCUMHISTOGRAM_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace lamp_search {
+
+/**
+ * Pending closed set counts for accum_array_ of GetMinSupData.
+ *
+ * accum_array_[i] is the number of closed sets with support >= i, and
+ * IncCsAccum used to increment every entry in [lambda - 1, sup], which is
+ * O(sup) per closed set. Here a closed set only touches two entries of a
+ * difference array. Flush adds the suffix sum to accum_array_, so the
+ * entries are exactly what the loop would have written.
+ *
+ * The difference entries are also the sparse encoding of the DTD
+ * accumulation reply: (index, delta) pairs, merged at each level of the
+ * echo tree with AddDiff.
+ */
+class CsAccumHistogram {
+public:
+	CsAccumHistogram() :
+			low_(0), high_(-1) {
+	}
+
+	void Init(int lambda_max) {
+		diff_.assign(lambda_max + 1, 0ll);
+		low_ = lambda_max + 1;
+		high_ = -1;
+	}
+
+	int Size() const {
+		return diff_.size();
+	}
+
+	bool Dirty() const {
+		return high_ >= 0;
+	}
+
+	// closed set of support sup found with the threshold lambda:
+	// counts for accum[i], lambda - 1 <= i <= sup
+	void Inc(int sup, int lambda) {
+		int lo = std::max(lambda - 1, 0);
+		diff_[sup]++;
+		if (lo > 0) {
+			diff_[lo - 1]--;
+			lo--;
+		}
+		low_ = std::min(low_, lo);
+		high_ = std::max(high_, sup);
+	}
+
+	/**
+	 * counts received from a child. only accum[i] (i >= low) is updated,
+	 * same as RecvDTDAccumReply adding them to accum_array_[low..]
+	 */
+	// given as (index, delta) pairs
+	void AddDiff(const long long int * pairs, int nu_pair, int low) {
+		long long int sum = 0ll;
+		for (int k = 0; k < nu_pair; k++) {
+			int i = (int) pairs[2 * k];
+			if (i < low)
+				continue;
+			Add(i, pairs[2 * k + 1]);
+			sum += pairs[2 * k + 1];
+		}
+		Close(low, sum);
+	}
+	// given as accum[0..lambda_max]
+	void AddAccum(const long long int * accum, int low) {
+		if (low < 0)
+			low = 0;
+		long long int next = 0ll;
+		for (int i = diff_.size() - 1; i >= low; i--) {
+			if (accum[i] != next)
+				Add(i, accum[i] - next);
+			next = accum[i];
+		}
+		Close(low, next);
+	}
+
+	/**
+	 * write the non zero entries as (index, delta) pairs to pairs and clear.
+	 * return the number of pairs, or -1 if there are more than max_pair
+	 * (then nothing is cleared, use Flush)
+	 */
+	int TakeDiff(long long int * pairs, int max_pair) {
+		int n = 0;
+		for (int i = high_; i >= low_; i--) {
+			if (diff_[i] == 0ll)
+				continue;
+			if (n >= max_pair)
+				return -1;
+			pairs[2 * n] = i;
+			pairs[2 * n + 1] = diff_[i];
+			n++;
+		}
+		for (int i = high_; i >= low_; i--)
+			diff_[i] = 0ll;
+		low_ = diff_.size();
+		high_ = -1;
+		return n;
+	}
+
+	// add the pending counts to accum (accum[0..lambda_max]) and clear
+	void Flush(long long int * accum) {
+		long long int sum = 0ll;
+		for (int i = high_; i >= low_; i--) {
+			sum += diff_[i];
+			accum[i] += sum;
+			diff_[i] = 0ll;
+		}
+		low_ = diff_.size();
+		high_ = -1;
+	}
+
+private:
+	// cancel the suffix sum below low, or keep accum[0..low) in the flush
+	void Close(int low, long long int sum) {
+		if (sum == 0ll)
+			return;
+		if (low > 0)
+			Add(low - 1, -sum);
+		else
+			low_ = 0;
+	}
+
+	void Add(int i, long long int delta) {
+		diff_[i] += delta;
+		low_ = std::min(low_, i);
+		high_ = std::max(high_, i);
+	}
+
+	std::vector<long long int> diff_;
+	int low_; // lowest touched entry
+	int high_; // highest touched entry, -1 if clean
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_CSACCUMHISTOGRAM_H_ */
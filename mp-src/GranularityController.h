@@ -0,0 +1,140 @@
+/*
+ * GranularityController.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_GRANULARITYCONTROLLER_H_
+#define MP_SRC_GRANULARITYCONTROLLER_H_
+
+#include <algorithm>
+
+namespace lamp_search {
+
+/**
+ * Decides how long ExpandNode keeps expanding before returning to Probe.
+ *
+ * Fixed mode reproduces --n / --n_is_ms.
+ * Adaptive mode keeps a per rank probe interval (nano sec) and tunes it
+ * after every Probe, AIMD style:
+ *   - halve the interval when thieves are waiting (pending steal requests)
+ *     or when this rank was idle recently (work is scarce, give quickly),
+ *     as long as the node stack is deep enough to be split,
+ *   - otherwise grow it by 1/8.
+ * The interval never goes below (measured probe cost) / overhead so that
+ * Iprobe overhead stays bounded, and never above max_ns so that lambda
+ * updates and lifeline gives do not stall.
+ */
+class GranularityController {
+public:
+	GranularityController(int n, bool n_is_ms, bool adaptive,
+			long long int min_ns, long long int max_ns, double overhead) :
+			n_(n), n_is_ms_(n_is_ms), adaptive_(adaptive), min_ns_(
+					min_ns), max_ns_(std::max(min_ns, max_ns)), overhead_(
+					overhead) {
+		Init();
+	}
+
+	void Init() {
+		if (n_is_ms_)
+			interval_ = (long long int) n_ * 1000000ll;
+		else
+			interval_ = 1000000ll; // n is a node count, start from 1 ms
+		interval_ = std::min(std::max(interval_, min_ns_), max_ns_);
+		probe_cost_ = 0ll;
+		last_idle_time_ = 0ll;
+		nu_update_ = 0ll;
+	}
+
+	bool Adaptive() const {
+		return adaptive_;
+	}
+
+	// nano sec in adaptive mode
+	long long int Interval() const {
+		return interval_;
+	}
+
+	// value recorded to the periodic log (nano sec, or number of nodes)
+	long long int Granularity() const {
+		if (adaptive_)
+			return interval_;
+		if (n_is_ms_)
+			return (long long int) n_ * 1000000ll;
+		return n_;
+	}
+
+	long long int NuUpdate() const {
+		return nu_update_;
+	}
+
+	/**
+	 * true if ExpandNode should stop and go to Probe
+	 * elapsed is only used in time based mode
+	 */
+	bool ProcessNodeEnd(int processed, long long int elapsed) const {
+		if (adaptive_)
+			return (processed > 0 && elapsed >= interval_);
+		if (n_is_ms_)
+			return (processed > 0 && elapsed >= n_ * 1000000ll); // ms to ns
+		return processed >= n_;
+	}
+
+	bool TimeBased() const {
+		return adaptive_ || n_is_ms_;
+	}
+
+	/**
+	 * probe_cost: time spent in the last Probe
+	 * pending: number of thieves waiting for this rank
+	 * stack_depth: number of itemsets in node_stack_
+	 * idle_time: accumulated idle time of this rank
+	 */
+	void Update(long long int probe_cost, int pending, int stack_depth,
+			long long int idle_time) {
+		if (!adaptive_)
+			return;
+		nu_update_++;
+
+		// EWMA with 1/8 weight, same as TCP srtt
+		if (probe_cost_ == 0ll)
+			probe_cost_ = probe_cost;
+		else
+			probe_cost_ += (probe_cost - probe_cost_) / 8;
+
+		bool was_idle = (idle_time > last_idle_time_);
+		last_idle_time_ = idle_time;
+
+		// Split needs at least 2 itemsets, nothing to give otherwise
+		bool can_give = (stack_depth >= 2);
+
+		if (can_give && (pending > 0 || was_idle))
+			interval_ /= 2;
+		else if (pending == 0)
+			interval_ += interval_ / 8 + 1;
+
+		long long int floor = min_ns_;
+		if (overhead_ > 0.0)
+			floor = std::max(floor,
+					(long long int) (probe_cost_ / overhead_));
+		interval_ = std::min(std::max(interval_, floor), max_ns_);
+	}
+
+private:
+	int n_;
+	bool n_is_ms_;
+	bool adaptive_;
+
+	long long int min_ns_;
+	long long int max_ns_;
+	double overhead_; // allowed (probe cost) / (interval)
+
+	long long int interval_; // current interval in nano sec
+	long long int probe_cost_; // smoothed probe cost in nano sec
+	long long int last_idle_time_;
+	long long int nu_update_;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_GRANULARITYCONTROLLER_H_ */
@@ -7,6 +7,7 @@
 #include "Log.h"
 
 #include <vector>
+#include <limits>
 #include "mp_dfs.h"
 
 namespace lamp_search {
@@ -27,6 +28,15 @@ Log::~Log() {
 
 void Log::Init() {
 	idle_start_ = 0;
+	busy_start_ = -1;
+	cur_phase_ = -1;
+	phase_wall_start_ = 0ll;
+	phase_cpu_start_ = 0ll;
+	phase_trace_start_ = 0ll;
+	for (int k = 0; k < PerfCounters::kNum; k++) {
+		perf_phase_start_[k] = 0ll;
+		perf_expand_start_[k] = 0ll;
+	}
 
 	InitPeriodicLog();
 
@@ -59,14 +69,63 @@ void Log::GatherLog(int nu_proc) {
 			sizeof(LogData), MPI_CHAR, 0, MPI_COMM_WORLD);
 }
 
+void Log::StartPhase(int phase) {
+	FinishPhase();
+	assert(0 <= phase && phase < kPhaseNum);
+	cur_phase_ = phase;
+	phase_wall_start_ = Timer::GetInstance()->Elapsed();
+	phase_cpu_start_ = Timer::GetInstance()->CpuElapsed();
+	phase_trace_start_ = trace_.Now();
+	if (perf_.Available())
+		perf_.Read(perf_phase_start_);
+}
+
+void Log::FinishPhase() {
+	if (cur_phase_ < 0)
+		return;
+	d_.phase_wall_time_[cur_phase_] += Timer::GetInstance()->Elapsed()
+			- phase_wall_start_;
+	d_.phase_cpu_time_[cur_phase_] += Timer::GetInstance()->CpuElapsed()
+			- phase_cpu_start_;
+	trace_.Complete(Tracer::PHASE, phase_trace_start_, cur_phase_);
+	if (perf_.Available()) {
+		long long int v[PerfCounters::kNum];
+		perf_.Read(v);
+		d_.perf_avail_ = 1ll;
+		for (int k = 0; k < PerfCounters::kNum; k++)
+			d_.perf_phase_[cur_phase_][k] += v[k] - perf_phase_start_[k];
+	}
+	cur_phase_ = -1;
+}
+
+void Log::FinishExpand() {
+	if (!perf_.Available())
+		return;
+	long long int v[PerfCounters::kNum];
+	perf_.Read(v);
+	for (int k = 0; k < PerfCounters::kNum; k++)
+		d_.perf_expand_[k] += v[k] - perf_expand_start_[k];
+}
+
+int Log::GiveHistBin(long long int nodes) {
+	int bin = 0;
+	while (nodes > 1 && bin < kGiveHistSize - 1) {
+		nodes >>= 1;
+		bin++;
+	}
+	return bin;
+}
+
 void Log::InitPeriodicLog() {
 	periodic_log_start_ = -1; // -1 means not started
 	next_log_time_in_second_ = 0;
+	plog_accum_bytes_ = 0ll;
 }
 
 void Log::StartPeriodicLog() {
 	periodic_log_start_ = Timer::GetInstance()->Elapsed();
 	next_log_time_in_second_ = 0;
+	plog_accum_bytes_ = d_.dtd_accum_reply_bytes_;
 }
 
 void Log::FinishPeriodicLog() {
@@ -74,7 +133,7 @@ void Log::FinishPeriodicLog() {
 }
 
 void Log::TakePeriodicLog(long long int capacity, int lambda,
-		int phase) {
+		int phase, long long int granularity) {
 	if (periodic_log_start_ >= 0) {
 		long long int current_time = Timer::GetInstance()->Elapsed();
 		long long int elapsed = current_time - periodic_log_start_;
@@ -83,6 +142,9 @@ void Log::TakePeriodicLog(long long int capacity, int lambda,
 			PeriodicLog_T t;
 			t.seconds_ = elapsed;
 			t.capacity_ = capacity;
+			t.granularity_ = granularity;
+			t.accum_bytes_ = d_.dtd_accum_reply_bytes_ - plog_accum_bytes_;
+			plog_accum_bytes_ = d_.dtd_accum_reply_bytes_;
 			t.lambda_ = lambda;
 			t.phase_ = phase;
 
@@ -96,6 +158,24 @@ void Log::TakePeriodicLog(long long int capacity, int lambda,
 void Log::LogData::Init() {
 	search_start_time_ = 0ll;
 
+	for (int p = 0; p < kPhaseNum; p++) {
+		phase_wall_time_[p] = 0ll;
+		phase_cpu_time_[p] = 0ll;
+	}
+	perf_avail_ = 0ll;
+	for (int k = 0; k < PerfCounters::kNum; k++) {
+		for (int p = 0; p < kPhaseNum; p++)
+			perf_phase_[p][k] = 0ll;
+		perf_expand_[k] = 0ll;
+	}
+
+	phase1_end_time_ = 0ll;
+	lambda_final_time_ = 0ll;
+	lambda_update_num_ = 0ll;
+	lambda_probe_ = 0ll;
+	lambda_probe_num_ = 0ll;
+	lambda_probe_time_ = 0ll;
+
 	iprobe_num_ = 0ll;
 	iprobe_time_ = 0ll;
 	iprobe_time_max_ = 0ll;
@@ -108,6 +188,11 @@ void Log::LogData::Init() {
 	iprobe_fail_time_ = 0ll;
 	iprobe_fail_time_max_ = 0ll;
 
+	progress_msg_num_ = 0ll;
+	progress_wait_time_ = 0ll;
+	progress_wait_time_max_ = 0ll;
+	progress_request_wait_time_max_ = 0ll;
+
 	probe_num_ = 0ll;
 	probe_time_ = 0ll;
 	probe_time_max_ = 0ll;
@@ -135,6 +220,38 @@ void Log::LogData::Init() {
 	dtd_phase_per_sec_ = 0.0;
 	dtd_accum_phase_num_ = 0ll;
 	dtd_accum_phase_per_sec_ = 0.0;
+	dtd_accum_reply_num_ = 0ll;
+	dtd_accum_sparse_num_ = 0ll;
+	dtd_accum_reply_bytes_ = 0ll;
+	dtd_accum_reply_bytes_max_ = 0ll;
+	dtd_coll_round_num_ = 0ll;
+	dtd_coll_round_time_ = 0ll;
+	dtd_coll_round_time_max_ = 0ll;
+	dtd_coll_test_num_ = 0ll;
+	dtd_coll_test_time_ = 0ll;
+
+	checkpoint_num_ = 0ll;
+	checkpoint_round_num_ = 0ll;
+	checkpoint_time_ = 0ll;
+	checkpoint_bytes_ = 0ll;
+
+	freq_num_ = 0ll;
+	freq_index_bytes_ = 0ll;
+	freq_stack_bytes_ = 0ll;
+	node_stack_peak_bytes_ = 0ll;
+	freq_stack_peak_bytes_ = 0ll;
+	freq_stack_spill_bytes_ = 0ll;
+
+	fused_store_peak_ = 0ll;
+	fused_compact_num_ = 0ll;
+	fused_fallback_ = 0ll;
+	fused_filter_time_ = 0ll;
+
+	result_num_ = 0ll;
+	result_num_max_ = 0ll;
+	result_exchange_size_ = 0ll;
+	result_bytes_ = 0ll;
+	result_time_ = 0ll;
 	// dtd_reply_num_  = 0ll;
 
 	// accum_phase_num_  = 0ll;
@@ -144,12 +261,27 @@ void Log::LogData::Init() {
 	lifeline_nodes_received_ = 0ll;
 	steal_num_ = 0ll;
 	nodes_received_ = 0ll;
+	steal_reject_num_ = 0ll;
+
+	rma_deposit_num_ = 0ll;
+	rma_deposit_fail_num_ = 0ll;
+	rma_reclaim_num_ = 0ll;
+	rma_steal_fail_num_ = 0ll;
+	rma_claim_num_ = 0ll;
+	rma_claim_time_ = 0ll;
 
 	lifeline_given_num_ = 0ll;
 	lifeline_nodes_given_ = 0ll;
 	given_num_ = 0ll;
 	nodes_given_ = 0ll;
 
+	for (int i = 0; i < kGiveHistSize; i++)
+		give_nodes_hist_[i] = 0ll;
+	give_nodes_max_ = 0ll;
+	give_busy_num_ = 0ll;
+	give_busy_time_ = 0ll;
+	give_busy_time_max_ = 0ll;
+
 	process_node_num_ = 0ll;
 	process_node_time_ = 0ll;
 
@@ -157,6 +289,11 @@ void Log::LogData::Init() {
 
 	idle_time_ = 0ll;
 
+	granularity_update_num_ = 0ll;
+	granularity_sum_ = 0ll;
+	granularity_min_ = std::numeric_limits<long long int>::max();
+	granularity_max_ = 0ll;
+
 	pval_table_time_ = 0ll;
 
 	node_stack_max_itm_ = 0ll;
@@ -170,6 +307,18 @@ void Log::LogData::Init() {
 void Log::Aggregate(int nu_proc) {
 	a_.Init();
 	for (int i = 0; i < nu_proc; i++) {
+		for (int p = 0; p < kPhaseNum; p++) {
+			a_.phase_wall_time_[p] = std::max(a_.phase_wall_time_[p],
+					gather_buf_[i].phase_wall_time_[p]);
+			a_.phase_cpu_time_[p] += gather_buf_[i].phase_cpu_time_[p];
+		}
+		a_.perf_avail_ += gather_buf_[i].perf_avail_;
+		for (int k = 0; k < PerfCounters::kNum; k++) {
+			for (int p = 0; p < kPhaseNum; p++)
+				a_.perf_phase_[p][k] += gather_buf_[i].perf_phase_[p][k];
+			a_.perf_expand_[k] += gather_buf_[i].perf_expand_[k];
+		}
+
 		a_.iprobe_num_ += gather_buf_[i].iprobe_num_;
 		a_.iprobe_time_ += gather_buf_[i].iprobe_time_;
 		a_.iprobe_time_max_ = std::max(a_.iprobe_time_max_,
@@ -185,6 +334,14 @@ void Log::Aggregate(int nu_proc) {
 		a_.iprobe_fail_time_max_ = std::max(a_.iprobe_fail_time_max_,
 				gather_buf_[i].iprobe_fail_time_max_);
 
+		a_.progress_msg_num_ += gather_buf_[i].progress_msg_num_;
+		a_.progress_wait_time_ += gather_buf_[i].progress_wait_time_;
+		a_.progress_wait_time_max_ = std::max(a_.progress_wait_time_max_,
+				gather_buf_[i].progress_wait_time_max_);
+		a_.progress_request_wait_time_max_ = std::max(
+				a_.progress_request_wait_time_max_,
+				gather_buf_[i].progress_request_wait_time_max_);
+
 		a_.probe_num_ += gather_buf_[i].probe_num_;
 		a_.probe_time_ += gather_buf_[i].probe_time_;
 		a_.probe_time_max_ = std::max(a_.probe_time_max_,
@@ -219,12 +376,80 @@ void Log::Aggregate(int nu_proc) {
 		a_.lifeline_nodes_received_ += gather_buf_[i].lifeline_nodes_received_;
 		a_.steal_num_ += gather_buf_[i].steal_num_;
 		a_.nodes_received_ += gather_buf_[i].nodes_received_;
+		a_.steal_reject_num_ += gather_buf_[i].steal_reject_num_;
+
+		a_.dtd_accum_reply_num_ += gather_buf_[i].dtd_accum_reply_num_;
+		a_.dtd_accum_sparse_num_ += gather_buf_[i].dtd_accum_sparse_num_;
+		a_.dtd_accum_reply_bytes_ += gather_buf_[i].dtd_accum_reply_bytes_;
+		a_.dtd_accum_reply_bytes_max_ = std::max(
+				a_.dtd_accum_reply_bytes_max_,
+				gather_buf_[i].dtd_accum_reply_bytes_max_);
+		a_.dtd_coll_round_num_ += gather_buf_[i].dtd_coll_round_num_;
+		a_.dtd_coll_round_time_ += gather_buf_[i].dtd_coll_round_time_;
+		a_.dtd_coll_round_time_max_ = std::max(
+				a_.dtd_coll_round_time_max_,
+				gather_buf_[i].dtd_coll_round_time_max_);
+		a_.dtd_coll_test_num_ += gather_buf_[i].dtd_coll_test_num_;
+		a_.dtd_coll_test_time_ += gather_buf_[i].dtd_coll_test_time_;
+
+		a_.phase1_end_time_ = std::max(a_.phase1_end_time_,
+				gather_buf_[i].phase1_end_time_);
+		a_.lambda_final_time_ = std::max(a_.lambda_final_time_,
+				gather_buf_[i].lambda_final_time_);
+		a_.lambda_update_num_ += gather_buf_[i].lambda_update_num_;
+		a_.lambda_probe_ = gather_buf_[i].lambda_probe_; // same on all ranks
+		a_.lambda_probe_num_ += gather_buf_[i].lambda_probe_num_;
+		a_.lambda_probe_time_ = std::max(a_.lambda_probe_time_,
+				gather_buf_[i].lambda_probe_time_);
+
+		a_.checkpoint_time_ = std::max(a_.checkpoint_time_,
+				gather_buf_[i].checkpoint_time_);
+		a_.checkpoint_bytes_ += gather_buf_[i].checkpoint_bytes_;
+
+		a_.freq_num_ += gather_buf_[i].freq_num_;
+		a_.freq_index_bytes_ += gather_buf_[i].freq_index_bytes_;
+		a_.freq_stack_bytes_ += gather_buf_[i].freq_stack_bytes_;
+		a_.node_stack_peak_bytes_ = std::max(a_.node_stack_peak_bytes_,
+				gather_buf_[i].node_stack_peak_bytes_);
+		a_.freq_stack_peak_bytes_ = std::max(a_.freq_stack_peak_bytes_,
+				gather_buf_[i].freq_stack_peak_bytes_);
+		a_.freq_stack_spill_bytes_ += gather_buf_[i].freq_stack_spill_bytes_;
+
+		a_.fused_store_peak_ = std::max(a_.fused_store_peak_,
+				gather_buf_[i].fused_store_peak_);
+		a_.fused_compact_num_ += gather_buf_[i].fused_compact_num_;
+		a_.fused_filter_time_ = std::max(a_.fused_filter_time_,
+				gather_buf_[i].fused_filter_time_);
+
+		a_.result_num_ += gather_buf_[i].result_num_;
+		a_.result_num_max_ = std::max(a_.result_num_max_,
+				gather_buf_[i].result_num_);
+		a_.result_exchange_size_ += gather_buf_[i].result_exchange_size_;
+		a_.result_bytes_ += gather_buf_[i].result_bytes_;
+		a_.result_time_ = std::max(a_.result_time_,
+				gather_buf_[i].result_time_);
+
+		a_.rma_deposit_num_ += gather_buf_[i].rma_deposit_num_;
+		a_.rma_deposit_fail_num_ += gather_buf_[i].rma_deposit_fail_num_;
+		a_.rma_reclaim_num_ += gather_buf_[i].rma_reclaim_num_;
+		a_.rma_steal_fail_num_ += gather_buf_[i].rma_steal_fail_num_;
+		a_.rma_claim_num_ += gather_buf_[i].rma_claim_num_;
+		a_.rma_claim_time_ += gather_buf_[i].rma_claim_time_;
 
 		a_.lifeline_given_num_ += gather_buf_[i].lifeline_given_num_;
 		a_.lifeline_nodes_given_ += gather_buf_[i].lifeline_nodes_given_;
 		a_.given_num_ += gather_buf_[i].given_num_;
 		a_.nodes_given_ += gather_buf_[i].nodes_given_;
 
+		for (int j = 0; j < kGiveHistSize; j++)
+			a_.give_nodes_hist_[j] += gather_buf_[i].give_nodes_hist_[j];
+		a_.give_nodes_max_ = std::max(a_.give_nodes_max_,
+				gather_buf_[i].give_nodes_max_);
+		a_.give_busy_num_ += gather_buf_[i].give_busy_num_;
+		a_.give_busy_time_ += gather_buf_[i].give_busy_time_;
+		a_.give_busy_time_max_ = std::max(a_.give_busy_time_max_,
+				gather_buf_[i].give_busy_time_max_);
+
 		a_.process_node_num_ += gather_buf_[i].process_node_num_;
 		a_.process_node_time_ += gather_buf_[i].process_node_time_;
 
@@ -232,6 +457,13 @@ void Log::Aggregate(int nu_proc) {
 
 		a_.idle_time_ += gather_buf_[i].idle_time_;
 
+		a_.granularity_update_num_ += gather_buf_[i].granularity_update_num_;
+		a_.granularity_sum_ += gather_buf_[i].granularity_sum_;
+		a_.granularity_min_ = std::min(a_.granularity_min_,
+				gather_buf_[i].granularity_min_);
+		a_.granularity_max_ = std::max(a_.granularity_max_,
+				gather_buf_[i].granularity_max_);
+
 		a_.pval_table_time_ += gather_buf_[i].pval_table_time_;
 
 		a_.node_stack_max_itm_ = std::max(a_.node_stack_max_itm_,
@@ -10,7 +10,46 @@
 
 #include <vector>
 
+#include "../src/timer.h"
+#include "PerfCounters.h"
+#include "Telemetry.h"
+#include "Tracer.h"
+
 namespace lamp_search {
+
+/**
+ * Adds the wall time of a scope to *time and raises *time_max (may be
+ * NULL). The clock is read only with LOG on (no OPTLOG), so the object is
+ * empty in the optimized build.
+ */
+class ScopedTime {
+public:
+	ScopedTime(long long int * time, long long int * time_max)
+#ifndef OPTLOG
+	:
+			time_(time), time_max_(time_max), start_(FastClock::Now())
+#endif
+	{
+		(void) time;
+		(void) time_max;
+	}
+	~ScopedTime() {
+#ifndef OPTLOG
+		long long int t = FastClock::Now() - start_;
+		*time_ += t;
+		if (time_max_ != NULL && t > *time_max_)
+			*time_max_ = t;
+#endif
+	}
+
+private:
+#ifndef OPTLOG
+	long long int * time_;
+	long long int * time_max_;
+	long long int start_;
+#endif
+};
+
 class Log {
 public:
 	Log();
@@ -18,9 +57,37 @@ public:
 	void Init();
 
 	long long int idle_start_;
+	long long int busy_start_; // -1 unless working on received nodes
+
+	// per give histogram of node num: [1], [2,3], [4,7], ...
+	static const int kGiveHistSize = 16;
+	static int GiveHistBin(long long int nodes);
 
 	void GatherLog(int nu_proc);
 
+	// wall and cpu time of each phase, 0: preprocess
+	static const int kPhaseNum = 4;
+	// closes the current phase
+	void StartPhase(int phase);
+	void FinishPhase();
+	int cur_phase_; // -1 if none
+	long long int phase_wall_start_;
+	long long int phase_cpu_start_;
+	long long int phase_trace_start_;
+
+	Tracer trace_; // --trace
+	Telemetry telemetry_; // --telemetry_file
+
+	// --perf. counted per phase and within ExpandNode granules
+	PerfCounters perf_;
+	long long int perf_phase_start_[PerfCounters::kNum];
+	long long int perf_expand_start_[PerfCounters::kNum];
+	void StartExpand() {
+		if (perf_.Available())
+			perf_.Read(perf_expand_start_);
+	}
+	void FinishExpand();
+
 	//--------
 	// periodic log
 
@@ -30,18 +97,24 @@ public:
 
 	long long int periodic_log_start_;
 	long long int next_log_time_in_second_;
+	long long int plog_accum_bytes_; // d_.dtd_accum_reply_bytes_ at last record
 
 	// show this separately for phase_ 1 and 2
-	void TakePeriodicLog(long long int capacity, int lambda, int phase);
+	void TakePeriodicLog(long long int capacity, int lambda, int phase,
+			long long int granularity = 0ll);
 	struct PeriodicLog_T {
 		void Clear() {
 			seconds_ = 0ll;
 			capacity_ = 0ll;
+			granularity_ = 0ll;
+			accum_bytes_ = 0ll;
 			lambda_ = 0;
 			phase_ = 0;
 		}
 		long long int seconds_;
 		long long int capacity_;
+		long long int granularity_; // nano sec (or node num if n is num task)
+		long long int accum_bytes_; // DTD accum replies sent since last record
 		int lambda_;
 		int phase_;
 	};
@@ -61,6 +134,25 @@ public:
 		long long int search_start_time_;
 		long long int search_finish_time_;
 
+		// wall: time until the phase ends, also blocked in MPI
+		// cpu: process cpu time (with the progress thread)
+		long long int phase_wall_time_[kPhaseNum];
+		long long int phase_cpu_time_[kPhaseNum];
+
+		// --perf. perf_avail_: 1 if the counters are open (ranks in a_)
+		long long int perf_avail_;
+		long long int perf_phase_[kPhaseNum][PerfCounters::kNum];
+		long long int perf_expand_[PerfCounters::kNum];
+
+		// from search_start_time_
+		long long int phase1_end_time_;
+		long long int lambda_final_time_; // last lambda update in phase 1
+		long long int lambda_update_num_;
+		// --lambda_probe
+		long long int lambda_probe_; // lower bound of lambda
+		long long int lambda_probe_num_; // closed sets expanded
+		long long int lambda_probe_time_;
+
 		long long int iprobe_num_;
 		long long int iprobe_time_;
 		long long int iprobe_time_max_;
@@ -73,6 +165,12 @@ public:
 		long long int iprobe_fail_time_;
 		long long int iprobe_fail_time_max_;
 
+		// progress thread: from receiving a message to processing it
+		long long int progress_msg_num_;
+		long long int progress_wait_time_;
+		long long int progress_wait_time_max_;
+		long long int progress_request_wait_time_max_;
+
 		long long int probe_num_;
 		long long int probe_time_;
 		long long int probe_time_max_;
@@ -100,6 +198,39 @@ public:
 		double dtd_phase_per_sec_;
 		long long int dtd_accum_phase_num_;
 		double dtd_accum_phase_per_sec_;
+		long long int dtd_accum_reply_num_;
+		long long int dtd_accum_sparse_num_; // sent as (index, delta)
+		long long int dtd_accum_reply_bytes_;
+		long long int dtd_accum_reply_bytes_max_;
+		long long int dtd_coll_round_num_; // --dtd_engine=1
+		long long int dtd_coll_round_time_; // start to completion
+		long long int dtd_coll_round_time_max_;
+		long long int dtd_coll_test_num_;
+		long long int dtd_coll_test_time_;
+
+		long long int checkpoint_num_;
+		long long int checkpoint_round_num_; // Allreduce until quiescent
+		long long int checkpoint_time_;
+		long long int checkpoint_bytes_;
+
+		long long int freq_num_; // testable sets after phase 2
+		long long int freq_index_bytes_; // TestableSet
+		long long int freq_stack_bytes_; // used part of freq_stack_
+		// allocated bytes of the growable stacks, the largest during the run
+		long long int node_stack_peak_bytes_;
+		long long int freq_stack_peak_bytes_; // in memory
+		long long int freq_stack_spill_bytes_; // --spill_dir
+
+		long long int fused_store_peak_; // --fused, bytes
+		long long int fused_compact_num_;
+		long long int fused_fallback_; // 1: two passes after all
+		long long int fused_filter_time_;
+
+		long long int result_num_; // --result_file, sets after exchange
+		long long int result_num_max_;
+		long long int result_exchange_size_; // ints sent
+		long long int result_bytes_;
+		long long int result_time_;
 		//long long int dtd_reply_num_;
 
 		// long long int accum_phase_num_; // completed accum phase num
@@ -109,12 +240,28 @@ public:
 		long long int lifeline_nodes_received_;
 		long long int steal_num_;
 		long long int nodes_received_;
+		long long int steal_reject_num_; // requests rejected by the victim
+
+		// one sided stealing (--steal_backend=1)
+		long long int rma_deposit_num_;
+		long long int rma_deposit_fail_num_; // not deposited, kept
+		long long int rma_reclaim_num_; // took back own deposit
+		long long int rma_steal_fail_num_;
+		long long int rma_claim_num_;
+		long long int rma_claim_time_;
 
 		long long int lifeline_given_num_;
 		long long int lifeline_nodes_given_;
 		long long int given_num_;
 		long long int nodes_given_;
 
+		long long int give_nodes_hist_[kGiveHistSize];
+		long long int give_nodes_max_;
+		// time until a thief runs out of the received nodes
+		long long int give_busy_num_;
+		long long int give_busy_time_;
+		long long int give_busy_time_max_;
+
 		long long int process_node_num_;
 		long long int process_node_time_;
 
@@ -122,6 +269,12 @@ public:
 
 		long long int idle_time_;
 
+		// adaptive granularity (nano sec)
+		long long int granularity_update_num_;
+		long long int granularity_sum_;
+		long long int granularity_min_;
+		long long int granularity_max_;
+
 		long long int pval_table_time_;
 
 		long long int node_stack_max_itm_;
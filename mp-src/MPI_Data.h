@@ -14,7 +14,9 @@
 #include "StealState.h"
 #include "Log.h"
 #include "DTD.h"
+#include "Topology.h"
 #include "SignificantSetResults.h"
+#include "TestableSet.h"
 #include "../src/variable_length_itemset.h"
 #include "../src/utils.h"
 #include "../src/lamp_graph.h"
@@ -114,7 +116,7 @@ struct GetMinSupData {
 struct GetTestableData {
 	GetTestableData(int lambda_max_minus_one,
 			VariableLengthItemsetStack * freq_stack,
-			std::multimap<double, int *>* freq_map, double sig_level) :
+			TestableSet* freq_map, double sig_level) :
 			freqThreshold_(lambda_max_minus_one), freq_stack_(
 					freq_stack), freq_map_(freq_map), sig_level_(
 					sig_level) {
@@ -122,14 +124,14 @@ struct GetTestableData {
 	int freqThreshold_;
 	// Retrun variables. Used for GetSignificantPatterns.
 	VariableLengthItemsetStack * freq_stack_; // record freq itemsets
-	std::multimap<double, int *>* freq_map_; // record (pval, *itemsets)
+	TestableSet* freq_map_; // record (pval, itemset offset)
 	double sig_level_;
 //	VariableLengthItemsetStack * significant_stack_; // TODO:
 };
 
 struct GetSignificantData {
 	GetSignificantData(VariableLengthItemsetStack * freq_stack_,
-			std::multimap<double, int *>* freq_map_,
+			TestableSet* freq_map_,
 			double final_sig_level_,
 			VariableLengthItemsetStack * significant_stack_,
 			std::set<SignificantSetResult, sigset_compare>* significant_set_) :
@@ -139,7 +141,7 @@ struct GetSignificantData {
 					significant_set_) {
 	}
 	VariableLengthItemsetStack * freq_stack_; // record freq itemsets
-	std::multimap<double, int *>* freq_map_; // record (pval, *itemsets)
+	TestableSet* freq_map_; // record (pval, itemset offset)
 	double final_sig_level_;
 	VariableLengthItemsetStack * significant_stack_;
 	std::set<SignificantSetResult, sigset_compare>* significant_set_;
@@ -148,7 +150,7 @@ struct GetSignificantData {
 // TODO: Duplicate. Refactor
 struct GetContSignificantData {
 	GetContSignificantData(VariableLengthItemsetStack * freq_stack_,
-			std::multimap<double, int *>* freq_map_,
+			TestableSet* freq_map_,
 			double final_sig_level_,
 			VariableLengthItemsetStack * significant_stack_,
 			std::set<ContSignificantSetResult, cont_sigset_compare>* significant_set_) :
@@ -158,7 +160,7 @@ struct GetContSignificantData {
 					significant_set_) {
 	}
 	VariableLengthItemsetStack * freq_stack_; // record freq itemsets
-	std::multimap<double, int *>* freq_map_; // record (pval, *itemsets)
+	TestableSet* freq_map_; // record (pval, itemset offset)
 	double final_sig_level_;
 	VariableLengthItemsetStack * significant_stack_;
 	std::set<ContSignificantSetResult, cont_sigset_compare>* significant_set_;
@@ -167,15 +169,15 @@ struct GetContSignificantData {
 struct MPI_Data {
 	MPI_Data(int buffer_size, int rank, int nu_proc, int n,
 			bool n_is_ms, int w, int m, int l, int k_echo_tree_branch,
-			DTD* dtd_) :
+			DTD* dtd_, bool topology_aware = false) :
 			dtd_(dtd_), mpiRank_(rank), nTotalProc_(nu_proc), granularity_(
 					n), isGranularitySec_(n_is_ms), nRandStealTrials_(
 					w), nRandStealCands_(m), lHypercubeEdge_(l), hypercubeDimension_(
 					ComputeZ(nTotalProc_, lHypercubeEdge_)), rng_(
 					mpiRank_), dst_p_(0, nTotalProc_ - 1), dst_m_(0,
 					nRandStealCands_ - 1), rand_p_(rng_, dst_p_), rand_m_(
-					rng_, dst_m_), echo_waiting_(false), waiting_(
-					false) {
+					rng_, dst_m_), echo_waiting_(false), topology_(NULL), nLocalVictims_(
+					0), waiting_(false) {
 		// Initializing temporary variables in parenths.
 		processing_node_ = false;
 		bsend_buffer_ = new int[buffer_size];
@@ -187,12 +189,21 @@ struct MPI_Data {
 		}
 		printf("bsend_buffer\n");
 
-		prepareVictims();
-		prepareLifelines();
+		if (topology_aware) {
+			topology_ = new Topology(Topology::DetectNodes(MPI_COMM_WORLD));
+			prepareTopologyVictims();
+			prepareTopologyLifelines();
+		} else {
+			prepareVictims();
+			prepareLifelines();
+		}
 
 		thieves_ = new FixedSizeStack(nTotalProc_);
+		// in-degree of the two level lifeline graph is not uniform
 		lifeline_thieves_ = new FixedSizeStack(
-				hypercubeDimension_ + k_echo_tree_branch);
+				topology_ ?
+						nTotalProc_ + k_echo_tree_branch :
+						hypercubeDimension_ + k_echo_tree_branch);
 		lifelines_activated_ = new bool[nTotalProc_];
 		accum_flag_ = new bool[k_echo_tree_branch];
 		bcast_targets_ = new int[k_echo_tree_branch];
@@ -216,6 +227,7 @@ struct MPI_Data {
 		delete[] lifelines_activated_;
 		delete[] accum_flag_;
 		delete[] bcast_targets_;
+		delete topology_;
 		int size;
 		MPI_Buffer_detach(&bsend_buffer_, &size);
 //		assert(size == FLAGS_bsend_buffer_size * sizeof(int));
@@ -266,6 +278,70 @@ struct MPI_Data {
 		printf("topology\n");
 	}
 
+	/**
+	 * Same node victims come first in victims_[0..nLocalVictims_),
+	 * then victims on the other nodes.
+	 */
+	void prepareTopologyVictims() {
+		victims_ = new int[nRandStealCands_];
+		if (nTotalProc_ <= 1)
+			return;
+		int node = topology_->NodeOf(mpiRank_);
+		int local_peers = topology_->LocalSize(node) - 1;
+		int remote = nTotalProc_ - topology_->LocalSize(node);
+
+		if (remote == 0)
+			nLocalVictims_ = nRandStealCands_;
+		else if (local_peers == 0)
+			nLocalVictims_ = 0;
+		else
+			nLocalVictims_ = std::min(local_peers,
+					std::max(1, nRandStealCands_ / 2));
+
+		for (int pi = 0; pi < nRandStealCands_; pi++) {
+			int r;
+			while (true) {
+				r = rand_p_();
+				if (r != mpiRank_
+						&& topology_->SameNode(r, mpiRank_)
+								== (pi < nLocalVictims_))
+					break;
+			}
+			victims_[pi] = r;
+		}
+		printf("victims (topology)\n");
+	}
+
+	void prepareTopologyLifelines() {
+		std::vector<int> lifelines = topology_->Lifelines(mpiRank_,
+				lHypercubeEdge_);
+		hypercubeDimension_ = std::max((int) lifelines.size(), 1);
+		lifelines_ = new int[hypercubeDimension_];
+		for (int zi = 0; zi < hypercubeDimension_; zi++)
+			lifelines_[zi] = -1;
+		for (std::size_t zi = 0; zi < lifelines.size(); zi++)
+			lifelines_[zi] = lifelines[zi];
+		printf("topology (nodes=%d)\n", topology_->NuNode());
+	}
+
+	/**
+	 * trial: random steal counter [0..nRandStealTrials_)
+	 * With topology, the first half of the trials go to the same node.
+	 */
+	int RandomVictim(int trial) {
+		if (topology_ == NULL || nLocalVictims_ == 0
+				|| nLocalVictims_ == nRandStealCands_)
+			return victims_[rand_m_()];
+		if (trial < (nRandStealTrials_ + 1) / 2) {
+			boost::uniform_smallint<int> dst(0, nLocalVictims_ - 1);
+			return victims_[dst(rng_)];
+		} else {
+			boost::uniform_smallint<int> dst(nLocalVictims_,
+					nRandStealCands_ - 1);
+			return victims_[dst(rng_)];
+		}
+	}
+
 	static int ComputeZ(int p, int l) {
 		int z0 = 1;
 		int zz = l;
@@ -306,6 +382,9 @@ struct MPI_Data {
 	int * victims_; // proc id of random victims
 	int * lifelines_; // proc id of lifeline buddies
 
+	Topology * topology_; // NULL unless topology aware
+	int nLocalVictims_; // victims_[0..nLocalVictims_) are on the same node
+
 	FixedSizeStack * thieves_; // max size == nu_proc_
 	FixedSizeStack * lifeline_thieves_; // size == lifelines_ size + 3
 	bool * lifelines_activated_;
@@ -82,7 +82,8 @@ void ParallelContinuousPM::GetDiscretizedMinimalSupport(double freqRatio) {
 	long long int* accum_array_ = &(dtd_accum_array_base_[3]); // TODO: ???
 	long long int* accum_recv_ = &(dtd_accum_recv_base_[3]);
 	long long int* cs_thr_; // TODO: moc
-	for (int i = 0; i < thresholds.size(); ++i) {
+	// accum_array_[0..thresholds.size()] are sent and summed
+	for (int i = 0; i <= thresholds.size(); ++i) {
 		accum_array_[i] = 0;
 		accum_recv_[i] = 0;
 	}
@@ -130,9 +131,11 @@ void ParallelContinuousPM::GetSignificantPatterns(
 		SendResultRequest();
 	}
 	printf("probe\n");
+	StartProgress();
 	while (!mpi_data.dtd_->terminated_) {
 		Probe(treesearch_data);
 	}
+	StopProgress();
 }
 
 /**
@@ -374,8 +377,7 @@ bool ParallelContinuousPM::ExpandNode(
 //			}
 		}
 
-		if (CheckProcessNodeEnd(mpi_data.granularity_,
-				mpi_data.isGranularitySec_, processed, start_time))
+		if (CheckProcessNodeEnd(processed, start_time))
 			break;
 	}
 
@@ -541,8 +543,7 @@ void ParallelContinuousPM::ProcessNode(double freq,
 			gettestable_data->freq_stack_->CopyItem(ppc_ext_buf,
 					item);
 			gettestable_data->freq_stack_->PushPostNoSort();
-			gettestable_data->freq_map_->insert(
-					std::pair<double, int*>(freq, item));
+			gettestable_data->freq_map_->Push(freq, item);
 		}
 	}
 }
@@ -553,10 +554,19 @@ void ParallelContinuousPM::CheckProbe(int& accum_period_counter_,
 // TODO: whatever this is trying to do, it should be factored into a function.
 //       Why is it Probing while in the expansion loop?
 	accum_period_counter_++;
+	if (progress_ != NULL) {
+		// messages are already received. no need to look at the clock
+		if (UrgentMessage()) {
+			Probe(treesearch_data);
+			Distribute(treesearch_data);
+			Reject();
+		}
+		return;
+	}
 	if (FLAGS_probe_period_is_ms_) {      // using milli second
 		if (accum_period_counter_ >= 64) { // TODO: what is this magic number?
 			// to avoid calling timer_ frequently, time is checked once in 64 loops
-			// clock_gettime takes 0.3--0.5 micro sec
+			// FastClock takes a few nano sec (tens without the TSC)
 			accum_period_counter_ = 0;
 			long long int elt = timer_->Elapsed();
 			if (elt - lap_time >= FLAGS_probe_period_ * 1000000) {
@@ -585,23 +595,6 @@ void ParallelContinuousPM::CheckProbe(int& accum_period_counter_,
 // note: do this before PushPre is called [2015-10-05 21:56]
 }
 
-bool ParallelContinuousPM::CheckProcessNodeEnd(int n, bool n_is_ms,
-		int processed, long long int start_time) {
-//	printf("CheckProcessNodeEnd\n");
-	long long int elapsed_time;
-	if (n_is_ms) {
-		if (processed > 0) {
-			elapsed_time = timer_->Elapsed() - start_time;
-			if (elapsed_time >= n * 1000000) {  // ms to ns
-				return true;
-			}
-		}
-	} else if (processed >= n)
-		return true;
-
-	return false;
-}
-
 bool ParallelContinuousPM::HasJobToDo() {
 	return !(treesearch_data->node_stack_->Empty())
 			|| (mpi_data.thieves_->Size() > 0)
@@ -1322,7 +1315,8 @@ void ParallelContinuousPM::ExtractSignificantSet() {
 //	printf("ExtractSignificantSet\n");
 
 //	double thre_bonferroni = d_->CalculatePMin(pmin_thre_);
-	std::multimap<double, int *>::iterator it;
+	TestableSet * freq = getsignificant_data->freq_map_;
+	freq->Sort(); // significant_stack_ in freq order
 //	printf("bonferroni corrected threshold = %.8f (sig_level_)\n",
 //			getsignificant_data->final_sig_level_);
 //	printf("bonferroni corrected threshold = %.8f (thre_pmin_)\n",
@@ -1333,14 +1327,13 @@ void ParallelContinuousPM::ExtractSignificantSet() {
 //			alpha_ / thre_pmin_);
 //	printf("#Testable Pattern = %.4f (alpha/final_sig_level_)\n",
 //			alpha_ / getsignificant_data->final_sig_level_);
-	for (it = getsignificant_data->freq_map_->begin();
-			it != getsignificant_data->freq_map_->end(); ++it) {
+	for (std::size_t k = 0; k < freq->Size(); k++) {
 		// TODO: Here we should implement calculating p-value.
 		std::vector<int> itemset =
 				getsignificant_data->freq_stack_->getItems(
-						(*it).second);
+						freq->Itemset(k));
 		double actual_pvalue = d_->CalculatePValue(itemset);
-//		double minimal_pvalue = d_->CalculatePMin((*it).first);
+//		double minimal_pvalue = d_->CalculatePMin(freq->Pval(k));
 		// TODO: equal??
 		if (actual_pvalue <= thre_pmin_) {
 //			printf("Significant Itemset = ");
@@ -1348,13 +1341,13 @@ void ParallelContinuousPM::ExtractSignificantSet() {
 //				printf("%d ", itemset[i]);
 //			}
 //			printf(": Pvalue = %.8f, Pmin = %.8f, Freq = %.8f \n",
-//					actual_pvalue, minimal_pvalue, (*it).first);
+//					actual_pvalue, minimal_pvalue, freq->Pval(k));
 			getsignificant_data->significant_stack_->PushPre();
 			int * item =
 					getsignificant_data->significant_stack_->Top();
 
 			getsignificant_data->significant_stack_->CopyItem(
-					(*it).second, item);
+					freq->Itemset(k), item);
 			getsignificant_data->significant_stack_->PushPostNoSort();
 		} else {
 //			printf("Insignificant but Testable Itemset = ");
@@ -1362,7 +1355,7 @@ void ParallelContinuousPM::ExtractSignificantSet() {
 //				printf("%d ", itemset[i]);
 //			}
 //			printf(": Pvalue = %.8f, Pmin = %.8f, Freq = %.8f \n",
-//					actual_pvalue, minimal_pvalue, (*it).first);
+//					actual_pvalue, minimal_pvalue, freq->Pval(k));
 		}
 	}
 }
@@ -92,8 +92,6 @@ protected:
 	void ProcessNode(double freq, int* ppc_ext_buf);
 	void CheckProbe(int& accum_period_counter_,
 			long long int lap_time);
-	bool CheckProcessNodeEnd(int n, bool n_is_ms, int processed,
-			long long int start_time);
 
 	//--------
 
@@ -7,6 +7,45 @@
 
 #include "ParallelDFS.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+DEFINE_bool(adaptive_n, false,
+		"adapt granularity (--n) per rank from probe cost and steal demand");
+DEFINE_int32(adaptive_n_min, 100,
+		"lower bound of adaptive granularity (micro sec)");
+DEFINE_int32(adaptive_n_max, 100000,
+		"upper bound of adaptive granularity (micro sec)");
+DEFINE_double(adaptive_n_overhead, 0.01,
+		"adaptive granularity keeps (probe time) / (granularity) below this");
+DEFINE_int32(split_policy, 0,
+		"work splitting. 0: every other itemset, 1: shallowest half, "
+		"2: estimated subtree size, 3: interleave by last item");
+DEFINE_bool(progress_thread, false,
+		"receive messages in a separate thread (needs MPI_THREAD_MULTIPLE)");
+DEFINE_int32(progress_queue_size, 4096,
+		"capacity of the queue from the progress thread");
+DEFINE_int32(steal_backend, 0,
+		"work stealing. 0: request / give messages, "
+		"1: one sided (MPI-3 RMA) work pool");
+DEFINE_int32(rma_pool_size, 1024 * 256,
+		"max number of ints in the one sided work pool of each process");
+DEFINE_bool(topology, false,
+		"steal from the same node first and keep most lifelines within a node");
+DEFINE_int32(checkpoint_interval, 0,
+		"write a checkpoint every this many seconds (0: only on SIGUSR1 / "
+		"SIGUSR2)");
+DEFINE_string(checkpoint_prefix, "lamp",
+		"checkpoint files are <prefix>.<rank>.ckpt");
+DEFINE_int32(dtd_engine, 0,
+		"termination detection and lambda update. 0: echo over the "
+		"broadcast tree, 1: nonblocking collectives (MPI_Iallreduce)");
+
 #ifdef __CDT_PARSER__
 #undef DBG
 #define DBG(a)  a
@@ -24,23 +63,67 @@ const int ParallelDFS::k_echo_tree_branch = 3;
 ParallelDFS::ParallelDFS(MPI_Data& mpi_data,
 		TreeSearchData* treesearch_data, Log* log, Timer* timer,
 		std::ostream& ofs) :
-		mpi_data(mpi_data), treesearch_data(treesearch_data), log_(
-				log), timer_(timer), lfs_(ofs) {
-
+		coll_dtd_(NULL), searching_(false), checkpoint_enabled_(false), checkpoint_pending_(
+				Checkpoint::NONE), checkpoint_request_(Checkpoint::NONE), checkpointing_(
+				false), mpi_data(mpi_data), treesearch_data(treesearch_data), granularity_ctl_(
+				mpi_data.granularity_, mpi_data.isGranularitySec_,
+				FLAGS_adaptive_n, FLAGS_adaptive_n_min * 1000ll,
+				FLAGS_adaptive_n_max * 1000ll, FLAGS_adaptive_n_overhead), progress_(
+				NULL), recv_msg_(NULL), rma_pool_(NULL), log_(log), timer_(
+				timer), lfs_(ofs) {
+	if (FLAGS_progress_thread) {
+		if (ProgressThread::Available())
+			progress_ = new ProgressThread(FLAGS_progress_queue_size,
+					Tag::REQUEST);
+		else if (mpi_data.mpiRank_ == 0)
+			printf("MPI_THREAD_MULTIPLE is not provided."
+					" ignoring --progress_thread\n");
+	}
+	// collective
+	if (FLAGS_steal_backend == STEAL_RMA && mpi_data.nTotalProc_ > 1)
+		rma_pool_ = new RMAWorkPool(MPI_COMM_WORLD,
+				std::min(FLAGS_rma_pool_size,
+						treesearch_data->give_stack_->TotalCapacity()));
+	checkpoint_last_ = MPI_Wtime();
 }
 
 ParallelDFS::~ParallelDFS() {
-	// TODO Auto-generated destructor stub
+	if (progress_)
+		delete progress_;
+	if (rma_pool_)
+		delete rma_pool_;
+	if (coll_dtd_)
+		delete coll_dtd_;
+}
+
+void ParallelDFS::StartProgress() {
+	if (progress_)
+		progress_->Start();
+}
+
+void ParallelDFS::StopProgress() {
+	if (progress_)
+		progress_->Stop();
 }
 
 void ParallelDFS::Search() {
 
 	printf("ParallelDFS::Search\n");
+	log_->busy_start_ = -1;
+	searching_ = true;
+	StartProgress();
 	DBG(D(1) << "MainLoop" << std::endl
 	; );
 	while (!mpi_data.dtd_->terminated_) {
 		while (!mpi_data.dtd_->terminated_) {
-			if (ExpandNode(treesearch_data)) {
+			long long int trace_start = log_->trace_.Now();
+			long long int node_num = log_->d_.process_node_num_;
+			log_->StartExpand();
+			bool expanded = ExpandNode(treesearch_data);
+			log_->FinishExpand();
+			log_->trace_.Complete(Tracer::EXPAND, trace_start, 0,
+					log_->d_.process_node_num_ - node_num);
+			if (expanded) {
 				log_->d_.node_stack_max_itm_ =
 						std::max(log_->d_.node_stack_max_itm_,
 								(long long int) (treesearch_data->node_stack_->NuItemset()));
@@ -50,6 +133,7 @@ void ParallelDFS::Search() {
 				Probe(treesearch_data);
 				if (mpi_data.dtd_->terminated_)
 					break;
+				CheckCheckpoint();
 				Distribute(treesearch_data);
 				Reject(); // distribute finished, reject remaining requests
 
@@ -62,11 +146,21 @@ void ParallelDFS::Search() {
 			break;
 
 		log_->idle_start_ = timer_->Elapsed();
+		long long int idle_trace_start = log_->trace_.Now();
+		if (log_->busy_start_ >= 0) { // ran out of received nodes
+			long long int busy = log_->idle_start_ - log_->busy_start_;
+			log_->d_.give_busy_num_++;
+			log_->d_.give_busy_time_ += busy;
+			log_->d_.give_busy_time_max_ = std::max(
+					log_->d_.give_busy_time_max_, busy);
+			log_->busy_start_ = -1;
+		}
 		Reject(); // node_stack_ empty. reject requests
 		Steal(); // request steal
 		if (mpi_data.dtd_->terminated_) {
 			log_->d_.idle_time_ += timer_->Elapsed()
 					- log_->idle_start_;
+			log_->trace_.Complete(Tracer::IDLE, idle_trace_start);
 			break;
 		}
 
@@ -74,12 +168,20 @@ void ParallelDFS::Search() {
 		if (mpi_data.dtd_->terminated_) {
 			log_->d_.idle_time_ += timer_->Elapsed()
 					- log_->idle_start_;
+			log_->trace_.Complete(Tracer::IDLE, idle_trace_start);
 			break;
 		}
+		CheckCheckpoint();
 		Check(); // Implement CheckCSThreshold().
 
 		log_->d_.idle_time_ += timer_->Elapsed() - log_->idle_start_;
+		log_->trace_.Complete(Tracer::IDLE, idle_trace_start);
 	}
+	// CHECKPOINT and BCAST_FINISH received in the same Probe
+	if (checkpoint_pending_ != Checkpoint::NONE)
+		DoCheckpoint();
+	StopProgress();
+	searching_ = false;
 }
 
 //==============================================================================
@@ -95,15 +197,32 @@ bool ParallelDFS::Probe(TreeSearchData* treesearch_data) {
 
 	log_->d_.probe_num_++;
 
+	bool received = false;
 	while (CallIprobe(&probe_status, &probe_src, &probe_tag)) {
+		received = true;
 		DBG(
 				D(4) << "CallIprobe returned src=" << probe_src
 						<< "\ttag=" << probe_tag << std::endl
 				; );
 		ProbeExecute(treesearch_data, &probe_status, probe_src,
 				probe_tag);
+		if (recv_msg_ != NULL) { // not received by ProbeExecute
+			progress_->Done(recv_msg_);
+			recv_msg_ = NULL;
+		}
+		// leave the rest to the next phase. with the progress thread,
+		// messages of the next phase may already be in the queue
+		if (mpi_data.dtd_->terminated_)
+			break;
 	}
 
+	if (coll_dtd_ != NULL && searching_ && !mpi_data.dtd_->terminated_)
+		ProgressCollective();
+
+	log_->telemetry_.Test();
+	if (log_->telemetry_.Due())
+		StartTelemetry(treesearch_data);
+
 	// capacity, lambda, phase
 	assert(treesearch_data->node_stack_);
 
@@ -113,9 +232,129 @@ bool ParallelDFS::Probe(TreeSearchData* treesearch_data) {
 	ProcAfterProbe();
 
 	long long int elapsed_time = timer_->Elapsed() - start_time;
+	log_->trace_.Complete(Tracer::PROBE, log_->trace_.Now() - elapsed_time);
 	log_->d_.probe_time_ += elapsed_time;
 	log_->d_.probe_time_max_ = std::max(elapsed_time,
 			log_->d_.probe_time_max_);
+
+	UpdateGranularity(elapsed_time);
+	return received;
+}
+
+/**
+ * Live progress (--telemetry_file)
+ */
+void ParallelDFS::StartTelemetry(TreeSearchData* treesearch_data) {
+	long long int * values = log_->telemetry_.Prepare();
+	VariableLengthItemsetStack * st = treesearch_data->node_stack_;
+	values[Telemetry::NODES] = log_->d_.process_node_num_;
+	values[Telemetry::STACK] = st->NuItemset();
+	values[Telemetry::IDLE] = HasJobToDo() ? 0 : 1;
+	values[Telemetry::STEALS] = log_->d_.steal_num_
+			+ log_->d_.lifeline_steal_num_;
+	values[Telemetry::REJECTS] = log_->d_.steal_reject_num_;
+	double remaining = 0.0;
+	for (int * p = st->FirstItemset(); p != NULL; p = st->NextItemset(p))
+		remaining += EstimateSubtree(p);
+	values[Telemetry::REMAINING] = (long long int) remaining;
+	TelemetryFill(values);
+	log_->telemetry_.Start();
+}
+
+//==============================================================================
+/**
+ * Collective termination detection (--dtd_engine=1)
+ */
+void ParallelDFS::ProgressCollective() {
+	if (!coll_dtd_->Active()) {
+		// no round is left open across a checkpoint
+		if (checkpoint_pending_ == Checkpoint::NONE && !checkpointing_)
+			StartCollective();
+		return;
+	}
+	bool done;
+	{
+		ScopedTime t(&log_->d_.dtd_coll_test_time_, NULL);
+		done = coll_dtd_->Test();
+	}
+	log_->d_.dtd_coll_test_num_++;
+	if (!done)
+		return;
+
+	long long int round_time = timer_->Elapsed() - coll_start_;
+	log_->trace_.Complete(Tracer::DTD_ROUND, log_->trace_.Now() - round_time);
+	log_->d_.dtd_coll_round_num_++;
+	log_->d_.dtd_coll_round_time_ += round_time;
+	log_->d_.dtd_coll_round_time_max_ = std::max(round_time,
+			log_->d_.dtd_coll_round_time_max_);
+
+	const long long int * result = coll_dtd_->Result();
+	DBG(
+			D(3) << "CollectiveDTD: count=" << result[CollectiveDTD::COUNT]
+					<< "\ttw=" << result[CollectiveDTD::TIME_WARP]
+					<< "\tem=" << result[CollectiveDTD::NOT_EMPTY]
+					<< std::endl
+			; );
+	CollectiveDone(result + CollectiveDTD::PAYLOAD);
+
+	if (coll_dtd_->Terminated()) {
+		mpi_data.dtd_->terminated_ = true;
+		mpi_data.waiting_ = false;
+		DBG(D(1) << "terminated" << std::endl
+		; );
+	} else if (result[CollectiveDTD::CHECKPOINT] != 0)
+		checkpoint_pending_ = (int) result[CollectiveDTD::CHECKPOINT];
+}
+
+void ParallelDFS::StartCollective() {
+	long long int * message = coll_dtd_->Prepare(CollectiveSize());
+	message[CollectiveDTD::COUNT] = mpi_data.dtd_->count_;
+	message[CollectiveDTD::TIME_WARP] = (mpi_data.dtd_->time_warp_ ? 1 : 0);
+	mpi_data.dtd_->not_empty_ = HasJobToDo();
+	message[CollectiveDTD::NOT_EMPTY] = (mpi_data.dtd_->not_empty_ ? 1 : 0);
+	message[CollectiveDTD::CHECKPOINT] = checkpoint_request_;
+	checkpoint_request_ = Checkpoint::NONE;
+	CollectiveFill(message + CollectiveDTD::PAYLOAD);
+
+	// same as SendDTDReply: this rank is in the next time zone
+	mpi_data.dtd_->time_warp_ = false;
+	mpi_data.dtd_->not_empty_ = false;
+	mpi_data.dtd_->IncTimeZone();
+
+	coll_start_ = timer_->Elapsed();
+	coll_dtd_->Start();
+}
+
+bool ParallelDFS::CheckProcessNodeEnd(int processed,
+		long long int start_time) {
+	if (processed > 0 && UrgentMessage()) // serve the thief now
+		return true;
+	long long int elapsed_time = 0ll;
+	if (granularity_ctl_.TimeBased())
+		elapsed_time = timer_->Elapsed() - start_time;
+	return granularity_ctl_.ProcessNodeEnd(processed, elapsed_time);
+}
+
+void ParallelDFS::UpdateGranularity(long long int probe_cost) {
+	if (!granularity_ctl_.Adaptive())
+		return;
+	int pending = mpi_data.thieves_->Size()
+			+ mpi_data.lifeline_thieves_->Size();
+	granularity_ctl_.Update(probe_cost, pending,
+			treesearch_data->node_stack_->NuItemset(),
+			log_->d_.idle_time_);
+
+	long long int g = granularity_ctl_.Interval();
+	log_->d_.granularity_update_num_++;
+	log_->d_.granularity_sum_ += g;
+	log_->d_.granularity_min_ = std::min(g, log_->d_.granularity_min_);
+	log_->d_.granularity_max_ = std::max(g, log_->d_.granularity_max_);
+	DBG(
+			D(4) << "UpdateGranularity: probe_cost=" << probe_cost
+					<< "\tpending=" << pending << "\tinterval=" << g
+					<< "\tnu_update=" << granularity_ctl_.NuUpdate()
+					<< std::endl
+			; );
 }
 
 void ParallelDFS::Distribute(TreeSearchData* treesearch_data) {
@@ -123,10 +362,13 @@ void ParallelDFS::Distribute(TreeSearchData* treesearch_data) {
 		return;
 	DBG(D(3) << "Distribute" << std::endl
 	; );
+	if (rma_pool_ != NULL) {
+		DistributeRMA(treesearch_data);
+		return;
+	}
 	if (mpi_data.thieves_->Size() > 0
 			|| mpi_data.lifeline_thieves_->Size() > 0) {
-		int steal_num = treesearch_data->node_stack_->Split(
-				treesearch_data->give_stack_);
+		int steal_num = SplitNodeStack(treesearch_data);
 		if (steal_num > 0) {
 			DBG(D(3) << "giving" << std::endl
 			; );
@@ -138,11 +380,111 @@ void ParallelDFS::Distribute(TreeSearchData* treesearch_data) {
 	}
 }
 
+int ParallelDFS::SplitNodeStack(TreeSearchData* treesearch_data,
+		int max_size) {
+	VariableLengthItemsetStack * st = treesearch_data->node_stack_;
+	int n = st->NuItemset();
+	if (n < 2 || (FLAGS_split_policy == SPLIT_ALTERNATE && max_size < 0))
+		return st->Split(treesearch_data->give_stack_);
+
+	std::vector<bool> give(n, false);
+	switch (FLAGS_split_policy) {
+	case SPLIT_ALTERNATE: // as Split
+		for (int i = 1; i < n; i += 2)
+			give[i] = true;
+		break;
+	case SPLIT_SHALLOW: {
+		// (depth, position): stable, bottom of the stack first
+		std::vector<std::pair<int, int> > depth(n);
+		int i = 0;
+		for (int * p = st->FirstItemset(); p != NULL;
+				p = st->NextItemset(p)) {
+			depth[i] = std::make_pair(st->GetItemNum(p), i);
+			i++;
+		}
+		std::sort(depth.begin(), depth.end());
+		for (int j = 0; j < n / 2; j++)
+			give[depth[j].second] = true;
+	}
+		break;
+	case SPLIT_ESTIMATE: {
+		// greedy partition: larger subtrees first, to the lighter side
+		std::vector<std::pair<double, int> > est(n);
+		int i = 0;
+		for (int * p = st->FirstItemset(); p != NULL;
+				p = st->NextItemset(p)) {
+			est[i] = std::make_pair(-EstimateSubtree(p), i);
+			i++;
+		}
+		std::sort(est.begin(), est.end());
+		double keep_sum = 0.0, give_sum = 0.0;
+		for (int j = 0; j < n; j++) {
+			if (give_sum < keep_sum) {
+				give[est[j].second] = true;
+				give_sum -= est[j].first;
+			} else
+				keep_sum -= est[j].first;
+		}
+	}
+		break;
+	case SPLIT_INTERLEAVE: {
+		int i = 0;
+		for (int * p = st->FirstItemset(); p != NULL;
+				p = st->NextItemset(p)) {
+			int num = st->GetItemNum(p);
+			int last = (num > 0) ? st->GetNthItem(p, num - 1) : i;
+			give[i++] = (last % 2 == 1);
+		}
+	}
+		break;
+	default:
+		assert(0);
+		break;
+	}
+
+	int give_num = std::count(give.begin(), give.end(), true);
+	if (give_num == 0 || give_num == n) { // degenerated, fall back
+		if (max_size < 0)
+			return st->Split(treesearch_data->give_stack_);
+		for (int i = 0; i < n; i++)
+			give[i] = (i % 2 == 1);
+	}
+
+	if (max_size >= 0) {
+		// keep the selection from the bottom as long as it fits
+		int size = VariableLengthItemsetStack::SENTINEL + 1;
+		int i = 0;
+		for (int * p = st->FirstItemset(); p != NULL;
+				p = st->NextItemset(p)) {
+			if (give[i]) {
+				size += VariableLengthItemsetStack::ITM + st->GetItemNum(p);
+				if (size > max_size)
+					give[i] = false;
+			}
+			i++;
+		}
+		if (std::count(give.begin(), give.end(), true) == 0)
+			return 0;
+	}
+	return st->SplitSelect(treesearch_data->give_stack_, give);
+}
+
+/**
+ * Default estimate: shallower itemsets have larger subtrees.
+ */
+double ParallelDFS::EstimateSubtree(const int * itemset) const {
+	return 1.0
+			/ (1.0 + VariableLengthItemsetStack::GetItemNum(itemset));
+}
+
 // TODO ParallelDFS
 void ParallelDFS::Give(VariableLengthItemsetStack * st,
 		int steal_num) {
 	DBG(D(3) << "Give: "
 	; );
+	log_->d_.give_nodes_hist_[Log::GiveHistBin(steal_num)]++;
+	log_->d_.give_nodes_max_ = std::max(log_->d_.give_nodes_max_,
+			(long long int) steal_num);
 	if (mpi_data.thieves_->Size() > 0) { // random thieves
 		int thief = mpi_data.thieves_->Pop();
 		if (thief >= 0) { // lifeline thief
@@ -199,6 +541,10 @@ void ParallelDFS::Steal() {
 	; );
 	if (mpi_data.nTotalProc_ == 1)
 		return;
+	if (rma_pool_ != NULL) {
+		StealRMA();
+		return;
+	}
 	if (!treesearch_data->stealer_->StealStarted())
 		return;
 	if (treesearch_data->stealer_->Requesting())
@@ -210,7 +556,8 @@ void ParallelDFS::Steal() {
 
 	switch (treesearch_data->stealer_->State()) {
 	case StealState::RANDOM: {
-		int victim = mpi_data.victims_[mpi_data.rand_m_()];
+		int victim = mpi_data.RandomVictim(
+				treesearch_data->stealer_->RandomCount());
 		assert(victim <= mpi_data.nTotalProc_ && "stealrandom");
 		SendRequest(victim, -1);
 		treesearch_data->stealer_->SetRequesting();
@@ -271,6 +618,118 @@ void ParallelDFS::Steal() {
 	}
 }
 
+void ParallelDFS::DistributeRMA(TreeSearchData* treesearch_data) {
+	if (treesearch_data->node_stack_->NuItemset() < 2)
+		return;
+	if (rma_pool_->OwnState() != RMAWorkPool::EMPTY)
+		return;
+	if (rma_pool_->TakeHungry() == 0)
+		return;
+
+	// only as much as the pool holds
+	int steal_num = SplitNodeStack(treesearch_data, rma_pool_->Capacity());
+	if (steal_num == 0)
+		return;
+	VariableLengthItemsetStack * st = treesearch_data->give_stack_;
+	st->SetTimestamp(mpi_data.dtd_->time_zone_);
+	st->SetFlag(-1);
+	if (rma_pool_->Deposit(st->Stack(), st->UsedCapacity())) {
+		// the pool counts as a message in flight until claimed
+		mpi_data.dtd_->OnSend();
+		log_->d_.rma_deposit_num_++;
+		log_->d_.given_num_++;
+		log_->d_.nodes_given_ += steal_num;
+		log_->d_.give_nodes_hist_[Log::GiveHistBin(steal_num)]++;
+		log_->d_.give_nodes_max_ = std::max(log_->d_.give_nodes_max_,
+				(long long int) steal_num);
+		DBG(
+				D(2) << "DistributeRMA: " << "\ttimezone="
+						<< mpi_data.dtd_->time_zone_ << "\tsize="
+						<< st->UsedCapacity() << "\tnode=" << steal_num
+						<< "\tdtd_count=" << mpi_data.dtd_->count_
+						<< std::endl
+				; );
+	} else { // not expected after the trimmed split, keep them
+		if (!treesearch_data->node_stack_->MergeStack(
+				st->Stack() + VariableLengthItemsetStack::SENTINEL + 1,
+				st->UsedCapacity() - VariableLengthItemsetStack::SENTINEL
+						- 1)) {
+			printf("rank %d: node stack is too small to keep the split\n",
+					mpi_data.mpiRank_);
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		log_->d_.rma_deposit_fail_num_++;
+	}
+	st->Clear();
+}
+
+void ParallelDFS::StealRMA() {
+	if (!treesearch_data->node_stack_->Empty())
+		return;
+	// a one sided steal never waits for an answer. keep the steal phase
+	// closed so that HasJobToDo does not block the termination
+	if (treesearch_data->stealer_->StealStarted())
+		treesearch_data->stealer_->Finish();
+
+	// take back own deposit first
+	if (ClaimRMA(mpi_data.mpiRank_)) {
+		log_->d_.rma_reclaim_num_++;
+		return;
+	}
+
+	int victim = mpi_data.RandomVictim(
+			treesearch_data->stealer_->RandomCount());
+	treesearch_data->stealer_->IncRandomCount();
+	if (ClaimRMA(victim))
+		log_->d_.steal_num_++;
+	else
+		log_->d_.rma_steal_fail_num_++;
+}
+
+bool ParallelDFS::ClaimRMA(int target) {
+	VariableLengthItemsetStack * st = treesearch_data->give_stack_;
+	int count;
+	{
+		ScopedTime t(&log_->d_.rma_claim_time_, NULL);
+		st->Reserve(rma_pool_->Capacity()); // room for any deposit
+		count = rma_pool_->Claim(target, st->Stack(), rma_pool_->Capacity());
+	}
+	log_->d_.rma_claim_num_++;
+	if (count == 0)
+		return false;
+
+	mpi_data.dtd_->OnRecv();
+	mpi_data.dtd_->UpdateTimeZone(st->Timestamp());
+
+	int orig_nu_itemset = treesearch_data->node_stack_->NuItemset();
+	treesearch_data->node_stack_->MergeStack(
+			st->Stack() + VariableLengthItemsetStack::SENTINEL + 1,
+			count - VariableLengthItemsetStack::SENTINEL - 1);
+	int new_nu_itemset = treesearch_data->node_stack_->NuItemset();
+	if (target != mpi_data.mpiRank_) {
+		if (orig_nu_itemset == 0 && new_nu_itemset > 0)
+			log_->busy_start_ = timer_->Elapsed();
+		log_->d_.nodes_received_ += (new_nu_itemset - orig_nu_itemset);
+	}
+
+	DBG(
+			D(2) << "ClaimRMA: target=" << target << "\ttimezone="
+					<< mpi_data.dtd_->time_zone_ << "\tsize=" << count
+					<< "\tnode=" << (new_nu_itemset - orig_nu_itemset)
+					<< "\tdtd_count=" << mpi_data.dtd_->count_
+					<< std::endl
+			; );
+
+	st->Clear();
+	log_->d_.node_stack_max_itm_ =
+			std::max(log_->d_.node_stack_max_itm_,
+					(long long int) (treesearch_data->node_stack_->NuItemset()));
+	log_->d_.node_stack_max_cap_ =
+			std::max(log_->d_.node_stack_max_cap_,
+					(long long int) (treesearch_data->node_stack_->UsedCapacity()));
+	return true;
+}
+
 //==============================================================================
 /**
  * This function should be called if all the subclass ProbeExecute failed.
@@ -293,6 +752,9 @@ void ParallelDFS::ProbeExecute(TreeSearchData* treesearch_data,
 	case Tag::BCAST_FINISH:
 		RecvBcastFinish(probe_src);
 		break;
+	case Tag::CHECKPOINT:
+		RecvCheckpoint(probe_src);
+		break;
 
 // basic tasks
 	case Tag::REQUEST:
@@ -335,6 +797,7 @@ void ParallelDFS::SendDTDRequest() {
 	message[0] = 1; // dummy
 
 	mpi_data.echo_waiting_ = true;
+	log_->trace_.Instant(Tracer::DTD_REQUEST);
 
 	for (int i = 0; i < k_echo_tree_branch; i++) {
 		if (mpi_data.bcast_targets_[i] < 0)
@@ -430,6 +893,7 @@ void ParallelDFS::RecvDTDReply(TreeSearchData* treesearch_data,
 	int message[3];
 	CallRecv(&message, 3, MPI_INT, src, Tag::DTD_REPLY, &recv_status);
 	assert(src == recv_status.MPI_SOURCE);
+	log_->trace_.Instant(Tracer::DTD_REPLY, src);
 
 // reduce reply (count, time_warp, not_empty)
 	mpi_data.dtd_->Reduce(message[0], (message[1] != 0),
@@ -522,6 +986,139 @@ void ParallelDFS::RecvBcastFinish(int src) {
 	mpi_data.waiting_ = false;
 }
 
+//==============================================================================
+void ParallelDFS::CheckCheckpoint() {
+	if (checkpoint_pending_ != Checkpoint::NONE) {
+		DoCheckpoint();
+		return;
+	}
+	if (!checkpoint_enabled_ || mpi_data.mpiRank_ != 0
+			|| checkpoint_request_ != Checkpoint::NONE)
+		return;
+
+	int request = Checkpoint::TakeSignal();
+	if (request == Checkpoint::NONE && FLAGS_checkpoint_interval > 0
+			&& MPI_Wtime() - checkpoint_last_ >= FLAGS_checkpoint_interval)
+		request = Checkpoint::CONTINUE;
+	if (request == Checkpoint::NONE)
+		return;
+
+	DBG(D(1) << "checkpoint requested: " << request << std::endl
+	; );
+	if (coll_dtd_) // decided by the next round
+		checkpoint_request_ = request;
+	else {
+		SendCheckpoint(request);
+		checkpoint_pending_ = request;
+	}
+}
+
+void ParallelDFS::SendCheckpoint(int request) {
+	int message[1];
+	message[0] = request;
+
+	for (int i = 0; i < k_echo_tree_branch; i++) {
+		if (mpi_data.bcast_targets_[i] < 0)
+			break;
+		assert(
+				mpi_data.bcast_targets_[i] < mpi_data.nTotalProc_
+						&& "SendCheckpoint");
+		CallBsend(message, 1, MPI_INT, mpi_data.bcast_targets_[i],
+				Tag::CHECKPOINT);
+	}
+}
+
+void ParallelDFS::RecvCheckpoint(int src) {
+	MPI_Status recv_status;
+	int message[1];
+	CallRecv(&message, 1, MPI_INT, src, Tag::CHECKPOINT, &recv_status);
+	DBG(D(1) << "RecvCheckpoint: src=" << src << "\trequest=" << message[0]
+	<< std::endl
+	; );
+
+	SendCheckpoint(message[0]);
+	checkpoint_pending_ = message[0];
+}
+
+void ParallelDFS::DoCheckpoint() {
+	int request = checkpoint_pending_;
+	long long int start_time = timer_->Elapsed();
+	checkpointing_ = true;
+	DBG(D(1) << "checkpoint start" << std::endl
+	; );
+
+	// take back own deposit and refuse all thieves
+	if (rma_pool_ != NULL && ClaimRMA(mpi_data.mpiRank_))
+		log_->d_.rma_reclaim_num_++;
+	Reject();
+
+	// quiescent: no basic message in flight, nobody waiting for an answer
+	// and no echo wave open. rounds are in lock step, so a message counted
+	// as received was always counted as sent in the same round
+	long long int local[2], global[2];
+	while (true) {
+		Probe(treesearch_data);
+		Reject();
+		local[0] = mpi_data.dtd_->count_;
+		local[1] = (treesearch_data->stealer_->Requesting()
+				|| mpi_data.thieves_->Size() > 0 || mpi_data.echo_waiting_) ?
+				1 : 0;
+		MPI_Allreduce(local, global, 2, MPI_LONG_LONG_INT, MPI_SUM,
+				MPI_COMM_WORLD);
+		log_->d_.checkpoint_round_num_++;
+		if (global[0] == 0ll && global[1] == 0ll)
+			break;
+	}
+
+	Checkpoint ckpt;
+	ckpt.nu_proc_ = mpi_data.nTotalProc_;
+	SaveCheckpoint(&ckpt);
+	VariableLengthItemsetStack * st = treesearch_data->node_stack_;
+	st->CopyItemsets(&ckpt.node_);
+
+	// all files are complete before any of them is replaced
+	std::string file_name = Checkpoint::FileName(FLAGS_checkpoint_prefix,
+			mpi_data.mpiRank_);
+	std::string tmp_name = file_name + ".tmp";
+	if (!ckpt.Write(tmp_name, mpi_data.mpiRank_)) {
+		printf("failed to write checkpoint %s\n", tmp_name.c_str());
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+	std::rename(tmp_name.c_str(), file_name.c_str());
+
+	long long int elapsed_time = timer_->Elapsed() - start_time;
+	log_->d_.checkpoint_num_++;
+	log_->d_.checkpoint_time_ += elapsed_time;
+	log_->d_.checkpoint_bytes_ += ckpt.Bytes();
+	if (mpi_data.mpiRank_ == 0)
+		printf("# checkpoint written: phase=%d lambda=%d prefix=%s\n",
+				ckpt.phase_, ckpt.lambda_, FLAGS_checkpoint_prefix.c_str());
+	DBG(
+			D(1) << "checkpoint written: node=" << st->NuItemset()
+					<< "\tbytes=" << ckpt.Bytes() << "\ttime="
+					<< elapsed_time << std::endl
+			; );
+
+	Checkpoint::TakeSignal(); // the signal was delivered to all ranks
+	checkpoint_last_ = MPI_Wtime();
+	checkpoint_pending_ = Checkpoint::NONE;
+	checkpointing_ = false;
+
+	if (request == Checkpoint::STOP) {
+		MPI_Barrier(MPI_COMM_WORLD);
+		StopProgress();
+		if (rma_pool_) {
+			delete rma_pool_;
+			rma_pool_ = NULL;
+		}
+		if (mpi_data.mpiRank_ == 0)
+			printf("# stopped after checkpoint. rerun with --restart\n");
+		MPI_Finalize();
+		std::exit(0);
+	}
+}
+
 // lifeline == -1 for random thieves
 void ParallelDFS::SendRequest(int dst, int is_lifeline) {
 	assert(dst >= 0);
@@ -532,6 +1129,7 @@ void ParallelDFS::SendRequest(int dst, int is_lifeline) {
 
 	CallBsend(message, 2, MPI_INT, dst, Tag::REQUEST);
 	mpi_data.dtd_->OnSend();
+	log_->trace_.Instant(Tracer::STEAL, dst, is_lifeline);
 
 	DBG(
 			D(2) << "SendRequest: dst=" << dst << "\tis_lifeline="
@@ -604,6 +1202,8 @@ void ParallelDFS::RecvReject(int src) {
 	CallRecv(&message, 1, MPI_INT, src, Tag::REJECT, &recv_status);
 	mpi_data.dtd_->OnRecv();
 	assert(src == recv_status.MPI_SOURCE);
+	log_->trace_.Instant(Tracer::REJECT, src);
+	log_->d_.steal_reject_num_++;
 
 	int timezone = message[0];
 	mpi_data.dtd_->UpdateTimeZone(timezone);
@@ -634,6 +1234,7 @@ void ParallelDFS::SendGive(VariableLengthItemsetStack * st, int dst,
 	assert(dst < mpi_data.nTotalProc_ && "SendGive");
 	CallBsend(message, size, MPI_INT, dst, Tag::GIVE);
 	mpi_data.dtd_->OnSend();
+	log_->trace_.Instant(Tracer::GIVE, dst, st->NuItemset());
 
 	DBG(
 			D(2) << "SendGive: " << "\ttimezone="
@@ -663,6 +1264,7 @@ void ParallelDFS::RecvGive(TreeSearchData* treesearch_data, int src,
 
 	MPI_Status recv_status;
 
+	treesearch_data->give_stack_->Reserve(count);
 	CallRecv(treesearch_data->give_stack_->Stack(), count, MPI_INT,
 			src, Tag::GIVE, &recv_status);
 	mpi_data.dtd_->OnRecv();
@@ -679,6 +1281,10 @@ void ParallelDFS::RecvGive(TreeSearchData* treesearch_data, int src,
 					+ VariableLengthItemsetStack::SENTINEL + 1,
 			count - VariableLengthItemsetStack::SENTINEL - 1);
 	int new_nu_itemset = treesearch_data->node_stack_->NuItemset();
+	if (orig_nu_itemset == 0 && new_nu_itemset > 0)
+		log_->busy_start_ = timer_->Elapsed();
+	log_->trace_.Instant(Tracer::RECV_GIVE, src,
+			new_nu_itemset - orig_nu_itemset);
 
 	if (flag >= 0) {
 		mpi_data.lifelines_activated_[src] = false;
@@ -736,8 +1342,32 @@ int ParallelDFS::CallIprobe(MPI_Status * status, int * src,
 	long long int end_time;
 	log_->d_.iprobe_num_++;
 
-	// todo: prepare non-log mode to remove measurement
-	// clock_gettime takes 0.3--0.5 micro sec
+	if (progress_ != NULL) {
+		assert(recv_msg_ == NULL);
+		recv_msg_ = progress_->Poll();
+		if (recv_msg_ == NULL) {
+			log_->d_.iprobe_fail_num_++;
+			return 0;
+		}
+		log_->d_.iprobe_succ_num_++;
+		*status = recv_msg_->status_;
+		*tag = recv_msg_->tag_;
+		*src = recv_msg_->src_;
+
+		// time from the progress thread receiving it to here
+		long long int wait = ProgressThread::Now() - recv_msg_->recv_time_;
+		log_->d_.progress_msg_num_++;
+		log_->d_.progress_wait_time_ += wait;
+		log_->d_.progress_wait_time_max_ = std::max(wait,
+				log_->d_.progress_wait_time_max_);
+		if (*tag == Tag::REQUEST)
+			log_->d_.progress_request_wait_time_max_ = std::max(wait,
+					log_->d_.progress_request_wait_time_max_);
+		return 1;
+	}
+
+	// FastClock takes a few nano sec (tens without the TSC). not read with
+	// OPTLOG
 	LOG(start_time = timer_->Elapsed() ;);
 
 	int flag;
@@ -780,54 +1410,48 @@ int ParallelDFS::CallIprobe(MPI_Status * status, int * src,
 
 int ParallelDFS::CallRecv(void * buffer, int data_count,
 		MPI_Datatype type, int src, int tag, MPI_Status * status) {
-	long long int start_time;
-	long long int end_time;
-
-	// todo: prepare non-log mode to remove measurement
-	// clock_gettime takes 0.3--0.5 micro sec
 	log_->d_.recv_num_++;
-	LOG(start_time = timer_->Elapsed() ;);
-
-	int error = MPI_Recv(buffer, data_count, type, src, tag,
-	MPI_COMM_WORLD, status);
-
-	LOG(
-			end_time = timer_->Elapsed(); log_->d_.recv_time_ += end_time - start_time; log_->d_.recv_time_max_ = std::max(end_time - start_time, log_->d_.recv_time_max_););
+	ScopedTime t(&log_->d_.recv_time_, &log_->d_.recv_time_max_);
+
+	int error;
+	if (progress_ != NULL) {
+		// already received by the progress thread
+		assert(recv_msg_ != NULL);
+		assert(recv_msg_->src_ == src && recv_msg_->tag_ == tag);
+		int type_size;
+		MPI_Type_size(type, &type_size);
+		std::size_t size = std::min(recv_msg_->data_.size(),
+				(std::size_t) data_count * type_size);
+		if (size > 0)
+			memcpy(buffer, &(recv_msg_->data_[0]), size);
+		*status = recv_msg_->status_;
+		progress_->Done(recv_msg_);
+		recv_msg_ = NULL;
+		error = MPI_SUCCESS;
+	} else
+		error = MPI_Recv(buffer, data_count, type, src, tag,
+		MPI_COMM_WORLD, status);
 	return error;
 }
 
 int ParallelDFS::CallBsend(void * buffer, int data_count,
 		MPI_Datatype type, int dest, int tag) {
 //	assert(0 <= dest && dest < mpi_data.nTotalProc_);
-	long long int start_time;
-	long long int end_time;
 	log_->d_.bsend_num_++;
-	start_time = timer_->Elapsed();
+	ScopedTime t(&log_->d_.bsend_time_, &log_->d_.bsend_time_max_);
 
 	int error = MPI_Bsend(buffer, data_count, type, dest, tag,
 	MPI_COMM_WORLD);
-
-	end_time = timer_->Elapsed();
-	log_->d_.bsend_time_ += end_time - start_time;
-	log_->d_.bsend_time_max_ = std::max(end_time - start_time,
-			log_->d_.bsend_time_max_);
 	return error;
 }
 
 int ParallelDFS::CallBcast(void * buffer, int data_count,
 		MPI_Datatype type) {
-	long long int start_time;
-	long long int end_time;
 	log_->d_.bcast_num_++;
-	start_time = timer_->Elapsed();
+	ScopedTime t(&log_->d_.bcast_time_, &log_->d_.bcast_time_max_);
 
 	int error = MPI_Bcast(buffer, data_count, type, 0,
 	MPI_COMM_WORLD);
-
-	end_time = timer_->Elapsed();
-	log_->d_.bcast_time_ += end_time - start_time;
-	log_->d_.bcast_time_max_ = std::max(end_time - start_time,
-			log_->d_.bcast_time_max_);
 	return error;
 }
 
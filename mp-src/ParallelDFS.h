@@ -10,6 +10,11 @@
 
 #include "../src/variable_length_itemset.h"
 #include "MPI_Data.h"
+#include "CollectiveDTD.h"
+#include "Checkpoint.h"
+#include "GranularityController.h"
+#include "ProgressThread.h"
+#include "RMAWorkPool.h"
 #include "mpi_tag.h"
 
 namespace lamp_search {
@@ -34,9 +39,38 @@ protected:
 	virtual void Distribute(TreeSearchData* treesearch_data);
 	virtual void Give(VariableLengthItemsetStack * st,
 			int steal_num) ;
+
+	/**
+	 * Work splitting policies (--split_policy)
+	 */
+	enum SplitPolicy {
+		SPLIT_ALTERNATE = 0, // every other itemset (VariableLengthItemsetStack::Split)
+		SPLIT_SHALLOW, // half of the itemsets, shallowest first
+		SPLIT_ESTIMATE, // balance the estimated subtree size
+		SPLIT_INTERLEAVE, // stripe by the last item, cf. NextItemInReverseLoop
+	};
+	// move itemsets for a thief from node_stack_ to give_stack_
+	// max_size: limit of give_stack_->UsedCapacity(), -1 for no limit
+	// return given itemset num
+	int SplitNodeStack(TreeSearchData* treesearch_data, int max_size = -1);
+	// relative size of the subtree under the itemset. used by SPLIT_ESTIMATE
+	virtual double EstimateSubtree(const int * itemset) const;
 	virtual void Reject();
 	virtual void Steal();
 
+	/**
+	 * Work stealing backends (--steal_backend)
+	 */
+	enum StealBackend {
+		STEAL_MESSAGE = 0, // REQUEST -> GIVE / REJECT
+		STEAL_RMA, // one sided, RMAWorkPool
+	};
+	// deposit a part of node_stack_ to rma_pool_ if a thief is waiting
+	void DistributeRMA(TreeSearchData* treesearch_data);
+	void StealRMA();
+	// take the slot of target into node_stack_. return true if taken
+	bool ClaimRMA(int target);
+
 	virtual void ProcAfterProbe() = 0;
 	virtual void Check() = 0;
 	virtual bool ExpandNode(TreeSearchData*treesearch_data) = 0;
@@ -59,6 +93,58 @@ protected:
 			int src);
 	virtual bool HasJobToDo();
 
+	/**
+	 * Collective termination detection (--dtd_engine=1). NULL if not used.
+	 * Created by the subclass that provides the payload, progressed from
+	 * Probe while in Search.
+	 */
+	enum DTDEngine {
+		DTD_ECHO = 0, // DTD_REQUEST / DTD_REPLY over bcast_targets_
+		DTD_COLLECTIVE, // CollectiveDTD
+	};
+	CollectiveDTD * coll_dtd_;
+	bool searching_;
+	long long int coll_start_; // start time of the current round
+	void ProgressCollective();
+	void StartCollective();
+	// number of payload elements of a round
+	virtual int CollectiveSize() {
+		return 0;
+	}
+	// local contribution
+	virtual void CollectiveFill(long long int * /*payload*/) {
+	}
+	// reduced payload of all ranks, before checking termination
+	virtual void CollectiveDone(const long long int * /*payload*/) {
+	}
+
+	// --telemetry_file: a round of log_->telemetry_ from Probe
+	void StartTelemetry(TreeSearchData* treesearch_data);
+	// domain specific fields of Telemetry (phase, lambda, closed sets)
+	virtual void TelemetryFill(long long int * /*values*/) {
+	}
+
+	/**
+	 * Checkpoint (--checkpoint_interval, SIGUSR1 / SIGUSR2).
+	 * Rank 0 decides and sends CHECKPOINT down bcast_targets_ (or sets it in
+	 * the next collective round). Each rank pauses at the next safe point in
+	 * Search, drains messages until nothing is in flight, and writes its
+	 * node_stack_ and the domain state of SaveCheckpoint.
+	 */
+	bool checkpoint_enabled_; // set by the subclass implementing SaveCheckpoint
+	int checkpoint_pending_; // Checkpoint::Request to do at the next safe point
+	int checkpoint_request_; // rank 0, for the next collective round
+	bool checkpointing_; // paused. no new DTD waves, steals or gives
+	double checkpoint_last_; // MPI_Wtime of the last checkpoint
+	// rank 0: start a checkpoint if requested. all: do a pending one
+	void CheckCheckpoint();
+	void SendCheckpoint(int request);
+	void RecvCheckpoint(int src);
+	void DoCheckpoint();
+	// fill all but node_ (collective)
+	virtual void SaveCheckpoint(Checkpoint * /*ckpt*/) {
+	}
+
 	void SendBcastFinish();
 	void RecvBcastFinish(int src);
 
@@ -100,6 +186,32 @@ protected:
 	TreeSearchData* treesearch_data;
 	static const int k_echo_tree_branch;
 
+	/**
+	 * Task granularity (--n, --n_is_ms, --adaptive_n)
+	 */
+	GranularityController granularity_ctl_;
+	void UpdateGranularity(long long int probe_cost);
+	// true if the expansion loop should return to Probe
+	bool CheckProcessNodeEnd(int processed, long long int start_time);
+
+	/**
+	 * Progress thread (--progress_thread). NULL if not used.
+	 * CallIprobe / CallRecv read from it instead of MPI.
+	 */
+	ProgressThread * progress_;
+	ProgressThread::Message * recv_msg_; // returned by CallIprobe
+	void StartProgress();
+	void StopProgress();
+	// a steal request is waiting. checked in the expansion loop
+	bool UrgentMessage() const {
+		return progress_ != NULL && progress_->Urgent();
+	}
+
+	/**
+	 * One sided stealing (--steal_backend=1). NULL if not used.
+	 */
+	RMAWorkPool * rma_pool_;
+
 	/**
 	 * Utility
 	 */
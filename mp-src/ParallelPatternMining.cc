@@ -7,6 +7,9 @@
 
 #include "ParallelPatternMining.h"
 
+#include <map>
+#include <queue>
+
 #include "gflags/gflags.h"
 
 #include "mpi_tag.h"
@@ -22,6 +25,24 @@ DEFINE_int32(probe_period_, 128, "probe period during process node");
 DEFINE_bool(probe_period_is_ms_, false,
 		"true: probe period is milli sec, false: num loops");
 DECLARE_bool (third_phase_); // true, "do third phase"
+DEFINE_bool(fused, false,
+		"single pass: phase 1 keeps the closed sets with (sup, pos_sup) and "
+		"phase 2 filters them instead of enumerating again");
+DEFINE_int32(fused_max, 1024 * 1024 * 64,
+		"ints for the closed sets kept by --fused per process. "
+		"two passes are used when exceeded");
+DEFINE_bool(sparse_accum, true,
+		"send only changed closed set counts in DTD accumulation replies");
+DEFINE_int32(search_order, 0,
+		"order of expanding children in phase 1. 0: item order, "
+		"1: higher support first (raises lambda earlier)");
+DEFINE_int32(lambda_probe, 0,
+		"closed sets expanded per process by a best-first pre-pass that "
+		"gives a safe starting lambda (0: off)");
+DEFINE_int32(lambda_probe_size, 1024 * 1024 * 16,
+		"ints for the closed sets kept by --lambda_probe per process");
+DECLARE_int32(dtd_engine); // 0: echo, 1: nonblocking collectives
+DECLARE_string(phase1_save); // "", mp_dfs.cc
 
 #ifdef __CDT_PARSER__
 #undef DBG
@@ -44,8 +65,11 @@ ParallelPatternMining::ParallelPatternMining(
 				bpm_data->sup_buf_), child_sup_buf_(
 				bpm_data->child_sup_buf_), expand_num_(0), closed_set_num_(
 				0), phase_(0), getminsup_data(
-		NULL), gettestable_data(NULL) {
+		NULL), gettestable_data(NULL), fused_(false) {
 	g_ = new LampGraph<uint64>(*d_); // No overhead to generate LampGraph.
+	if (FLAGS_dtd_engine == DTD_COLLECTIVE)
+		coll_dtd_ = new CollectiveDTD(MPI_COMM_WORLD);
+	checkpoint_enabled_ = true;
 }
 
 ParallelPatternMining::~ParallelPatternMining() {
@@ -59,6 +83,10 @@ void ParallelPatternMining::PreProcessRootNode(
 		GetMinSupData* getminsup_data) {
 	this->getminsup_data = getminsup_data;
 	phase_ = 1;
+	cs_hist_.Init(getminsup_data->lambda_max_);
+	fused_ = FLAGS_fused || !FLAGS_phase1_save.empty();
+	if (fused_)
+		cand_.Init(FLAGS_fused_max);
 	long long int start_time;
 	start_time = timer_->Elapsed();
 
@@ -105,7 +133,7 @@ void ParallelPatternMining::PreProcessRootNode(
 		int sup_num = bsh_->AndCountUpdate(d_->NthData(new_item),
 				child_sup_buf_);
 
-		if (sup_num < getminsup_data->lambda_)
+		if (sup_num < PruneThr())
 			continue;
 
 		treesearch_data->node_stack_->PushPre();
@@ -122,20 +150,30 @@ void ParallelPatternMining::PreProcessRootNode(
 		treesearch_data->node_stack_->Pop(); // always pop
 
 		if (res) {
+			assert(sup_num >= PruneThr());
 			IncCsAccum(sup_num); // increment closed_set_num_array
-			assert(sup_num >= getminsup_data->lambda_);
+			if (fused_)
+				StoreCandidate(sup_num, ppc_ext_buf);
 			if (ExceedCsThr())
-				getminsup_data->lambda_ = NextLambdaThr();
+				SetLambda(NextLambdaThr());
 		}
 	}
 //	 TODO: lambda_max_ is wrong???
 	printf("lambda_max_ = %d\n", getminsup_data->lambda_max_);
-	MPI_Reduce(getminsup_data->accum_array_,
-			getminsup_data->accum_recv_,
-			getminsup_data->lambda_max_ + 1, MPI_LONG_LONG_INT,
-			MPI_SUM, 0, MPI_COMM_WORLD); // error?
+	FlushCsAccum();
+	// with coll_dtd_ every rank keeps the reduced counts
+	if (coll_dtd_)
+		MPI_Allreduce(getminsup_data->accum_array_,
+				getminsup_data->accum_recv_,
+				getminsup_data->lambda_max_ + 1, MPI_LONG_LONG_INT,
+				MPI_SUM, MPI_COMM_WORLD);
+	else
+		MPI_Reduce(getminsup_data->accum_array_,
+				getminsup_data->accum_recv_,
+				getminsup_data->lambda_max_ + 1, MPI_LONG_LONG_INT,
+				MPI_SUM, 0, MPI_COMM_WORLD); // error?
 
-	if (mpi_data.mpiRank_ == 0) {
+	if (mpi_data.mpiRank_ == 0 || coll_dtd_) {
 		for (int l = 0; l <= getminsup_data->lambda_max_; l++) {
 			getminsup_data->accum_array_[l] =
 					getminsup_data->accum_recv_[l]; // overwrite here
@@ -150,23 +188,25 @@ void ParallelPatternMining::PreProcessRootNode(
 
 	if (mpi_data.mpiRank_ == 0)
 		if (ExceedCsThr())
-			getminsup_data->lambda_ = NextLambdaThr();
+			SetLambda(NextLambdaThr());
 	CallBcast(&getminsup_data->lambda_, 1, MPI_INT);
 
-	// reverse order
-	for (int new_item = d_->NextItemInReverseLoop(is_root_node,
-			mpi_data.mpiRank_, mpi_data.nTotalProc_, d_->NuItems());
-			new_item >= core_i + 1;
-			new_item = d_->NextItemInReverseLoop(is_root_node,
-					mpi_data.mpiRank_, mpi_data.nTotalProc_,
-					new_item)) {
+	if (FLAGS_lambda_probe > 0)
+		ProbeLambda();
+
+	// reverse order, or by support with --search_order
+	std::vector<int> children = GetChildren(core_i);
+	OrderChildren(children);
+	for (std::vector<int>::iterator it = children.begin();
+			it != children.end(); ++it) {
+		int new_item = *it;
 		// skipping not needed because itemset_buf_ if root itemset
 
 		bsh_->Copy(sup_buf_, child_sup_buf_);
 		int sup_num = bsh_->AndCountUpdate(d_->NthData(new_item),
 				child_sup_buf_);
 
-		if (sup_num < getminsup_data->lambda_)
+		if (sup_num < PruneThr())
 			continue;
 
 		treesearch_data->node_stack_->PushPre();
@@ -187,8 +227,8 @@ void ParallelPatternMining::PreProcessRootNode(
 			treesearch_data->node_stack_->SortTop();
 			// note: IncCsAccum already done above
 
-			assert(sup_num >= getminsup_data->lambda_);
-			if (sup_num <= getminsup_data->lambda_)
+			assert(sup_num >= PruneThr());
+			if (sup_num <= PruneThr())
 				treesearch_data->node_stack_->Pop();
 		}
 	}
@@ -203,12 +243,111 @@ void ParallelPatternMining::PreProcessRootNode(
 			;);
 }
 
+void ParallelPatternMining::ProbeLambda() {
+	long long int start_time = timer_->Elapsed();
+	int lambda_max = getminsup_data->lambda_max_;
+	VariableLengthItemsetStack probe(FLAGS_lambda_probe_size);
+	// (sup, offset in probe) of the closed sets not expanded yet
+	std::priority_queue<std::pair<int, int> > frontier;
+	std::vector<long long int> count(lambda_max + 1, 0ll); // by support
+
+	probe.PushPre();
+	int * root = probe.Top();
+	probe.SetSup(root, lambda_max);
+	probe.PushPostNoSort();
+	frontier.push(std::make_pair(lambda_max, (int) (root - probe.Stack())));
+
+	// a child of a closed set has smaller or equal support, so the closed
+	// sets are found in the order of support. every rank takes its share
+	// of the root children like PreProcessRootNode, and PPC extension finds
+	// each closed set once: the counts of all ranks are of distinct sets
+	long long int expanded = 0ll;
+	bool full = false;
+	while (!frontier.empty() && expanded < FLAGS_lambda_probe && !full) {
+		int * itemset = probe.Stack() + frontier.top().second;
+		frontier.pop();
+		expanded++;
+
+		int n = probe.GetItemNum(itemset);
+		bool is_root_node = (n == 0);
+		bsh_->Set(sup_buf_);
+		for (int i = 0; i < n; i++)
+			bsh_->And(d_->NthData(probe.GetNthItem(itemset, i)), sup_buf_);
+		int core_i = g_->CoreIndex(probe, itemset);
+
+		for (int new_item = d_->NextItemInReverseLoop(is_root_node,
+				mpi_data.mpiRank_, mpi_data.nTotalProc_, d_->NuItems());
+				new_item >= core_i + 1;
+				new_item = d_->NextItemInReverseLoop(is_root_node,
+						mpi_data.mpiRank_, mpi_data.nTotalProc_,
+						new_item)) {
+			if (probe.Exist(itemset, new_item))
+				continue;
+			bsh_->Copy(sup_buf_, child_sup_buf_);
+			int sup_num = bsh_->AndCountUpdate(d_->NthData(new_item),
+					child_sup_buf_);
+			if (sup_num < getminsup_data->lambda_)
+				continue;
+			if (probe.UsedCapacity() + VariableLengthItemsetStack::ITM
+					+ d_->NuItems() + 1 > probe.TotalCapacity()) {
+				full = true; // the counts so far are still a lower bound
+				break;
+			}
+
+			probe.PushPre();
+			int * ext = probe.Top();
+			bool res = g_->PPCExtension(&probe, itemset, child_sup_buf_,
+					core_i, new_item, ext);
+			probe.SetSup(ext, sup_num);
+			probe.PushPostNoSort();
+			if (!res) {
+				probe.Pop();
+				continue;
+			}
+			probe.SortTop();
+			count[sup_num]++;
+			frontier.push(std::make_pair(sup_num, (int) (ext - probe.Stack())));
+		}
+	}
+	bsh_->Set(sup_buf_); // root support for the caller
+
+	std::vector<long long int> accum(lambda_max + 1, 0ll), total(
+			lambda_max + 1, 0ll);
+	long long int sum = 0ll;
+	for (int l = lambda_max; l >= 0; l--) {
+		sum += count[l];
+		accum[l] = sum;
+	}
+	MPI_Allreduce(&(accum[0]), &(total[0]), lambda_max + 1,
+			MPI_LONG_LONG_INT, MPI_SUM, MPI_COMM_WORLD);
+	// as NextLambdaThr, on the counts of a subset of the closed sets
+	int si;
+	for (si = lambda_max; si >= getminsup_data->lambda_; si--)
+		if (total[si] > getminsup_data->cs_thr_[si])
+			break;
+	if (si + 1 > getminsup_data->lambda_)
+		SetLambda(si + 1);
+
+	log_->d_.lambda_probe_ = si + 1;
+	log_->d_.lambda_probe_num_ = expanded;
+	log_->d_.lambda_probe_time_ = timer_->Elapsed() - start_time;
+	DBG(
+			D(2) << "ProbeLambda: expanded=" << expanded << "\tfull=" << full
+					<< "\tlambda=" << getminsup_data->lambda_ << std::endl
+			;);
+}
+
 void ParallelPatternMining::GetMinimalSupport(
 		GetMinSupData* getminsup_data) {
 	this->getminsup_data = getminsup_data;
 //	CheckInit();
 	phase_ = 1; // TODO: remove dependency on this
+	if (cs_hist_.Size() != getminsup_data->lambda_max_ + 1)
+		cs_hist_.Init(getminsup_data->lambda_max_);
 	Search();
+	FlushCsAccum(); // accum_array_ is read after the search
+	if (FLAGS_fused || !FLAGS_phase1_save.empty())
+		FinishFused();
 
 	// return lambda?
 }
@@ -226,6 +365,24 @@ void ParallelPatternMining::GetTestablePatterns(
 
 }
 
+void ParallelPatternMining::FilterTestablePatterns(
+		GetTestableData* gettestable_data) {
+	this->gettestable_data = gettestable_data;
+	this->getminsup_data->lambda_ = gettestable_data->freqThreshold_;
+	phase_ = 2;
+	long long int start_time = timer_->Elapsed();
+	// same closed sets as the enumeration from the root in GetTestablePatterns
+	for (const int * set = cand_.First(); set != NULL; set = cand_.Next(set)) {
+		int sup_num = VariableLengthItemsetStack::GetSup(set);
+		if (sup_num < gettestable_data->freqThreshold_)
+			continue;
+		closed_set_num_++;
+		RecordTestable(sup_num, CandidateStore::PosSup(set), set);
+	}
+	cand_.Clear();
+	log_->d_.fused_filter_time_ += timer_->Elapsed() - start_time;
+}
+
 void ParallelPatternMining::GetSignificantPatterns(
 		GetSignificantData* getsignificant_data) {
 	this->getsignificant_data = getsignificant_data;
@@ -238,9 +395,11 @@ void ParallelPatternMining::GetSignificantPatterns(
 		SendResultRequest();
 	}
 	printf("probe\n");
+	StartProgress();
 	while (!mpi_data.dtd_->terminated_) {
 		Probe(treesearch_data);
 	}
+	StopProgress();
 }
 
 //==============================================================================
@@ -251,14 +410,16 @@ void ParallelPatternMining::ProcAfterProbe() {
 	if (phase_ == 1) {
 		log_->TakePeriodicLog(
 				treesearch_data->node_stack_->NuItemset(),
-				getminsup_data->lambda_, phase_);
+				getminsup_data->lambda_, phase_,
+				granularity_ctl_.Granularity());
 	} else {
 		log_->TakePeriodicLog(
 				treesearch_data->node_stack_->NuItemset(),
-				gettestable_data->freqThreshold_, phase_);
+				gettestable_data->freqThreshold_, phase_,
+				granularity_ctl_.Granularity());
 	}
 
-	if (mpi_data.mpiRank_ == 0) {
+	if (mpi_data.mpiRank_ == 0 && !coll_dtd_ && !checkpointing_) {
 		// initiate termination detection
 
 		// note: for phase_ 1, accum request and dtd request are unified
@@ -332,7 +493,7 @@ void ParallelPatternMining::ProbeExecute(
  * GetMinSup specific
  */
 void ParallelPatternMining::Check() {
-	if (mpi_data.mpiRank_ == 0 && phase_ == 1) {
+	if (mpi_data.mpiRank_ == 0 && phase_ == 1 && !coll_dtd_) {
 		CheckCSThreshold();
 	}
 	return;
@@ -366,6 +527,7 @@ bool ParallelPatternMining::ExpandNode(
 		int core_i = g_->CoreIndex(*treesearch_data->node_stack_,
 				treesearch_data->itemset_buf_);
 		std::vector<int> children = GetChildren(core_i);
+		OrderChildren(children);
 		for (std::vector<int>::iterator it = children.begin();
 				it != children.end(); ++it) {
 			int new_item = *it;
@@ -393,21 +555,20 @@ bool ParallelPatternMining::ExpandNode(
 				;
 			});
 
-			ProcessNode(sup_num, ppc_ext_buf);
+			assert(sup_num >= PruneThr());
 
-			assert(sup_num >= getminsup_data->lambda_);
+			ProcessNode(sup_num, ppc_ext_buf);
 
 			// try skipping if supnum_ == sup_threshold,
 			// because if sup_num of a node equals to sup_threshold, children will have smaller sup_num
 			// therefore no need to check it's children
 			// note: skipping node_stack_ full check. allocate enough memory!
-			if (sup_num == getminsup_data->lambda_) {
+			if (sup_num <= PruneThr()) { // < if the fused store gave up
 				treesearch_data->node_stack_->Pop();
 			}
 		}
 
-		if (CheckProcessNodeEnd(mpi_data.granularity_,
-				mpi_data.isGranularitySec_, processed, start_time))
+		if (CheckProcessNodeEnd(processed, start_time))
 			break;
 	}
 
@@ -444,6 +605,26 @@ std::vector<int> ParallelPatternMining::GetChildren(int core_i) {
 	return children;
 }
 
+void ParallelPatternMining::OrderChildren(std::vector<int>& children) {
+	if (phase_ != 1 || FLAGS_search_order != ORDER_SUPPORT)
+		return;
+	// node_stack_ is LIFO: ascending support, ties in the original order.
+	// children below the threshold are dropped here, TestAndPushNode
+	// would count them again only to prune them
+	std::vector<std::pair<int, int> > order;
+	order.reserve(children.size());
+	for (std::size_t i = 0; i < children.size(); i++) {
+		int sup_num = bsh_->AndCount(d_->NthData(children[i]), sup_buf_);
+		if (sup_num >= PruneThr())
+			order.push_back(std::make_pair(sup_num, (int) i));
+	}
+	std::sort(order.begin(), order.end());
+	std::vector<int> sorted(order.size());
+	for (std::size_t i = 0; i < order.size(); i++)
+		sorted[i] = children[order[i].second];
+	children.swap(sorted);
+}
+
 /**
  * itemset_buf_ := pointer to the index of itemset
  * sup_buf_     := support* of the itemset (takes AND for each item)
@@ -501,7 +682,7 @@ bool ParallelPatternMining::TestAndPushNode(int new_item,
 			child_sup_buf_);
 	// If the support is smaller than the required minimal support for
 	// significant pattern (=lambda), then prune it.
-	if (sup_num < getminsup_data->lambda_) {
+	if (sup_num < PruneThr()) {
 		return false;
 	}
 	// TODO: Here it is inserting a new item into the node_stack_.
@@ -529,38 +710,53 @@ bool ParallelPatternMining::TestAndPushNode(int new_item,
 
 void ParallelPatternMining::ProcessNode(int sup_num,
 		int* ppc_ext_buf) {
-	if (phase_ == 1)
+	if (phase_ == 1) {
 		IncCsAccum(sup_num); // increment closed_set_num_array
+		if (fused_)
+			StoreCandidate(sup_num, ppc_ext_buf);
+	}
 	if (phase_ == 2) {
 		closed_set_num_++;
 		if (true) { // XXX: FLAGS_third_phase_
 			int pos_sup_num = bsh_->AndCount(d_->PosNeg(),
 					child_sup_buf_);
-			double pval = d_->PVal(sup_num, pos_sup_num);
-			assert(pval >= 0.0);
-			if (pval <= gettestable_data->sig_level_) { // permits == case?
-				gettestable_data->freq_stack_->PushPre();
-				int * item = gettestable_data->freq_stack_->Top();
-				gettestable_data->freq_stack_->CopyItem(ppc_ext_buf,
-						item);
-				gettestable_data->freq_stack_->PushPostNoSort();
-
-				gettestable_data->freq_map_->insert(
-						std::pair<double, int*>(pval, item));
-			}
+			RecordTestable(sup_num, pos_sup_num, ppc_ext_buf);
 		}
 	}
 }
 
+void ParallelPatternMining::RecordTestable(int sup_num, int pos_sup_num,
+		const int* itemset) {
+	double pval = d_->PVal(sup_num, pos_sup_num);
+	assert(pval >= 0.0);
+	if (pval <= gettestable_data->sig_level_) { // permits == case?
+		gettestable_data->freq_stack_->PushPre();
+		int * item = gettestable_data->freq_stack_->Top();
+		gettestable_data->freq_stack_->CopyItem(itemset, item);
+		gettestable_data->freq_stack_->PushPostNoSort();
+
+		gettestable_data->freq_map_->Push(pval, item);
+	}
+}
+
 void ParallelPatternMining::CheckProbe(int& accum_period_counter_,
 		long long int lap_time) {
 // TODO: whatever this is trying to do, it should be factored into a function.
 //       Why is it Probing while in the expansion loop?
 	accum_period_counter_++;
+	if (progress_ != NULL) {
+		// messages are already received. no need to look at the clock
+		if (UrgentMessage()) {
+			Probe(treesearch_data);
+			Distribute(treesearch_data);
+			Reject();
+		}
+		return;
+	}
 	if (FLAGS_probe_period_is_ms_) {      // using milli second
 		if (accum_period_counter_ >= 64) { // TODO: what is this magic number?
 			// to avoid calling timer_ frequently, time is checked once in 64 loops
-			// clock_gettime takes 0.3--0.5 micro sec
+			// FastClock takes a few nano sec (tens without the TSC)
 			accum_period_counter_ = 0;
 			long long int elt = timer_->Elapsed();
 			if (elt - lap_time >= FLAGS_probe_period_ * 1000000) {
@@ -589,20 +785,20 @@ void ParallelPatternMining::CheckProbe(int& accum_period_counter_,
 // note: do this before PushPre is called [2015-10-05 21:56]
 }
 
-bool ParallelPatternMining::CheckProcessNodeEnd(int n, bool n_is_ms,
-		int processed, long long int start_time) {
-	long long int elapsed_time;
-	if (n_is_ms) {
-		if (processed > 0) {
-			elapsed_time = timer_->Elapsed() - start_time;
-			if (elapsed_time >= n * 1000000) {  // ms to ns
-				return true;
-			}
-		}
-	} else if (processed >= n)
-		return true;
-
-	return false;
+/**
+ * Children of an itemset are extended by items larger than its last item
+ * and have support at least lambda.
+ * (support above lambda) * (remaining items) is used as the subtree size.
+ */
+double ParallelPatternMining::EstimateSubtree(const int * itemset) const {
+	int num = VariableLengthItemsetStack::GetItemNum(itemset);
+	int last = -1;
+	if (num > 0)
+		last = VariableLengthItemsetStack::GetItemArray(itemset)[num - 1];
+	int remaining = d_->NuItems() - 1 - last;
+	int sup = VariableLengthItemsetStack::GetSup(itemset);
+	return (double) (sup - getminsup_data->lambda_ + 1)
+			* (double) (remaining + 1);
 }
 
 // TODO: polymorphism to override SendDTDRequest
@@ -611,6 +807,7 @@ void ParallelPatternMining::SendDTDAccumRequest() {
 	message[0] = 1; // dummy
 
 	mpi_data.echo_waiting_ = true;
+	log_->trace_.Instant(Tracer::DTD_REQUEST);
 
 	for (int i = 0; i < k_echo_tree_branch; i++) {
 		if (mpi_data.bcast_targets_[i] < 0)
@@ -647,11 +844,31 @@ void ParallelPatternMining::RecvDTDAccumRequest(int src) {
 }
 
 void ParallelPatternMining::SendDTDAccumReply() {
-	getminsup_data->dtd_accum_array_base_[0] = mpi_data.dtd_->count_
-			+ mpi_data.dtd_->reduce_count_;
+	long long int * message = getminsup_data->dtd_accum_array_base_;
+	int size = getminsup_data->lambda_max_ + 4;
+
+	// sparse: 0: count, 1: time warp flag, 2: empty flag, 3: pair num,
+	//         4--: (index, delta) of cs_hist_
+	// shorter than the dense reply, so that the size tells which one it is
+	int nu_pair = -1;
+	if (FLAGS_sparse_accum) {
+		int max_pair = (getminsup_data->lambda_max_ - 1) / 2;
+		if ((int) accum_sparse_.size() < 4 + 2 * max_pair)
+			accum_sparse_.resize(4 + 2 * max_pair);
+		nu_pair = cs_hist_.TakeDiff(&(accum_sparse_[4]), max_pair);
+	}
+	if (nu_pair >= 0) {
+		message = &(accum_sparse_[0]);
+		message[3] = nu_pair;
+		size = 4 + 2 * nu_pair;
+		log_->d_.dtd_accum_sparse_num_++;
+	} else
+		FlushCsAccum(); // too many changes, dense
+
+	message[0] = mpi_data.dtd_->count_ + mpi_data.dtd_->reduce_count_;
 	bool tw_flag = mpi_data.dtd_->time_warp_
 			|| mpi_data.dtd_->reduce_time_warp_;
-	getminsup_data->dtd_accum_array_base_[1] = (tw_flag ? 1 : 0);
+	message[1] = (tw_flag ? 1 : 0);
 // for Steal
 	mpi_data.dtd_->not_empty_ =
 			!(treesearch_data->node_stack_->Empty())
@@ -664,22 +881,25 @@ void ParallelPatternMining::SendDTDAccumReply() {
 //     waiting_ || mpi_data.processing_node_;
 	bool em_flag = mpi_data.dtd_->not_empty_
 			|| mpi_data.dtd_->reduce_not_empty_;
-	getminsup_data->dtd_accum_array_base_[2] = (em_flag ? 1 : 0);
+	message[2] = (em_flag ? 1 : 0);
 
 	DBG(
 			D(3) << "SendDTDAccumReply: dst = "
 					<< mpi_data.bcast_source_ << "\tcount="
-					<< getminsup_data->dtd_accum_array_base_[0]
-					<< "\ttw=" << tw_flag << "\tem=" << em_flag
-					<< std::endl
+					<< message[0] << "\ttw=" << tw_flag << "\tem="
+					<< em_flag << "\tsize=" << size << std::endl
 			;);
 
 	assert(
 			mpi_data.bcast_source_ < mpi_data.nTotalProc_
 					&& "SendDTDAccumReply");
-	CallBsend(getminsup_data->dtd_accum_array_base_,
-			getminsup_data->lambda_max_ + 4, MPI_LONG_LONG_INT,
-			mpi_data.bcast_source_, Tag::DTD_ACCUM_REPLY);
+	CallBsend(message, size, MPI_LONG_LONG_INT, mpi_data.bcast_source_,
+			Tag::DTD_ACCUM_REPLY);
+	long long int bytes = size * (long long int) sizeof(long long int);
+	log_->d_.dtd_accum_reply_num_++;
+	log_->d_.dtd_accum_reply_bytes_ += bytes;
+	log_->d_.dtd_accum_reply_bytes_max_ = std::max(bytes,
+			log_->d_.dtd_accum_reply_bytes_max_);
 
 	mpi_data.dtd_->time_warp_ = false;
 	mpi_data.dtd_->not_empty_ = false;
@@ -689,8 +909,9 @@ void ParallelPatternMining::SendDTDAccumReply() {
 	mpi_data.dtd_->ClearAccumFlags();
 	mpi_data.dtd_->ClearReduceVars();
 
-	for (int l = 0; l <= getminsup_data->lambda_max_; l++)
-		getminsup_data->accum_array_[l] = 0ll;
+	if (nu_pair < 0)
+		for (int l = 0; l <= getminsup_data->lambda_max_; l++)
+			getminsup_data->accum_array_[l] = 0ll;
 }
 
 // getminsup_data
@@ -702,6 +923,9 @@ void ParallelPatternMining::RecvDTDAccumReply(int src) {
 			MPI_LONG_LONG_INT, src, Tag::DTD_ACCUM_REPLY,
 			&recv_status);
 	assert(src == recv_status.MPI_SOURCE);
+	log_->trace_.Instant(Tracer::DTD_REPLY, src);
+	int size;
+	MPI_Get_count(&recv_status, MPI_LONG_LONG_INT, &size);
 
 	int count = (int) (getminsup_data->dtd_accum_recv_base_[0]);
 	bool time_warp = (getminsup_data->dtd_accum_recv_base_[1] != 0);
@@ -719,10 +943,14 @@ void ParallelPatternMining::RecvDTDAccumReply(int src) {
 					<< mpi_data.dtd_->reduce_not_empty_ << std::endl
 			;);
 
-	for (int l = getminsup_data->lambda_ - 1;
-			l <= getminsup_data->lambda_max_; l++)
-		getminsup_data->accum_array_[l] +=
-				getminsup_data->accum_recv_[l];
+	// counts for l >= lambda_ - 1, added to accum_array_ at the next flush
+	if (size < getminsup_data->lambda_max_ + 4) // sparse
+		cs_hist_.AddDiff(getminsup_data->dtd_accum_recv_base_ + 4,
+				(int) getminsup_data->dtd_accum_recv_base_[3],
+				getminsup_data->lambda_ - 1);
+	else
+		cs_hist_.AddAccum(getminsup_data->accum_recv_,
+				getminsup_data->lambda_ - 1);
 
 	bool flag = false;
 	for (int i = 0; i < k_echo_tree_branch; i++) {
@@ -738,7 +966,7 @@ void ParallelPatternMining::RecvDTDAccumReply(int src) {
 		if (ExceedCsThr()) {
 			int new_lambda = NextLambdaThr();
 			SendLambda(new_lambda);
-			getminsup_data->lambda_ = new_lambda;
+			SetLambda(new_lambda);
 		}
 // if SendLambda is called, dtd_.count_ is incremented and DTDCheck will always fail
 		if (DTDReplyReady()) {
@@ -751,6 +979,102 @@ void ParallelPatternMining::RecvDTDAccumReply(int src) {
 	}
 }
 
+int ParallelPatternMining::CollectiveSize() {
+	return (phase_ == 1) ? getminsup_data->lambda_max_ + 1 : 0;
+}
+
+void ParallelPatternMining::CollectiveFill(long long int * payload) {
+	if (phase_ == 1)
+		cs_hist_.Flush(payload); // payload is zero cleared
+}
+
+void ParallelPatternMining::CollectiveDone(const long long int * payload) {
+	if (phase_ != 1) {
+		if (mpi_data.mpiRank_ == 0)
+			log_->d_.dtd_phase_num_++;
+		return;
+	}
+	for (int l = 0; l <= getminsup_data->lambda_max_; l++)
+		getminsup_data->accum_array_[l] += payload[l];
+	// same on all ranks
+	int new_lambda = NextLambdaThr();
+	if (new_lambda > getminsup_data->lambda_) {
+		DBG(
+				D(2) << "CollectiveDone: lambda=" << new_lambda
+						<< std::endl
+				;);
+		SetLambda(new_lambda);
+	}
+	if (mpi_data.mpiRank_ == 0)
+		log_->d_.dtd_accum_phase_num_++;
+}
+
+/**
+ * Telemetry
+ */
+void ParallelPatternMining::TelemetryFill(long long int * values) {
+	if (phase_ == 1) {
+		if (mpi_data.mpiRank_ != 0)
+			return;
+		// reduced counts. pending ones of cs_hist_ are not included
+		values[Telemetry::PHASE] = phase_;
+		values[Telemetry::LAMBDA] = getminsup_data->lambda_;
+		values[Telemetry::CLOSED_SETS] =
+				getminsup_data->accum_array_[getminsup_data->lambda_];
+	} else {
+		if (mpi_data.mpiRank_ == 0) {
+			values[Telemetry::PHASE] = phase_;
+			values[Telemetry::LAMBDA] = gettestable_data->freqThreshold_;
+		}
+		values[Telemetry::CLOSED_SETS] = closed_set_num_;
+	}
+}
+
+/**
+ * Checkpoint
+ */
+void ParallelPatternMining::SaveCheckpoint(Checkpoint * ckpt) {
+	ckpt->phase_ = phase_;
+	ckpt->closed_set_num_ = closed_set_num_;
+	if (phase_ == 1) {
+		int lambda_max = getminsup_data->lambda_max_;
+		ckpt->lambda_max_ = lambda_max;
+		MPI_Allreduce(&(getminsup_data->lambda_), &(ckpt->lambda_), 1,
+				MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+		// counts of this rank: pending in cs_hist_, and accum_array_ for the
+		// echo (the root holds the reduced part). left untouched
+		std::vector<long long int> local(lambda_max + 1, 0ll);
+		CsAccumHistogram pending = cs_hist_;
+		pending.Flush(&(local[0]));
+		if (!coll_dtd_)
+			for (int l = 0; l <= lambda_max; l++)
+				local[l] += getminsup_data->accum_array_[l];
+		ckpt->accum_.resize(lambda_max + 1);
+		MPI_Allreduce(&(local[0]), &(ckpt->accum_[0]), lambda_max + 1,
+				MPI_LONG_LONG_INT, MPI_SUM, MPI_COMM_WORLD);
+		if (coll_dtd_) // same on all ranks
+			for (int l = 0; l <= lambda_max; l++)
+				ckpt->accum_[l] += getminsup_data->accum_array_[l];
+	} else {
+		ckpt->lambda_ = gettestable_data->freqThreshold_;
+		ckpt->lambda_max_ = getminsup_data->lambda_max_;
+		ckpt->sig_level_ = gettestable_data->sig_level_;
+
+		gettestable_data->freq_stack_->CopyItemsets(&ckpt->freq_);
+		// freq_map_ is in the stack order until Partition in phase 3
+		TestableSet * freq = gettestable_data->freq_map_;
+		for (std::size_t i = 0; i < freq->Size(); i++)
+			ckpt->pval_.push_back(freq->Pval(i));
+	}
+}
+
+void ParallelPatternMining::RestoreCheckpoint(const Checkpoint& ckpt,
+		GetMinSupData* getminsup_data) {
+	this->getminsup_data = getminsup_data;
+	closed_set_num_ = ckpt.closed_set_num_;
+}
+
 /**
  * GetMinSup Functions
  *
@@ -800,7 +1124,7 @@ void ParallelPatternMining::RecvLambda(int src) {
 	int new_lambda = message[1];
 	if (new_lambda > getminsup_data->lambda_) {
 		SendLambda(new_lambda);
-		getminsup_data->lambda_ = new_lambda;
+		SetLambda(new_lambda);
 // todo: do database reduction
 	}
 }
@@ -810,16 +1134,97 @@ void ParallelPatternMining::CheckCSThreshold() {
 	if (ExceedCsThr()) {
 		int new_lambda = NextLambdaThr();
 		SendLambda(new_lambda);
-		getminsup_data->lambda_ = new_lambda;
+		SetLambda(new_lambda);
 	}
 }
 
+void ParallelPatternMining::SetLambda(int lambda) {
+	getminsup_data->lambda_ = lambda;
+	log_->trace_.Instant(Tracer::LAMBDA, 0, lambda);
+	log_->d_.lambda_update_num_++;
+	log_->d_.lambda_final_time_ = timer_->Elapsed()
+			- log_->d_.search_start_time_;
+}
+
 void ParallelPatternMining::IncCsAccum(int sup_num) {
-	for (int i = sup_num; i >= getminsup_data->lambda_ - 1; i--)
-		getminsup_data->accum_array_[i]++;
+	cs_hist_.Inc(sup_num, getminsup_data->lambda_);
+}
+
+void ParallelPatternMining::FlushCsAccum() {
+	if (cs_hist_.Dirty())
+		cs_hist_.Flush(getminsup_data->accum_array_);
+}
+
+// called with the support bits of itemset in child_sup_buf_
+void ParallelPatternMining::StoreCandidate(int sup_num,
+		const int * itemset) {
+	assert(VariableLengthItemsetStack::GetSup(itemset) == sup_num);
+	(void) sup_num; // the support is taken from itemset, checked above
+	int pos_sup_num = bsh_->AndCount(d_->PosNeg(), child_sup_buf_);
+	cand_.Push(itemset, pos_sup_num, PruneThr());
+	if (cand_.Overflow()) {
+		// no use keeping on: phase 2 enumerates again on all ranks
+		fused_ = false;
+		DBG(D(1) << "fused store overflow" << std::endl
+		;);
+	}
+}
+
+// all the ranks must have kept their closed sets, otherwise two passes
+bool ParallelPatternMining::CopyCandidates(int min_sup,
+		std::vector<int> * sets) const {
+	if (!fused_)
+		return false;
+	for (const int * set = cand_.First(); set != NULL; set = cand_.Next(set))
+		if (VariableLengthItemsetStack::GetSup(set) >= min_sup)
+			sets->insert(sets->end(), set,
+					set + VariableLengthItemsetStack::ITM
+							+ VariableLengthItemsetStack::GetItemNum(set));
+	return true;
+}
+
+void ParallelPatternMining::LoadCandidates(GetMinSupData* getminsup_data,
+		const std::vector<int>& sets) {
+	this->getminsup_data = getminsup_data;
+	fused_ = true;
+	// one more int per set for pos_sup
+	long long int nu_set = 0ll;
+	for (std::size_t i = 0; i < sets.size();
+			i += VariableLengthItemsetStack::ITM
+					+ VariableLengthItemsetStack::GetItemNum(&(sets[i])))
+		nu_set++;
+	cand_.Init(sets.size() + nu_set);
+	// pos_sup with the positives of this run
+	for (std::size_t i = 0; i < sets.size();
+			i += VariableLengthItemsetStack::ITM
+					+ VariableLengthItemsetStack::GetItemNum(&(sets[i]))) {
+		const int * set = &(sets[i]);
+		int n = VariableLengthItemsetStack::GetItemNum(set);
+		const int * item = VariableLengthItemsetStack::GetItemArray(set);
+		bsh_->Set(sup_buf_);
+		for (int k = 0; k < n; k++)
+			bsh_->And(d_->NthData(item[k]), sup_buf_);
+		assert(
+				(int) bsh_->Count(sup_buf_)
+						== VariableLengthItemsetStack::GetSup(set));
+		cand_.Push(set, bsh_->AndCount(d_->PosNeg(), sup_buf_), 0);
+	}
+	log_->d_.fused_store_peak_ = cand_.PeakSize() * (long long int) sizeof(int);
 }
 
-bool ParallelPatternMining::ExceedCsThr() const {
+void ParallelPatternMining::FinishFused() {
+	int local = fused_ ? 1 : 0, all = 0;
+	MPI_Allreduce(&local, &all, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	fused_ = (all == 1);
+	log_->d_.fused_store_peak_ = cand_.PeakSize() * (long long int) sizeof(int);
+	log_->d_.fused_compact_num_ = cand_.CompactNum();
+	log_->d_.fused_fallback_ = fused_ ? 0 : 1;
+	if (!fused_)
+		cand_.Clear();
+}
+
+bool ParallelPatternMining::ExceedCsThr() {
+	FlushCsAccum();
 // note: > is correct. permit ==
 	return (getminsup_data->accum_array_[getminsup_data->lambda_]
 			> getminsup_data->cs_thr_[getminsup_data->lambda_]);
@@ -881,14 +1286,15 @@ void ParallelPatternMining::RecvResultRequest(int src) {
 }
 
 void ParallelPatternMining::SendResultReply() {
-	int * message = getsignificant_data->significant_stack_->Stack();
-	int size =
-			getsignificant_data->significant_stack_->UsedCapacity();
+	// as a single segment stack: header, then the itemsets
+	std::vector<int> message(VariableLengthItemsetStack::SENTINEL + 1, 0);
+	message[VariableLengthItemsetStack::SENTINEL] = -1;
+	getsignificant_data->significant_stack_->CopyItemsets(&message);
 	assert(
 			mpi_data.bcast_source_ < mpi_data.nTotalProc_
 					&& "SendResultReply");
-	CallBsend(message, size, MPI_INT, mpi_data.bcast_source_,
-			Tag::RESULT_REPLY);
+	CallBsend(&(message[0]), message.size(), MPI_INT,
+			mpi_data.bcast_source_, Tag::RESULT_REPLY);
 
 	DBG(
 			D(2) << "SendResultReply: dst=" << mpi_data.bcast_source_
@@ -914,15 +1320,15 @@ void ParallelPatternMining::RecvResultReply(int src,
 	}
 
 	MPI_Status recv_status;
-	CallRecv(treesearch_data->give_stack_->Stack(), count, MPI_INT,
-			src, Tag::RESULT_REPLY, &recv_status);
+	// can be larger than a give
+	std::vector<int> message(count);
+	CallRecv(&(message[0]), count, MPI_INT, src, Tag::RESULT_REPLY,
+			&recv_status);
 	assert(src == recv_status.MPI_SOURCE);
 
 	getsignificant_data->significant_stack_->MergeStack(
-			treesearch_data->give_stack_->Stack()
-					+ VariableLengthItemsetStack::SENTINEL + 1,
+			&(message[0]) + VariableLengthItemsetStack::SENTINEL + 1,
 			count - VariableLengthItemsetStack::SENTINEL - 1);
-	treesearch_data->give_stack_->Clear();
 
 	DBG(D(2) << "RecvResultReply: src=" << src << std::endl
 	;);
@@ -951,19 +1357,14 @@ void ParallelPatternMining::RecvResultReply(int src,
 }
 
 void ParallelPatternMining::ExtractSignificantSet() {
-	std::multimap<double, int *>::iterator it;
-	for (it = getsignificant_data->freq_map_->begin();
-			it != getsignificant_data->freq_map_->end(); ++it) {
-// permits == case
-		if ((*it).first <= getsignificant_data->final_sig_level_) {
-			getsignificant_data->significant_stack_->PushPre();
-			int * item =
-					getsignificant_data->significant_stack_->Top();
-			getsignificant_data->significant_stack_->CopyItem(
-					(*it).second, item);
-			getsignificant_data->significant_stack_->PushPostNoSort();
-		} else
-			break;
+	TestableSet * freq = getsignificant_data->freq_map_;
+	std::size_t n = freq->Partition(getsignificant_data->final_sig_level_);
+	for (std::size_t i = 0; i < n; i++) {
+		getsignificant_data->significant_stack_->PushPre();
+		int * item = getsignificant_data->significant_stack_->Top();
+		getsignificant_data->significant_stack_->CopyItem(freq->Itemset(i),
+				item);
+		getsignificant_data->significant_stack_->PushPostNoSort();
 	}
 }
 
@@ -10,6 +10,8 @@
 #include "MPI_Data.h"
 
 #include "ParallelDFS.h"
+#include "CsAccumHistogram.h"
+#include "CandidateStore.h"
 
 namespace lamp_search {
 
@@ -32,8 +34,29 @@ public:
 	void GetMinimalSupport(GetMinSupData* getminsup_data);
 	void PreProcessRootNode(GetMinSupData* getminsup_data);
 	void GetTestablePatterns(GetTestableData* gettestable_data);
+	// --fused: true if every rank kept all closed sets of phase 1
+	bool Fused() const {
+		return fused_;
+	}
+	// --fused: phase 2 from the closed sets kept in phase 1
+	void FilterTestablePatterns(GetTestableData* gettestable_data);
+	// --phase1_save: closed sets kept in phase 1 with sup >= min_sup,
+	// appended to sets as in VariableLengthItemsetStack. false if they were
+	// not all kept
+	bool CopyCandidates(int min_sup, std::vector<int> * sets) const;
+	// --phase1_load: closed sets of an earlier run replace phase 1, and
+	// phase 2 filters them as with --fused
+	void LoadCandidates(GetMinSupData* getminsup_data,
+			const std::vector<int>& sets);
+	// closed sets with sup >= lambda found by this rank in phase 2
+	long long int ClosedSetNum() const {
+		return closed_set_num_;
+	}
 	void GetSignificantPatterns(
 			GetSignificantData* getsignificant_data);
+	// --restart: domain state of ckpt. node_stack_ is restored by the caller
+	void RestoreCheckpoint(const Checkpoint& ckpt,
+			GetMinSupData* getminsup_data);
 
 protected:
 	// TODO: How can we hide the dependency on those low level structures?
@@ -78,13 +101,30 @@ protected:
 	void Check(); // DOMAINDEPENDENT
 	bool ExpandNode(TreeSearchData*treesearch_data);
 	std::vector<int> GetChildren(int core_i); // DOMAINDEPENDENT
+	/**
+	 * Order of children in phase 1 (--search_order)
+	 */
+	enum SearchOrder {
+		ORDER_ITEM = 0, // reverse item order of GetChildren
+		ORDER_SUPPORT, // higher support first
+	};
+	// sort children of sup_buf_ so that the child with the highest support
+	// is pushed last, i.e. expanded first
+	void OrderChildren(std::vector<int>& children);
 	void PopNodeFromStack();
 	bool TestAndPushNode(int new_item, int core_i);
 	void ProcessNode(int sup_num, int* ppc_ext_buf);
+	// pval <= sig_level_: push to freq_stack_ and freq_map_
+	void RecordTestable(int sup_num, int pos_sup_num, const int* itemset);
+	// phase 1 with fused_ also visits closed sets of support lambda - 1,
+	// which are all the closed sets that phase 2 would enumerate
+	int PruneThr() const {
+		return (phase_ == 1 && fused_) ?
+				getminsup_data->lambda_ - 1 : getminsup_data->lambda_;
+	}
 	void CheckProbe(int& accum_period_counter_,
 			long long int lap_time);
-	bool CheckProcessNodeEnd(int n, bool n_is_ms, int processed,
-			long long int start_time);
+	double EstimateSubtree(const int * itemset) const;
 
 	//--------
 
@@ -103,10 +143,34 @@ protected:
 	void SendLambda(int lambda);
 	void RecvLambda(int src);
 	void CheckCSThreshold();
-	bool ExceedCsThr() const; // getMinSup
-	int NextLambdaThr() const; // getMinSup
+	// --lambda_probe: best-first enumeration of the closed sets with the
+	// highest support. lambda given by their counts is a lower bound of the
+	// final lambda, and is set before phase 1 starts
+	void ProbeLambda();
+	void SetLambda(int lambda); // phase 1, records the time in log_
+	bool ExceedCsThr(); // getMinSup
+	int NextLambdaThr() const; // getMinSup, call after ExceedCsThr
 //	int NextLambdaThr(GetMinSupData* getminsup_data) const; // getMinSup
 	void IncCsAccum(int sup_num); // getMinSup
+	// closed sets counted by IncCsAccum, not yet in accum_array_
+	CsAccumHistogram cs_hist_;
+	void FlushCsAccum();
+	// --fused: closed sets of phase 1 with sup >= PruneThr() at the time
+	bool fused_;
+	CandidateStore cand_;
+	void StoreCandidate(int sup_num, const int * itemset);
+	void FinishFused();
+	std::vector<long long int> accum_sparse_; // sparse DTD accum reply
+
+	// --dtd_engine=1: closed set counts go with every round and each rank
+	// updates lambda from the reduced accum_array_, no LAMBDA messages
+	int CollectiveSize();
+	void CollectiveFill(long long int * payload);
+	void CollectiveDone(const long long int * payload);
+	void TelemetryFill(long long int * values);
+
+	// phase, lambda, reduced accum_array_ (phase 1), freq_stack_ (phase 2)
+	void SaveCheckpoint(Checkpoint * ckpt);
 
 	// TODO: These functions should be factored in Get
 	/**
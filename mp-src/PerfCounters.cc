@@ -0,0 +1,102 @@
+/*
+ * PerfCounters.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "PerfCounters.h"
+
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lamp_search {
+
+PerfCounters::PerfCounters() :
+		leader_(-1), nu_open_(0) {
+	for (int k = 0; k < kNum; k++) {
+		fd_[k] = -1;
+		index_[k] = -1;
+	}
+}
+
+PerfCounters::~PerfCounters() {
+	Close();
+}
+
+bool PerfCounters::Open() {
+	Close();
+#ifdef __linux__
+	const unsigned long long int config[kNum] = { PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+	for (int k = 0; k < kNum; k++) {
+		struct perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[k];
+		attr.disabled = (leader_ < 0) ? 1 : 0; // the group starts together
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+				| PERF_FORMAT_TOTAL_TIME_RUNNING;
+		int fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, leader_,
+				0);
+		if (fd < 0) {
+			if (k == CYCLES)
+				return false; // no group without the leader
+			continue;
+		}
+		if (leader_ < 0)
+			leader_ = fd;
+		fd_[k] = fd;
+		index_[k] = nu_open_++;
+	}
+	ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void PerfCounters::Close() {
+#ifdef __linux__
+	for (int k = 0; k < kNum; k++)
+		if (fd_[k] >= 0)
+			close(fd_[k]);
+#endif
+	for (int k = 0; k < kNum; k++) {
+		fd_[k] = -1;
+		index_[k] = -1;
+	}
+	leader_ = -1;
+	nu_open_ = 0;
+}
+
+void PerfCounters::Read(long long int * values) const {
+	for (int k = 0; k < kNum; k++)
+		values[k] = 0ll;
+#ifdef __linux__
+	if (leader_ < 0)
+		return;
+	// nr, time_enabled, time_running, value[nr]
+	unsigned long long int buf[3 + kNum];
+	ssize_t size = read(leader_, buf, sizeof(buf));
+	if (size < (ssize_t) (3 * sizeof(unsigned long long int))
+			|| (int) buf[0] != nu_open_)
+		return;
+	double scale =
+			(buf[2] > 0 && buf[2] < buf[1]) ? (double) buf[1] / buf[2] : 1.0;
+	for (int k = 0; k < kNum; k++)
+		if (index_[k] >= 0)
+			values[k] = (long long int) (buf[3 + index_[k]] * scale);
+#endif
+}
+
+} /* namespace lamp_search */
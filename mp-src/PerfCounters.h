@@ -0,0 +1,54 @@
+/*
+ * PerfCounters.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_PERFCOUNTERS_H_
+#define MP_SRC_PERFCOUNTERS_H_
+
+namespace lamp_search {
+
+/**
+ * Hardware counters of this process with perf_event_open (--perf).
+ *
+ * Cycles, instructions and last level cache misses are opened as one group
+ * so that they are scheduled together, counting user space only. When the
+ * kernel multiplexes the group, the values are scaled by enabled / running
+ * time. Open fails when the counters are not available (no Linux, no PMU in
+ * a virtual machine, kernel.perf_event_paranoid); then Read gives zeros.
+ * Counters that the CPU lacks are left out of the group and read as 0.
+ */
+class PerfCounters {
+public:
+	enum {
+		CYCLES = 0, INSTRUCTIONS, LLC_MISSES, kNum
+	};
+	static const int kLineBytes = 64; // memory traffic per LLC miss
+
+	PerfCounters();
+	~PerfCounters();
+
+	// return false if not available
+	bool Open();
+	void Close();
+	bool Available() const {
+		return leader_ >= 0;
+	}
+
+	// totals since Open into values[kNum]
+	void Read(long long int * values) const;
+
+private:
+	int leader_; // fd of the group leader, -1 if not open
+	int fd_[kNum]; // -1 if not counted
+	int index_[kNum]; // in the group read, -1 if not counted
+	int nu_open_;
+
+	PerfCounters(const PerfCounters&);
+	PerfCounters& operator=(const PerfCounters&);
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_PERFCOUNTERS_H_ */
@@ -0,0 +1,129 @@
+/*
+ * ProgressThread.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ProgressThread.h"
+
+#include <sched.h>
+#include <cassert>
+
+#include "../src/timer.h"
+
+namespace lamp_search {
+
+ProgressThread::ProgressThread(int capacity, int urgent_tag) :
+		queue_(capacity), free_(capacity), urgent_tag_(urgent_tag), urgent_num_(
+				0), stop_(false), running_(false), received_num_(0ll) {
+}
+
+ProgressThread::~ProgressThread() {
+	Stop();
+	Message * msg;
+	while (queue_.Pop(&msg))
+		delete msg;
+	for (std::size_t i = 0; i < overflow_.size(); i++)
+		delete overflow_[i];
+	while (free_.Pop(&msg))
+		delete msg;
+}
+
+bool ProgressThread::Available() {
+	int provided;
+	MPI_Query_thread(&provided);
+	return provided >= MPI_THREAD_MULTIPLE;
+}
+
+long long int ProgressThread::Now() {
+	return FastClock::Now();
+}
+
+void ProgressThread::Start() {
+	if (running_)
+		return;
+	stop_.store(false);
+	int ret = pthread_create(&thread_, NULL, ProgressThread::Main, this);
+	if (ret != 0)
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	running_ = true;
+}
+
+void ProgressThread::Stop() {
+	if (!running_)
+		return;
+	stop_.store(true);
+	pthread_join(thread_, NULL);
+	running_ = false;
+}
+
+ProgressThread::Message * ProgressThread::Poll() {
+	Message * msg;
+	if (!queue_.Pop(&msg)) {
+		if (running_ || overflow_.empty())
+			return NULL;
+		msg = overflow_.front();
+		overflow_.pop_front();
+	}
+	if (msg->tag_ == urgent_tag_)
+		urgent_num_.fetch_sub(1, std::memory_order_relaxed);
+	return msg;
+}
+
+void ProgressThread::Done(Message * msg) {
+	if (!free_.Push(msg))
+		delete msg;
+}
+
+void * ProgressThread::Main(void * arg) {
+	static_cast<ProgressThread *>(arg)->Loop();
+	return NULL;
+}
+
+void ProgressThread::Loop() {
+	MPI_Status probe_status;
+	int flag;
+	int count;
+	while (!stop_.load(std::memory_order_relaxed)) {
+		// keep the order: overflow_ was received after everything in queue_
+		while (!overflow_.empty() && queue_.Push(overflow_.front()))
+			overflow_.pop_front();
+		if (!overflow_.empty()) {
+			sched_yield();
+			continue;
+		}
+
+		int error = MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD,
+				&flag, &probe_status);
+		if (error != MPI_SUCCESS)
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		if (!flag) {
+			sched_yield();
+			continue;
+		}
+
+		Message * msg;
+		if (!free_.Pop(&msg))
+			msg = new Message;
+		MPI_Get_count(&probe_status, MPI_BYTE, &count);
+		msg->data_.resize(count);
+		msg->src_ = probe_status.MPI_SOURCE;
+		msg->tag_ = probe_status.MPI_TAG;
+		MPI_Recv(count > 0 ? &(msg->data_[0]) : NULL, count, MPI_BYTE,
+				msg->src_, msg->tag_, MPI_COMM_WORLD, &(msg->status_));
+		msg->recv_time_ = Now();
+		received_num_++;
+
+		if (msg->tag_ == urgent_tag_)
+			urgent_num_.fetch_add(1, std::memory_order_relaxed);
+		while (!queue_.Push(msg)) { // full, wait for the search thread
+			if (stop_.load(std::memory_order_relaxed)) {
+				overflow_.push_back(msg);
+				break;
+			}
+			sched_yield();
+		}
+	}
+}
+
+} /* namespace lamp_search */
@@ -0,0 +1,87 @@
+/*
+ * ProgressThread.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_PROGRESSTHREAD_H_
+#define MP_SRC_PROGRESSTHREAD_H_
+
+#include <pthread.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "mpi.h"
+#include "SPSCQueue.h"
+
+namespace lamp_search {
+
+/**
+ * Receives every incoming message on a separate thread, so that the search
+ * thread does not have to call MPI_Iprobe. Received messages are handed to
+ * the search thread with a SPSC queue and read back through
+ * ParallelDFS::CallIprobe / CallRecv.
+ *
+ * Requires MPI_THREAD_MULTIPLE (the search thread keeps sending).
+ * Start / Stop around each search loop. Messages left in the queue are
+ * kept for the next loop.
+ */
+class ProgressThread {
+public:
+	struct Message {
+		MPI_Status status_;
+		int src_;
+		int tag_;
+		long long int recv_time_; // FastClock nano sec
+		std::vector<char> data_;
+	};
+
+	ProgressThread(int capacity, int urgent_tag);
+	~ProgressThread();
+
+	// true if MPI was initialized with MPI_THREAD_MULTIPLE
+	static bool Available();
+	static long long int Now();
+
+	void Start();
+	void Stop();
+	bool Running() const {
+		return running_;
+	}
+
+	/**
+	 * Search thread only.
+	 * return NULL if nothing received. Release the message with Done.
+	 */
+	Message * Poll();
+	void Done(Message * msg);
+
+	// true if an urgent message (steal request) is waiting
+	bool Urgent() const {
+		return urgent_num_.load(std::memory_order_relaxed) > 0;
+	}
+
+	long long int Received() const {
+		return received_num_;
+	}
+
+private:
+	static void * Main(void * arg);
+	void Loop();
+
+	SPSCQueue<Message *> queue_;
+	SPSCQueue<Message *> free_; // recycled messages, search -> progress
+	// received while stopping with a full queue_. touched only when the
+	// progress thread is not running (or by the progress thread itself)
+	std::deque<Message *> overflow_;
+	int urgent_tag_;
+	std::atomic<int> urgent_num_;
+	std::atomic<bool> stop_;
+	bool running_;
+	pthread_t thread_;
+	long long int received_num_; // progress thread only
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_PROGRESSTHREAD_H_ */
@@ -0,0 +1,105 @@
+/*
+ * RMAWorkPool.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RMAWorkPool.h"
+
+namespace lamp_search {
+
+RMAWorkPool::RMAWorkPool(MPI_Comm comm, int capacity) :
+		comm_(comm), capacity_(capacity), base_(NULL) {
+	MPI_Comm_rank(comm_, &rank_);
+	MPI_Aint bytes = (MPI_Aint) (DATA + capacity_) * sizeof(int);
+	int error = MPI_Win_allocate(bytes, sizeof(int), MPI_INFO_NULL, comm_,
+			&base_, &win_);
+	if (error != MPI_SUCCESS)
+		MPI_Abort(comm_, 1);
+	base_[STATE] = EMPTY;
+	base_[HUNGRY] = 0;
+	base_[SIZE] = 0;
+	MPI_Barrier(comm_); // headers are initialized before anyone touches them
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+}
+
+RMAWorkPool::~RMAWorkPool() {
+	MPI_Win_unlock_all(win_);
+	MPI_Win_free(&win_);
+}
+
+int RMAWorkPool::CompareAndSwap(int target, int compare, int value) {
+	int result;
+	MPI_Compare_and_swap(&value, &compare, &result, MPI_INT, target, STATE,
+			win_);
+	MPI_Win_flush(target, win_);
+	return result;
+}
+
+bool RMAWorkPool::Deposit(const int * data, int size) {
+	if (size > capacity_)
+		return false;
+	if (CompareAndSwap(rank_, EMPTY, BUSY) != EMPTY)
+		return false;
+
+	MPI_Put(&size, 1, MPI_INT, rank_, SIZE, 1, MPI_INT, win_);
+	MPI_Put(const_cast<int *>(data), size, MPI_INT, rank_, DATA, size,
+			MPI_INT, win_);
+	MPI_Win_flush(rank_, win_);
+
+	int full = FULL;
+	MPI_Accumulate(&full, 1, MPI_INT, rank_, STATE, 1, MPI_INT, MPI_REPLACE,
+			win_);
+	MPI_Win_flush(rank_, win_);
+	return true;
+}
+
+int RMAWorkPool::OwnState() {
+	int dummy = 0, result;
+	MPI_Fetch_and_op(&dummy, &result, MPI_INT, rank_, STATE, MPI_NO_OP,
+			win_);
+	MPI_Win_flush(rank_, win_);
+	return result;
+}
+
+int RMAWorkPool::TakeHungry() {
+	int zero = 0, result;
+	MPI_Fetch_and_op(&zero, &result, MPI_INT, rank_, HUNGRY, MPI_REPLACE,
+			win_);
+	MPI_Win_flush(rank_, win_);
+	return result;
+}
+
+int RMAWorkPool::Claim(int target, int * buf, int buf_size) {
+	if (CompareAndSwap(target, FULL, BUSY) != FULL) {
+		if (target != rank_) {
+			int one = 1;
+			MPI_Accumulate(&one, 1, MPI_INT, target, HUNGRY, 1, MPI_INT,
+					MPI_SUM, win_);
+			MPI_Win_flush(target, win_);
+		}
+		return 0;
+	}
+
+	int size;
+	MPI_Get(&size, 1, MPI_INT, target, SIZE, 1, MPI_INT, win_);
+	MPI_Win_flush(target, win_);
+	if (size < 0 || size > buf_size) {
+		// leave the slot full for a thief with room for it
+		int full = FULL;
+		MPI_Accumulate(&full, 1, MPI_INT, target, STATE, 1, MPI_INT,
+				MPI_REPLACE, win_);
+		MPI_Win_flush(target, win_);
+		return 0;
+	}
+	MPI_Get(buf, size, MPI_INT, target, DATA, size, MPI_INT, win_);
+	MPI_Win_flush(target, win_);
+
+	int empty = EMPTY;
+	MPI_Accumulate(&empty, 1, MPI_INT, target, STATE, 1, MPI_INT,
+			MPI_REPLACE, win_);
+	MPI_Win_flush(target, win_);
+	return size;
+}
+
+} /* namespace lamp_search */
@@ -0,0 +1,81 @@
+/*
+ * RMAWorkPool.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_RMAWORKPOOL_H_
+#define MP_SRC_RMAWORKPOOL_H_
+
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * One sided work stealing (--steal_backend=1).
+ *
+ * Every rank exposes one slot in an MPI-3 RMA window. The owner deposits
+ * the part of its node stack it would have given to a thief (same format
+ * as a GIVE message), and a thief takes the whole slot without the owner
+ * entering MPI_Iprobe:
+ *
+ *   owner : CAS(state, EMPTY -> BUSY), put data, state = FULL
+ *   thief : CAS(state, FULL -> BUSY), get data, state = EMPTY
+ *           on failure, increment the hungry counter of the target
+ *
+ * The owner deposits only when the hungry counter is non zero, and takes
+ * back its own slot with the same CAS when its stack runs out, like the
+ * owner end of a Chase-Lev deque.
+ * All accesses are in one passive target epoch (MPI_Win_lock_all) and the
+ * state / hungry words are only touched with atomic operations.
+ *
+ * Constructor and destructor are collective over comm.
+ */
+class RMAWorkPool {
+public:
+	enum State {
+		EMPTY = 0, FULL, BUSY,
+	};
+
+	// capacity: max number of ints in the slot
+	RMAWorkPool(MPI_Comm comm, int capacity);
+	~RMAWorkPool();
+
+	int Capacity() const {
+		return capacity_;
+	}
+
+	/**
+	 * Owner only.
+	 * return false if the slot is not empty or size exceeds the capacity
+	 */
+	bool Deposit(const int * data, int size);
+	// state of its own slot
+	int OwnState();
+	// number of failed steals since the last call. reset to 0
+	int TakeHungry();
+
+	/**
+	 * Take the slot of target (own rank is OK) into buf.
+	 * return the number of ints, 0 if the slot was not full or its
+	 * content does not fit in buf_size (the slot is left full).
+	 */
+	int Claim(int target, int * buf, int buf_size);
+
+private:
+	enum Header {
+		STATE = 0, HUNGRY, SIZE, DATA,
+	};
+
+	int CompareAndSwap(int target, int compare, int value);
+
+	MPI_Comm comm_;
+	int rank_;
+	int capacity_;
+	int * base_;
+	MPI_Win win_;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_RMAWORKPOOL_H_ */
@@ -0,0 +1,180 @@
+/*
+ * ResultFile.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ResultFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "../src/variable_length_itemset.h"
+#include "SharedFile.h"
+
+namespace lamp_search {
+
+ResultFile::ResultFile(MPI_Comm comm) :
+		comm_(comm), rank_(0), nu_proc_(1), exchange_size_(0ll), write_bytes_(
+				0ll) {
+	MPI_Comm_rank(comm_, &rank_);
+	MPI_Comm_size(comm_, &nu_proc_);
+}
+
+void ResultFile::Add(double pval, int pos_sup, const int * itemset) {
+	assert(sizeof(double) == kPos * sizeof(int));
+	long long int offset = data_.size();
+	data_.resize(offset + kSet + VariableLengthItemsetStack::ITM
+			+ VariableLengthItemsetStack::GetItemNum(itemset));
+	std::memcpy(&(data_[offset + kPval]), &pval, sizeof(double));
+	data_[offset + kPos] = pos_sup;
+	std::copy(itemset, itemset + (data_.size() - offset - kSet),
+			data_.begin() + offset + kSet);
+	offsets_.push_back(offset);
+}
+
+double ResultFile::Pval(long long int offset) const {
+	double pval;
+	std::memcpy(&pval, &(data_[offset + kPval]), sizeof(double));
+	return pval;
+}
+
+long long int ResultFile::Length(long long int offset) const {
+	return kSet + VariableLengthItemsetStack::ITM
+			+ VariableLengthItemsetStack::GetItemNum(&(data_[offset + kSet]));
+}
+
+bool ResultFile::Less::operator()(long long int lhs,
+		long long int rhs) const {
+	double l_pval = r_->Pval(lhs), r_pval = r_->Pval(rhs);
+	if (l_pval != r_pval)
+		return l_pval < r_pval;
+	const int * l_set = &(r_->data_[lhs + kSet]);
+	const int * r_set = &(r_->data_[rhs + kSet]);
+	int l_item_num = VariableLengthItemsetStack::GetItemNum(l_set);
+	int r_item_num = VariableLengthItemsetStack::GetItemNum(r_set);
+	if (l_item_num != r_item_num)
+		return l_item_num > r_item_num;
+	const int * l_item = VariableLengthItemsetStack::GetItemArray(l_set);
+	const int * r_item = VariableLengthItemsetStack::GetItemArray(r_set);
+	return std::lexicographical_compare(l_item, l_item + l_item_num, r_item,
+			r_item + r_item_num);
+}
+
+void ResultFile::Sort() {
+	std::sort(offsets_.begin(), offsets_.end(), Less(this));
+}
+
+void ResultFile::Exchange() {
+	Sort();
+	if (nu_proc_ == 1)
+		return;
+
+	// nu_proc regular samples of the local pvals from each rank, each the
+	// first of n / nu_proc sets. splitter j is the first sample after
+	// (j + 1) / nu_proc of all the sets
+	long long int n = offsets_.size();
+	std::vector<double> samples(2 * nu_proc_, 0.0); // (pval, weight)
+	for (int i = 0; i < nu_proc_; i++) {
+		samples[2 * i] = (n > 0) ?
+				Pval(offsets_[i * n / nu_proc_]) :
+				std::numeric_limits<double>::max();
+		samples[2 * i + 1] = (double) n / nu_proc_;
+	}
+	std::vector<double> all(2 * nu_proc_ * nu_proc_);
+	MPI_Allgather(&(samples[0]), 2 * nu_proc_, MPI_DOUBLE, &(all[0]),
+			2 * nu_proc_, MPI_DOUBLE, comm_);
+	std::vector<std::pair<double, double> > weighted(nu_proc_ * nu_proc_);
+	double total = 0.0;
+	for (int k = 0; k < nu_proc_ * nu_proc_; k++) {
+		weighted[k] = std::make_pair(all[2 * k], all[2 * k + 1]);
+		total += all[2 * k + 1];
+	}
+	std::sort(weighted.begin(), weighted.end());
+	std::vector<double> splitters(nu_proc_ - 1,
+			std::numeric_limits<double>::max());
+	double accum = 0.0;
+	int j = 0;
+	for (int k = 0; k < nu_proc_ * nu_proc_ && j < nu_proc_ - 1; k++) {
+		while (j < nu_proc_ - 1 && accum >= total * (j + 1) / nu_proc_)
+			splitters[j++] = weighted[k].first;
+		accum += weighted[k].second;
+	}
+
+	// sets are in pval order, so each destination is one range
+	std::vector<int> send_buf;
+	send_buf.reserve(data_.size());
+	std::vector<int> send_counts(nu_proc_, 0), send_displs(nu_proc_, 0);
+	for (long long int k = 0; k < n; k++) {
+		long long int offset = offsets_[k];
+		int dst = std::upper_bound(splitters.begin(), splitters.end(),
+				Pval(offset)) - splitters.begin();
+		long long int len = Length(offset);
+		send_buf.insert(send_buf.end(), data_.begin() + offset,
+				data_.begin() + offset + len);
+		send_counts[dst] += len;
+	}
+	std::vector<int>().swap(data_);
+	for (int p = 1; p < nu_proc_; p++)
+		send_displs[p] = send_displs[p - 1] + send_counts[p - 1];
+
+	std::vector<int> recv_counts(nu_proc_), recv_displs(nu_proc_, 0);
+	MPI_Alltoall(&(send_counts[0]), 1, MPI_INT, &(recv_counts[0]), 1,
+			MPI_INT, comm_);
+	for (int p = 1; p < nu_proc_; p++)
+		recv_displs[p] = recv_displs[p - 1] + recv_counts[p - 1];
+	long long int recv_size = recv_displs[nu_proc_ - 1]
+			+ recv_counts[nu_proc_ - 1];
+	data_.resize(recv_size);
+	exchange_size_ += send_buf.size();
+	if (send_buf.empty())
+		send_buf.push_back(0); // dummy for &(send_buf[0])
+	MPI_Alltoallv(&(send_buf[0]), &(send_counts[0]), &(send_displs[0]),
+			MPI_INT, data_.empty() ? NULL : &(data_[0]), &(recv_counts[0]),
+			&(recv_displs[0]), MPI_INT, comm_);
+
+	offsets_.clear();
+	for (long long int offset = 0; offset < recv_size;
+			offset += Length(offset))
+		offsets_.push_back(offset);
+	Sort(); // nu_proc sorted runs
+}
+
+bool ResultFile::Write(const std::string& file_name,
+		const std::string& header, long long int correction,
+		const std::vector<std::string> * item_names) {
+	// same columns as MP_LAMP::PrintSignificantSet
+	std::stringstream s;
+	if (rank_ == 0)
+		s << header;
+	for (std::size_t k = 0; k < offsets_.size(); k++) {
+		long long int offset = offsets_[k];
+		double pval = Pval(offset);
+		const int * set = &(data_[offset + kSet]);
+		int n = VariableLengthItemsetStack::GetItemNum(set);
+		const int * item = VariableLengthItemsetStack::GetItemArray(set);
+		s << "" << std::setw(16) << std::left << pval << std::right << ""
+				<< std::setw(16) << std::left << pval * correction
+				<< std::right << "" << std::setw(8)
+				<< VariableLengthItemsetStack::GetSup(set) << ""
+				<< std::setw(8) << data_[offset + kPos] << "";
+		s << "\t" << n;
+		for (int i = 0; i < n; i++) {
+			if (item_names != NULL)
+				s << "\t" << (*item_names)[item[i]];
+			else
+				s << "\t" << item[i];
+		}
+		s << std::endl;
+	}
+	std::string text = s.str();
+
+	write_bytes_ += text.size();
+	return WriteInRankOrder(comm_, file_name, text);
+}
+
+} /* namespace lamp_search */
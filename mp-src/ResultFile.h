@@ -0,0 +1,92 @@
+/*
+ * ResultFile.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_RESULTFILE_H_
+#define MP_SRC_RESULTFILE_H_
+
+#include <string>
+#include <vector>
+
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * Significant sets written by all the processes to one file (--result_file).
+ *
+ * Each rank adds its own significant sets. Exchange sorts them across the
+ * ranks in the order of sigset_compare (pval, more items first, items) by
+ * sample sort: splitters on pval are taken from regularly sampled local
+ * pvals, and the sets are sent with MPI_Alltoallv so that rank r holds the
+ * r-th range. Sets of the same pval always go to the same rank. Write then
+ * formats them like MP_LAMP::PrintSignificantSet and writes them with
+ * MPI-IO at the offset given by MPI_Exscan, so no rank holds more than its
+ * share and nothing goes through rank 0.
+ *
+ * A set is stored as
+ *   [pval (2 ints)][pos_sup][NUM][SUP][ITM...]
+ * the itemset part in the format of VariableLengthItemsetStack.
+ */
+class ResultFile {
+public:
+	ResultFile(MPI_Comm comm);
+
+	void Add(double pval, int pos_sup, const int * itemset);
+
+	// collective
+	void Exchange();
+	// collective. header is written once at the beginning of the file.
+	// return false on I/O error at any rank
+	bool Write(const std::string& file_name, const std::string& header,
+			long long int correction,
+			const std::vector<std::string> * item_names);
+
+	// sets at this rank
+	long long int Size() const {
+		return offsets_.size();
+	}
+	// ints sent by Exchange, bytes written by Write at this rank
+	long long int ExchangeSize() const {
+		return exchange_size_;
+	}
+	long long int WriteBytes() const {
+		return write_bytes_;
+	}
+
+private:
+	static const int kPval = 0;
+	static const int kPos = 2;
+	static const int kSet = 3; // itemset starts here
+
+	MPI_Comm comm_;
+	int rank_;
+	int nu_proc_;
+
+	std::vector<int> data_;
+	std::vector<long long int> offsets_; // of each set in data_
+
+	long long int exchange_size_;
+	long long int write_bytes_;
+
+	double Pval(long long int offset) const;
+	long long int Length(long long int offset) const;
+	void Sort();
+
+	// sigset_compare on sets in data_
+	class Less {
+	public:
+		Less(const ResultFile * r) :
+				r_(r) {
+		}
+		bool operator()(long long int lhs, long long int rhs) const;
+	private:
+		const ResultFile * r_;
+	};
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_RESULTFILE_H_ */
@@ -0,0 +1,74 @@
+/*
+ * SPSCQueue.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_SPSCQUEUE_H_
+#define MP_SRC_SPSCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace lamp_search {
+
+/**
+ * Lock-free bounded queue for one producer thread and one consumer thread.
+ * capacity is rounded up to a power of two.
+ */
+template<class T>
+class SPSCQueue {
+public:
+	SPSCQueue(std::size_t capacity) :
+			head_(0), tail_(0) {
+		std::size_t c = 1;
+		while (c < capacity)
+			c <<= 1;
+		mask_ = c - 1;
+		buf_.resize(c);
+	}
+
+	// producer only. return false if full
+	bool Push(const T& v) {
+		std::size_t t = tail_.load(std::memory_order_relaxed);
+		if (t - head_.load(std::memory_order_acquire) > mask_)
+			return false;
+		buf_[t & mask_] = v;
+		tail_.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only. return false if empty
+	bool Pop(T* v) {
+		std::size_t h = head_.load(std::memory_order_relaxed);
+		if (h == tail_.load(std::memory_order_acquire))
+			return false;
+		*v = buf_[h & mask_];
+		head_.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Empty() const {
+		return head_.load(std::memory_order_acquire)
+				== tail_.load(std::memory_order_acquire);
+	}
+
+	std::size_t Capacity() const {
+		return mask_ + 1;
+	}
+
+private:
+	std::vector<T> buf_;
+	std::size_t mask_;
+	// separate cache lines for producer and consumer
+	char pad0_[64];
+	std::atomic<std::size_t> head_;
+	char pad1_[64];
+	std::atomic<std::size_t> tail_;
+	char pad2_[64];
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_SPSCQUEUE_H_ */
@@ -0,0 +1,50 @@
+/*
+ * SharedFile.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SharedFile.h"
+
+#include <algorithm>
+
+namespace lamp_search {
+
+bool WriteInRankOrder(MPI_Comm comm, const std::string& file_name,
+		const std::string& text) {
+	int rank;
+	MPI_Comm_rank(comm, &rank);
+	long long int len = text.size(), offset = 0ll;
+	MPI_Exscan(&len, &offset, 1, MPI_LONG_LONG_INT, MPI_SUM, comm);
+	if (rank == 0)
+		offset = 0ll; // undefined at rank 0
+
+	MPI_File fh;
+	int ok = (MPI_File_open(comm, const_cast<char *>(file_name.c_str()),
+			MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh)
+			== MPI_SUCCESS);
+	int all_ok = 0;
+	MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+	if (!all_ok) {
+		if (ok)
+			MPI_File_close(&fh);
+		return false;
+	}
+	ok = (MPI_File_set_size(fh, 0) == MPI_SUCCESS);
+	MPI_Barrier(comm); // truncated before any write
+
+	// MPI_File_write_at takes an int count
+	const long long int chunk = 1ll << 30;
+	for (long long int pos = 0; pos < len && ok; pos += chunk) {
+		int count = (int) std::min(chunk, len - pos);
+		ok = (MPI_File_write_at(fh, offset + pos,
+				const_cast<char *>(text.c_str() + pos), count, MPI_CHAR,
+				MPI_STATUS_IGNORE) == MPI_SUCCESS);
+	}
+	MPI_File_close(&fh);
+
+	MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+	return all_ok != 0;
+}
+
+} /* namespace lamp_search */
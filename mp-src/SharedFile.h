@@ -0,0 +1,29 @@
+/*
+ * SharedFile.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_SHAREDFILE_H_
+#define MP_SRC_SHAREDFILE_H_
+
+#include <string>
+
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * Text of all the ranks written to one file with MPI-IO, in rank order
+ * (ResultFile, Tracer). Rank r writes at the total length of the ranks
+ * below it, from MPI_Exscan, so nothing goes through rank 0.
+ *
+ * Collective. file_name is truncated first. Returns false on all the ranks
+ * if any of them failed.
+ */
+bool WriteInRankOrder(MPI_Comm comm, const std::string& file_name,
+		const std::string& text);
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_SHAREDFILE_H_ */
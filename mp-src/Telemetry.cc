@@ -0,0 +1,174 @@
+/*
+ * Telemetry.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Telemetry.h"
+
+#include <cstdio>
+
+#include "../src/timer.h"
+
+namespace lamp_search {
+
+namespace {
+const char * kName[Telemetry::kFieldNum] = { "phase", "lambda",
+		"closed_sets", "expanded_nodes", "stack_itemsets", "idle_ranks",
+		"steals", "steal_rejects", "remaining_work" };
+const char * kHelp[Telemetry::kFieldNum] = { "current phase (1, 2, 3)",
+		"current min. support", "closed sets found in this phase",
+		"nodes expanded in total", "itemsets in the node stacks",
+		"processes without work", "successful steals",
+		"rejected steal requests",
+		"estimated size of the subtrees in the node stacks" };
+}
+
+Telemetry::Telemetry() :
+		parent_(MPI_COMM_NULL), comm_(MPI_COMM_NULL), rank_(0), nu_proc_(1), enabled_(
+				false), interval_(0ll), send_(kFieldNum, 0ll), recv_(
+				kFieldNum, 0ll), request_(MPI_REQUEST_NULL), active_(false), started_(
+				0ll), start_time_(0ll), next_time_(0ll), last_(kFieldNum, 0ll), last_time_(
+				0ll), prev_nodes_(0ll), prev_time_(0ll), prev_remaining_(-1ll), prev_phase_(
+				-1ll), node_rate_(0.0), eta_(-1.0) {
+}
+
+Telemetry::~Telemetry() {
+	if (comm_ != MPI_COMM_NULL)
+		MPI_Comm_free(&comm_);
+}
+
+void Telemetry::Init(MPI_Comm comm, double interval,
+		const std::string& file_name) {
+	parent_ = comm;
+	MPI_Comm_rank(comm, &rank_);
+	MPI_Comm_size(comm, &nu_proc_);
+	enabled_ = (interval > 0.0 && !file_name.empty());
+	if (!enabled_)
+		return;
+	interval_ = (long long int) (interval * 1000000000.0);
+	file_name_ = file_name;
+	MPI_Comm_dup(comm, &comm_); // rounds are ordered apart from the search
+	started_ = 0ll;
+	active_ = false;
+	start_time_ = FastClock::Now();
+	next_time_ = start_time_ + interval_;
+	prev_time_ = start_time_;
+}
+
+bool Telemetry::Due() {
+	return enabled_ && !active_ && FastClock::Now() >= next_time_;
+}
+
+long long int * Telemetry::Prepare() {
+	send_.assign(kFieldNum, 0ll);
+	return &(send_[0]);
+}
+
+void Telemetry::Start() {
+	MPI_Ireduce(&(send_[0]), &(recv_[0]), kFieldNum, MPI_LONG_LONG_INT,
+			MPI_SUM, 0, comm_, &request_);
+	active_ = true;
+	started_++;
+	next_time_ = FastClock::Now() + interval_;
+}
+
+void Telemetry::Test() {
+	if (!active_)
+		return;
+	int flag = 0;
+	MPI_Test(&request_, &flag, MPI_STATUS_IGNORE);
+	if (!flag)
+		return;
+	active_ = false;
+	if (rank_ == 0)
+		Complete(false);
+}
+
+void Telemetry::Complete(bool finished) {
+	last_ = recv_;
+	last_time_ = FastClock::Now();
+	double dt = (last_time_ - prev_time_) / 1000000000.0;
+	if (dt > 0.0)
+		node_rate_ = (last_[NODES] - prev_nodes_) / dt;
+	// remaining work / its rate of decrease, within a phase
+	eta_ = -1.0;
+	if (last_[PHASE] == prev_phase_ && prev_remaining_ > last_[REMAINING]
+			&& dt > 0.0)
+		eta_ = last_[REMAINING] * dt
+				/ (double) (prev_remaining_ - last_[REMAINING]);
+	prev_nodes_ = last_[NODES];
+	prev_time_ = last_time_;
+	prev_remaining_ = last_[REMAINING];
+	prev_phase_ = last_[PHASE];
+	if (finished)
+		eta_ = 0.0;
+	Write(finished);
+}
+
+void Telemetry::Stop(const long long int * values) {
+	if (!enabled_)
+		return;
+	long long int rounds = 0ll;
+	MPI_Allreduce(&started_, &rounds, 1, MPI_LONG_LONG_INT, MPI_MAX,
+			parent_);
+	// the rounds completed here have empty contributions, not written
+	while (active_ || started_ < rounds) {
+		if (active_) {
+			MPI_Wait(&request_, MPI_STATUS_IGNORE);
+			active_ = false;
+		}
+		if (started_ < rounds) {
+			Prepare();
+			Start();
+		}
+	}
+	send_.assign(values, values + kFieldNum);
+	MPI_Reduce(&(send_[0]), &(recv_[0]), kFieldNum, MPI_LONG_LONG_INT,
+			MPI_SUM, 0, comm_);
+	if (rank_ == 0)
+		Complete(true);
+	MPI_Comm_free(&comm_);
+	comm_ = MPI_COMM_NULL;
+	enabled_ = false;
+}
+
+bool Telemetry::Write(bool finished) const {
+	std::string tmp = file_name_ + ".tmp";
+	FILE * fp = fopen(tmp.c_str(), "w");
+	if (fp == NULL)
+		return false;
+	double elapsed = (last_time_ - start_time_) / 1000000000.0;
+	bool prom = file_name_.size() >= 5
+			&& file_name_.compare(file_name_.size() - 5, 5, ".prom") == 0;
+	if (prom) {
+		for (int k = 0; k < kFieldNum; k++)
+			fprintf(fp, "# HELP lamp_%s %s\n# TYPE lamp_%s gauge\nlamp_%s %lld\n",
+					kName[k], kHelp[k], kName[k], kName[k], last_[k]);
+		fprintf(fp, "# TYPE lamp_processes gauge\nlamp_processes %d\n",
+				nu_proc_);
+		fprintf(fp, "# TYPE lamp_nodes_per_second gauge\n"
+				"lamp_nodes_per_second %.1f\n", node_rate_);
+		fprintf(fp, "# TYPE lamp_eta_seconds gauge\nlamp_eta_seconds %.1f\n",
+				eta_);
+		fprintf(fp, "# TYPE lamp_elapsed_seconds gauge\n"
+				"lamp_elapsed_seconds %.3f\n", elapsed);
+		fprintf(fp, "# TYPE lamp_finished gauge\nlamp_finished %d\n",
+				finished ? 1 : 0);
+	} else {
+		fprintf(fp, "{\n");
+		for (int k = 0; k < kFieldNum; k++)
+			fprintf(fp, "  \"%s\": %lld,\n", kName[k], last_[k]);
+		fprintf(fp, "  \"processes\": %d,\n", nu_proc_);
+		fprintf(fp, "  \"nodes_per_second\": %.1f,\n", node_rate_);
+		fprintf(fp, "  \"eta_seconds\": %.1f,\n", eta_);
+		fprintf(fp, "  \"elapsed_seconds\": %.3f,\n", elapsed);
+		fprintf(fp, "  \"rounds\": %lld,\n", started_);
+		fprintf(fp, "  \"finished\": %s\n}\n", finished ? "true" : "false");
+	}
+	bool ok = (ferror(fp) == 0);
+	ok = (fclose(fp) == 0) && ok;
+	return ok && rename(tmp.c_str(), file_name_.c_str()) == 0;
+}
+
+} /* namespace lamp_search */
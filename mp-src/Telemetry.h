@@ -0,0 +1,114 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_TELEMETRY_H_
+#define MP_SRC_TELEMETRY_H_
+
+#include <string>
+#include <vector>
+
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * Live progress of a running search (--telemetry_file).
+ *
+ * Every --telemetry_interval seconds each rank contributes a few counters
+ * to a round of MPI_Ireduce(SUM) to rank 0 on its own communicator, started
+ * and tested from Probe. A rank starts the next round only after the
+ * previous one completed, so at most one round is open and the search never
+ * waits for it. When a round completes, rank 0 rewrites the file
+ * atomically (written to <file>.tmp and renamed): Prometheus text format if
+ * the name ends with .prom, JSON otherwise.
+ *
+ * Stop is collective: ranks that started fewer rounds catch up with empty
+ * rounds, so that all the started rounds complete. Then the final values
+ * are reduced once more and written with finished set.
+ */
+class Telemetry {
+public:
+	enum Field {
+		PHASE = 0, // rank 0 only
+		LAMBDA, // rank 0 only. min. sup of phase 1 / 2
+		CLOSED_SETS, // phase 1: rank 0 only (reduced counts)
+		NODES, // expanded
+		STACK, // itemsets in node_stack_
+		IDLE, // ranks with an empty node_stack_
+		STEALS, // successful
+		REJECTS, // steal requests rejected
+		REMAINING, // estimated size of the subtrees in node_stack_
+		kFieldNum
+	};
+
+	Telemetry();
+	~Telemetry();
+
+	// collective. interval <= 0 or an empty file name disables telemetry
+	void Init(MPI_Comm comm, double interval, const std::string& file_name);
+	bool Enabled() const {
+		return enabled_;
+	}
+	bool Active() const {
+		return active_;
+	}
+
+	// true if a new round should be filled and started
+	bool Due();
+	// zeroed values of this rank for the next round
+	long long int * Prepare();
+	void Start();
+	// progress the open round. rank 0 writes the file when it completes
+	void Test();
+
+	// collective. values: final values of this rank, as filled after Prepare
+	void Stop(const long long int * values);
+
+	long long int Rounds() const {
+		return started_;
+	}
+	// rank 0: reduced values of the last round
+	const long long int * Last() const {
+		return &(last_[0]);
+	}
+
+private:
+	MPI_Comm parent_;
+	MPI_Comm comm_;
+	int rank_;
+	int nu_proc_;
+	bool enabled_;
+	long long int interval_; // nano sec
+	std::string file_name_;
+
+	std::vector<long long int> send_;
+	std::vector<long long int> recv_;
+	MPI_Request request_;
+	bool active_;
+	long long int started_; // rounds
+	long long int start_time_; // FastClock at Init
+	long long int next_time_; // FastClock of the next round
+
+	// rank 0
+	std::vector<long long int> last_;
+	long long int last_time_;
+	long long int prev_nodes_;
+	long long int prev_time_;
+	long long int prev_remaining_;
+	long long int prev_phase_;
+	double node_rate_;
+	double eta_; // sec, -1 if unknown
+
+	void Complete(bool finished);
+	bool Write(bool finished) const;
+
+	Telemetry(const Telemetry&);
+	Telemetry& operator=(const Telemetry&);
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_TELEMETRY_H_ */
@@ -0,0 +1,109 @@
+/*
+ * TestableSet.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_TESTABLESET_H_
+#define MP_SRC_TESTABLESET_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/variable_length_itemset.h"
+
+namespace lamp_search {
+
+/**
+ * Testable itemsets of phase 2: (pval, Offset) of each itemset in
+ * freq_stack_ (cont-lamp uses freq as the key).
+ *
+ * Used to be std::multimap<double, int *>, a tree node per itemset. Push
+ * only appends 16 bytes in the order of freq_stack_, and the pval order is
+ * made once by Partition when the final significance level is known. The
+ * offset is the position in the stack, so it does not depend on where the
+ * stack is, and it finds the itemset also after the stack spilled it.
+ */
+class TestableSet {
+public:
+	struct Entry {
+		double pval_;
+		long long int offset_;
+	};
+
+	TestableSet() :
+			stack_(NULL) {
+	}
+
+	void Init(VariableLengthItemsetStack * stack) {
+		stack_ = stack;
+		entries_.clear();
+	}
+
+	// set is in stack_
+	void Push(double pval, const int * set) {
+		Entry e;
+		e.pval_ = pval;
+		e.offset_ = stack_->Offset(set);
+		entries_.push_back(e);
+	}
+
+	std::size_t Size() const {
+		return entries_.size();
+	}
+	double Pval(std::size_t i) const {
+		return entries_[i].pval_;
+	}
+	// a spilled itemset is valid until the next call
+	const int * Itemset(std::size_t i) const {
+		return stack_->At(entries_[i].offset_);
+	}
+
+	// move the entries with pval <= sig_level to the front in pval order
+	// and return their number. the rest is left in no order
+	std::size_t Partition(double sig_level) {
+		std::vector<Entry>::iterator mid = std::partition(entries_.begin(),
+				entries_.end(), AtMost(sig_level));
+		std::sort(entries_.begin(), mid, Less());
+		return mid - entries_.begin();
+	}
+
+	// all the entries in pval order (cont-lamp, whose key is freq)
+	void Sort() {
+		std::sort(entries_.begin(), entries_.end(), Less());
+	}
+
+	// index only. the itemsets are in stack_
+	long long int Bytes() const {
+		return entries_.capacity() * sizeof(Entry);
+	}
+
+private:
+	VariableLengthItemsetStack * stack_;
+	std::vector<Entry> entries_;
+
+	class AtMost {
+	public:
+		AtMost(double sig_level) :
+				sig_level_(sig_level) {
+		}
+		bool operator()(const Entry& e) const {
+			return e.pval_ <= sig_level_; // permits == case
+		}
+	private:
+		double sig_level_;
+	};
+
+	// pval, then stack order
+	struct Less {
+		bool operator()(const Entry& lhs, const Entry& rhs) const {
+			if (lhs.pval_ != rhs.pval_)
+				return lhs.pval_ < rhs.pval_;
+			return lhs.offset_ < rhs.offset_;
+		}
+	};
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_TESTABLESET_H_ */
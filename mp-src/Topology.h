@@ -0,0 +1,180 @@
+/*
+ * Topology.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_TOPOLOGY_H_
+#define MP_SRC_TOPOLOGY_H_
+
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "mpi.h"
+
+namespace lamp_search {
+
+/**
+ * Node layout of the ranks: which ranks share a node (shared memory).
+ *
+ * Detected with MPI_Comm_split_type(MPI_COMM_TYPE_SHARED).
+ * Setting the environment variable MP_LAMP_RANKS_PER_NODE=r simulates
+ * a layout of r consecutive ranks per node, which is useful for testing
+ * multi-node behaviour on a single machine.
+ */
+class Topology {
+public:
+	static const char* RanksPerNodeEnv() {
+		return "MP_LAMP_RANKS_PER_NODE";
+	}
+
+	// node_of[rank] : node id (0, 1, ...) of each rank
+	Topology(const std::vector<int>& node_of) :
+			node_of_(node_of) {
+		int nu_node = 0;
+		for (std::size_t p = 0; p < node_of_.size(); p++)
+			nu_node = std::max(nu_node, node_of_[p] + 1);
+		ranks_.resize(nu_node);
+		local_index_.resize(node_of_.size());
+		for (std::size_t p = 0; p < node_of_.size(); p++) {
+			local_index_[p] = ranks_[node_of_[p]].size();
+			ranks_[node_of_[p]].push_back(p);
+		}
+	}
+
+	/**
+	 * Collective over comm.
+	 */
+	static std::vector<int> DetectNodes(MPI_Comm comm) {
+		int rank, nu_proc;
+		MPI_Comm_rank(comm, &rank);
+		MPI_Comm_size(comm, &nu_proc);
+		std::vector<int> node_of(nu_proc, 0);
+
+		const char* env = getenv(RanksPerNodeEnv());
+		if (env != NULL && atoi(env) > 0) {
+			int r = atoi(env);
+			for (int p = 0; p < nu_proc; p++)
+				node_of[p] = p / r;
+			return node_of;
+		}
+
+		// the lowest rank on each node is the leader
+		MPI_Comm shm;
+		MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+				&shm);
+		int leader = rank;
+		MPI_Allreduce(MPI_IN_PLACE, &leader, 1, MPI_INT, MPI_MIN, shm);
+		MPI_Comm_free(&shm);
+
+		std::vector<int> leaders(nu_proc);
+		MPI_Allgather(&leader, 1, MPI_INT, &leaders[0], 1, MPI_INT, comm);
+
+		// number nodes in the order of their leaders
+		std::vector<int> id(nu_proc, -1);
+		int nu_node = 0;
+		for (int p = 0; p < nu_proc; p++) {
+			if (id[leaders[p]] < 0)
+				id[leaders[p]] = nu_node++;
+			node_of[p] = id[leaders[p]];
+		}
+		return node_of;
+	}
+
+	int NuProc() const {
+		return node_of_.size();
+	}
+	int NuNode() const {
+		return ranks_.size();
+	}
+	int NodeOf(int rank) const {
+		return node_of_[rank];
+	}
+	int LocalIndex(int rank) const {
+		return local_index_[rank];
+	}
+	int LocalSize(int node) const {
+		return ranks_[node].size();
+	}
+	// i-th rank on the node
+	int RankOf(int node, int i) const {
+		return ranks_[node][i];
+	}
+	bool SameNode(int a, int b) const {
+		return node_of_[a] == node_of_[b];
+	}
+
+	/**
+	 * Lifeline buddies of rank.
+	 * Two level version of the hypercube in MPI_Data::prepareLifelines.
+	 * - intra node: hypercube over the local indices of the node
+	 * - inter node: the first rank of each node joins a hypercube over
+	 *               the nodes, the other ranks have one edge to the rank
+	 *               with the same local index on the previous node.
+	 * So most of the edges stay within a node.
+	 */
+	std::vector<int> Lifelines(int rank, int l) const {
+		std::vector<int> lifelines;
+		int node = NodeOf(rank);
+
+		std::vector<int> buddies;
+		HypercubeBuddies(LocalIndex(rank), LocalSize(node), l, &buddies);
+		for (std::size_t i = 0; i < buddies.size(); i++)
+			lifelines.push_back(RankOf(node, buddies[i]));
+
+		if (NuNode() > 1) {
+			buddies.clear();
+			if (LocalIndex(rank) == 0) {
+				HypercubeBuddies(node, NuNode(), l, &buddies);
+			} else {
+				buddies.push_back((node + NuNode() - 1) % NuNode());
+			}
+			for (std::size_t i = 0; i < buddies.size(); i++) {
+				int n = buddies[i];
+				int b = RankOf(n, LocalIndex(rank) % LocalSize(n));
+				if (std::find(lifelines.begin(), lifelines.end(), b)
+						== lifelines.end())
+					lifelines.push_back(b);
+			}
+		}
+		return lifelines;
+	}
+
+	/**
+	 * same ring rule as MPI_Data::prepareLifelines, over [0, size)
+	 * if the previous member of a ring does not exist (size is not a power
+	 * of l), the closest existing one before it is used so that every
+	 * ring stays connected.
+	 */
+	static void HypercubeBuddies(int index, int size, int l,
+			std::vector<int>* buddies) {
+		if (l < 2)
+			l = 2;
+		int radix = 1;
+		while (radix < size) {
+			int next_radix = radix * l;
+			int base = index - index % next_radix;
+			for (int k = 1; k < l; k++) {
+				int buddy = base
+						+ (index + next_radix - k * radix) % next_radix;
+				if (buddy < size) {
+					if (buddy != index
+							&& std::find(buddies->begin(), buddies->end(),
+									buddy) == buddies->end())
+						buddies->push_back(buddy);
+					break;
+				}
+			}
+			radix = next_radix;
+		}
+	}
+
+private:
+	std::vector<int> node_of_;
+	std::vector<int> local_index_;
+	std::vector<std::vector<int> > ranks_;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_TOPOLOGY_H_ */
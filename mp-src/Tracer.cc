@@ -0,0 +1,169 @@
+/*
+ * Tracer.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+#include "SharedFile.h"
+
+namespace lamp_search {
+
+namespace {
+const char * kName[Tracer::kTypeNum] = { "phase", "expand", "probe", "idle",
+		"dtd_round", "give", "recv_give", "steal", "reject", "dtd_request",
+		"dtd_reply", "lambda" };
+}
+
+Tracer::Tracer() :
+		comm_(MPI_COMM_WORLD), rank_(0), nu_proc_(1), capacity_(0ll), next_(
+				0ll), offset_(0ll), origin_(0ll) {
+}
+
+void Tracer::Init(MPI_Comm comm, long long int capacity) {
+	comm_ = comm;
+	MPI_Comm_rank(comm_, &rank_);
+	MPI_Comm_size(comm_, &nu_proc_);
+	capacity_ = std::max(capacity, 0ll);
+	next_ = 0ll;
+	std::vector<Event>().swap(events_);
+	if (capacity_ == 0ll)
+		return;
+	events_.resize(capacity_);
+
+	EstimateOffset();
+	origin_ = Now() + offset_;
+	MPI_Bcast(&origin_, 1, MPI_LONG_LONG_INT, 0, comm_);
+}
+
+void Tracer::EstimateOffset() {
+	// rank r sends its clock t0, rank 0 answers with its clock t and r
+	// reads t1. with symmetric delays, t was taken at (t0 + t1) / 2
+	const int kRound = 8;
+	MPI_Comm comm;
+	MPI_Comm_dup(comm_, &comm); // no message of the search is matched
+	offset_ = 0ll;
+	for (int r = 1; r < nu_proc_; r++) {
+		if (rank_ == 0) {
+			for (int i = 0; i < kRound; i++) {
+				long long int t;
+				MPI_Recv(&t, 1, MPI_LONG_LONG_INT, r, 0, comm,
+						MPI_STATUS_IGNORE);
+				t = Now();
+				MPI_Send(&t, 1, MPI_LONG_LONG_INT, r, 0, comm);
+			}
+		} else if (rank_ == r) {
+			long long int best = std::numeric_limits<long long int>::max();
+			for (int i = 0; i < kRound; i++) {
+				long long int t0 = Now(), t;
+				MPI_Send(&t0, 1, MPI_LONG_LONG_INT, 0, 0, comm);
+				MPI_Recv(&t, 1, MPI_LONG_LONG_INT, 0, 0, comm,
+						MPI_STATUS_IGNORE);
+				long long int t1 = Now();
+				if (t1 - t0 < best) {
+					best = t1 - t0;
+					offset_ = t - (t0 + t1) / 2;
+				}
+			}
+		}
+	}
+	MPI_Comm_free(&comm);
+}
+
+long long int Tracer::Size() const {
+	return std::min(next_, capacity_);
+}
+
+long long int Tracer::Dropped() const {
+	return next_ - Size();
+}
+
+std::string Tracer::Json() const {
+	std::string s;
+	char buf[256];
+	// first event of each rank. those of rank > 0 follow another rank
+	snprintf(buf, sizeof(buf),
+			"%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+					"\"args\":{\"name\":\"rank %d\"}}", rank_ > 0 ? ",\n" : "",
+			rank_, rank_);
+	s += buf;
+
+	for (long long int k = next_ - Size(); k < next_; k++) {
+		const Event& e = events_[k % capacity_];
+		double ts = (e.ts_ + offset_ - origin_) / 1000.0; // micro sec
+		int len = 0;
+		switch (e.type_) {
+		case PHASE:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"phase %d\",\"ph\":\"X\",\"pid\":%d,"
+							"\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}", e.arg0_,
+					rank_, ts, e.dur_ / 1000.0);
+			break;
+		case EXPAND:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+							"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"nodes\":%lld}}",
+					kName[e.type_], rank_, ts, e.dur_ / 1000.0, e.arg1_);
+			break;
+		case PROBE:
+		case IDLE:
+		case DTD_ROUND:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+							"\"ts\":%.3f,\"dur\":%.3f}", kName[e.type_], rank_,
+					ts, e.dur_ / 1000.0);
+			break;
+		case GIVE:
+		case RECV_GIVE:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+							"\"tid\":0,\"ts\":%.3f,\"args\":{\"peer\":%d,"
+							"\"nodes\":%lld}}", kName[e.type_], rank_, ts,
+					e.arg0_, e.arg1_);
+			break;
+		case STEAL:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+							"\"tid\":0,\"ts\":%.3f,\"args\":{\"peer\":%d,"
+							"\"lifeline\":%lld}}", kName[e.type_], rank_, ts,
+					e.arg0_, e.arg1_);
+			break;
+		case REJECT:
+		case DTD_REQUEST:
+		case DTD_REPLY:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,"
+							"\"tid\":0,\"ts\":%.3f,\"args\":{\"peer\":%d}}",
+					kName[e.type_], rank_, ts, e.arg0_);
+			break;
+		case LAMBDA:
+			len = snprintf(buf, sizeof(buf),
+					",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,"
+							"\"args\":{\"lambda\":%lld}}", kName[e.type_],
+					rank_, ts, e.arg1_);
+			break;
+		}
+		if (len > 0)
+			s.append(buf, std::min(len, (int) sizeof(buf) - 1));
+	}
+	return s;
+}
+
+bool Tracer::Write(const std::string& file_name) {
+	const std::string header = "{\"traceEvents\":[\n";
+	const std::string footer = "\n],\"displayTimeUnit\":\"ms\"}\n";
+	std::string text = Json();
+	if (rank_ == 0)
+		text = header + text;
+	if (rank_ == nu_proc_ - 1)
+		text += footer;
+
+	return WriteInRankOrder(comm_, file_name, text);
+}
+
+} /* namespace lamp_search */
@@ -0,0 +1,118 @@
+/*
+ * Tracer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MP_SRC_TRACER_H_
+#define MP_SRC_TRACER_H_
+
+#include <string>
+#include <vector>
+
+#include "mpi.h"
+
+#include "../src/timer.h"
+
+namespace lamp_search {
+
+/**
+ * Timeline of the search for chrome://tracing or Perfetto (--trace).
+ *
+ * Each rank keeps its events in a ring buffer of fixed size, so the latest
+ * events are kept and recording never allocates. Only the main thread
+ * records, so the buffer needs no lock. When disabled, recording is one
+ * branch.
+ *
+ * Init estimates the offset of each rank's FastClock to rank 0 by ping-pong
+ * (the exchange with the smallest round trip), so the ranks share one time
+ * axis. Write merges the events of all the ranks into one JSON file with
+ * MPI-IO, one process per rank (pid = rank).
+ */
+class Tracer {
+public:
+	enum Type {
+		PHASE = 0, // complete. arg0: phase
+		EXPAND, // complete. arg1: nodes
+		PROBE, // complete
+		IDLE, // complete
+		DTD_ROUND, // complete, --dtd_engine=1
+		GIVE, // instant. arg0: thief, arg1: nodes
+		RECV_GIVE, // instant. arg0: victim, arg1: nodes
+		STEAL, // instant. arg0: victim, arg1: lifeline (>= 0) or -1
+		REJECT, // instant. arg0: victim
+		DTD_REQUEST, // instant
+		DTD_REPLY, // instant. arg0: child
+		LAMBDA, // counter. arg1: lambda
+		kTypeNum
+	};
+
+	Tracer();
+
+	// collective. capacity 0 disables tracing
+	void Init(MPI_Comm comm, long long int capacity);
+	bool Enabled() const {
+		return capacity_ > 0;
+	}
+
+	long long int Now() const {
+		return FastClock::Now();
+	}
+	// [start, Now())
+	void Complete(int type, long long int start, int arg0 = 0,
+			long long int arg1 = 0ll) {
+		if (capacity_ > 0)
+			Push(type, start, Now() - start, arg0, arg1);
+	}
+	void Instant(int type, int arg0 = 0, long long int arg1 = 0ll) {
+		if (capacity_ > 0)
+			Push(type, Now(), -1ll, arg0, arg1);
+	}
+
+	// collective. return false on I/O error at any rank
+	bool Write(const std::string& file_name);
+
+	long long int Size() const; // events kept
+	long long int Dropped() const; // overwritten by later events
+	long long int Offset() const {
+		return offset_;
+	}
+
+private:
+	struct Event {
+		long long int ts_; // FastClock of this rank
+		long long int dur_; // -1: instant
+		long long int arg1_;
+		int type_;
+		int arg0_;
+	};
+
+	MPI_Comm comm_;
+	int rank_;
+	int nu_proc_;
+
+	long long int capacity_;
+	long long int next_; // events ever pushed
+	std::vector<Event> events_;
+
+	long long int offset_; // add to the local clock for that of rank 0
+	long long int origin_; // rank 0 clock at Init
+
+	void Push(int type, long long int ts, long long int dur, int arg0,
+			long long int arg1) {
+		Event& e = events_[next_ % capacity_];
+		e.ts_ = ts;
+		e.dur_ = dur;
+		e.arg1_ = arg1;
+		e.type_ = type;
+		e.arg0_ = arg0;
+		next_++;
+	}
+
+	void EstimateOffset();
+	std::string Json() const;
+};
+
+} /* namespace lamp_search */
+
+#endif /* MP_SRC_TRACER_H_ */
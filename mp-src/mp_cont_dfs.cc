@@ -68,6 +68,7 @@ DECLARE_int32(stack_size);// 1024*1024*64, used as int[stack_size], lamp.cc
 DEFINE_int32(give_size_max, 1024 * 1024 * 4,
 		"maximum size of one give");
 DECLARE_int32(freq_max); // 1024*1024*64, "stack size for holding freq sets", lamp.cc
+DECLARE_bool(topology); // false, "topology aware steal and lifelines", ParallelDFS.cc
 DEFINE_int32(sig_max, 1024 * 1024 * 64,
 		"stack size for holding significant sets");
 
@@ -99,7 +100,8 @@ MP_CONT_LAMP::MP_CONT_LAMP(ContDatabase* d, int rank, int nu_proc,
 		double freqRatio) :
 		d_(d), dtd_(k_echo_tree_branch), mpi_data_(
 				FLAGS_bsend_buffer_size, rank, nu_proc, n, n_is_ms, w,
-				l, m, k_echo_tree_branch, &dtd_), disretizeFreq(
+				l, m, k_echo_tree_branch, &dtd_,
+				FLAGS_topology), disretizeFreq(
 				disretizeFreq), freqRatio(freqRatio), timer_(
 				Timer::GetInstance()), give_stack_(
 		NULL), stealer_(mpi_data_.nRandStealTrials_,
@@ -152,6 +154,7 @@ MP_CONT_LAMP::MP_CONT_LAMP(ContDatabase* d, int rank, int nu_proc,
 	node_stack_ = new VariableLengthItemsetStack(FLAGS_stack_size);
 	give_stack_ = new VariableLengthItemsetStack(FLAGS_give_size_max);
 	freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max);
+	freq_map_.Init(freq_stack_);
 
 	printf("initialized MP_LAMP\n");
 }
@@ -425,6 +428,7 @@ void MP_CONT_LAMP::Search() {
 	GetContSignificantData* getsignificant_data_;
 
 	log_.d_.search_start_time_ = timer_->Elapsed();
+	log_.StartPhase(0);
 	total_expand_num_ = 0ll;
 
 	expand_num_ = 0ll;
@@ -438,6 +442,7 @@ void MP_CONT_LAMP::Search() {
 // prepare phase 1
 // TODO: phase 1 should be started when PreProcessRootNode started.
 	phase_ = 1;
+	log_.StartPhase(1);
 	CheckPoint();
 	{
 		// TODO: This should be a part of PreProcessRootNode method.
@@ -502,6 +507,7 @@ void MP_CONT_LAMP::Search() {
 // --------
 // prepare phase 2
 	phase_ = 2;
+	log_.StartPhase(2);
 	CheckPoint();
 
 //	CallBcast(&lambda_, 1, MPI_INT); // Rank-0 process broadcasts its lambda to all the other processes
@@ -509,6 +515,7 @@ void MP_CONT_LAMP::Search() {
 
 	if (!FLAGS_second_phase) {
 		log_.d_.search_finish_time_ = timer_->Elapsed();
+		log_.FinishPhase();
 		log_.GatherLog(mpi_data_.nTotalProc_);
 		DBG(D(1) << "log" << std::endl
 		;);
@@ -573,9 +580,9 @@ void MP_CONT_LAMP::Search() {
 //		sig_level_ = gettestable_data_->sig_level_;
 		assert(freq_stack_ == gettestable_data_->freq_stack_);
 		assert(
-				freq_map_.size()
-						== gettestable_data_->freq_map_->size());
-		closed_set_num_ = freq_map_.size();
+				freq_map_.Size()
+						== gettestable_data_->freq_map_->Size());
+		closed_set_num_ = freq_map_.Size();
 	}
 
 	DBG(D(1) << "closed_set_num=" << closed_set_num_ << std::endl
@@ -617,6 +624,7 @@ void MP_CONT_LAMP::Search() {
 
 	if (!FLAGS_third_phase) {
 		log_.d_.search_finish_time_ = timer_->Elapsed();
+		log_.FinishPhase();
 		log_.GatherLog(mpi_data_.nTotalProc_);
 		DBG(D(1) << "log" << std::endl
 		;);
@@ -629,6 +637,7 @@ void MP_CONT_LAMP::Search() {
 
 // prepare 3rd phase
 	phase_ = 3;
+	log_.StartPhase(3);
 //ClearTasks();
 	CheckPoint(); // needed for reseting dtd_.terminated_
 
@@ -667,6 +676,7 @@ void MP_CONT_LAMP::Search() {
 	if (mpi_data_.mpiRank_ == 0)
 		SortSignificantSets();
 	log_.d_.search_finish_time_ = timer_->Elapsed();
+	log_.FinishPhase();
 	MPI_Barrier( MPI_COMM_WORLD);
 
 	{
@@ -833,6 +843,20 @@ std::ostream & MP_CONT_LAMP::PrintAggrLog(std::ostream & out) {
 
 	s << std::setprecision(3);
 
+	// wall: rank 0, max, avg. cpu: rank 0, total, avg
+	for (int p = 0; p < Log::kPhaseNum; p++) {
+		s << "# phase" << p << "_wall_time  =" << std::setw(16)
+				<< log_.d_.phase_wall_time_[p] / MEGA << std::setw(16)
+				<< log_.a_.phase_wall_time_[p] / MEGA // max
+				<< std::setw(16) << "---" << "(ms)" << std::endl;
+		s << "# phase" << p << "_cpu_time   =" << std::setw(16)
+				<< log_.d_.phase_cpu_time_[p] / MEGA << std::setw(16)
+				<< log_.a_.phase_cpu_time_[p] / MEGA // sum
+				<< std::setw(16)
+				<< log_.a_.phase_cpu_time_[p] / MEGA / mpi_data_.nTotalProc_ // avg
+				<< "(ms)" << std::endl;
+	}
+
 	s << "# process_node_num  =" << std::setw(16)
 			<< log_.d_.process_node_num_ << std::setw(16)
 			<< log_.a_.process_node_num_
@@ -1079,6 +1103,13 @@ std::ostream & MP_CONT_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16)
 			<< log_.a_.nodes_received_ / mpi_data_.nTotalProc_ // avg
 			<< std::endl;
+	s << "# steal_reject_num  =" << std::setw(16)
+			<< log_.d_.steal_reject_num_ << std::setw(16)
+			<< log_.a_.steal_reject_num_
+			// sum
+			<< std::setw(16)
+			<< log_.a_.steal_reject_num_ / mpi_data_.nTotalProc_ // avg
+			<< std::endl;
 
 	s << "# lfl_given_num     =" << std::setw(16)
 			<< log_.d_.lifeline_given_num_ << std::setw(16)
@@ -1230,6 +1261,12 @@ std::ostream & MP_CONT_LAMP::PrintLog(std::ostream & out) const {
 
 	s << std::setprecision(3);
 
+	for (int p = 0; p < Log::kPhaseNum; p++)
+		s << "# phase" << p << "_time       =" << std::setw(16)
+				<< log_.d_.phase_wall_time_[p] / MEGA << std::setw(16)
+				<< log_.d_.phase_cpu_time_[p] / MEGA << "(ms wall, ms cpu)"
+				<< std::endl;
+
 	s << "# process_node_num  =" << std::setw(16)
 			<< log_.d_.process_node_num_ << std::endl;
 	s << "# process_node_time =" << std::setw(16)
@@ -147,7 +147,7 @@ private:
 //	uint64 * sup_buf_, *child_sup_buf_;
 
 	VariableLengthItemsetStack * freq_stack_; // record freq itemsets
-	std::multimap<double, int *> freq_map_; // record (pval, *itemsets)
+	TestableSet freq_map_; // record (pval, itemset offset)
 
 	VariableLengthItemsetStack * significant_stack_;
 
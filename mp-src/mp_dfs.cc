@@ -41,6 +41,8 @@
 #include "gflags/gflags.h"
 #include "mp_dfs.h"
 #include "ParallelPatternMining.h"
+#include "ResultFile.h"
+#include "ClosedSetFile.h"
 #include  "../src/database.h"
 
 #ifdef __CDT_PARSER__
@@ -68,9 +70,46 @@ DECLARE_bool(third_phase);// true, "do third phase"
 DECLARE_int32(stack_size);// 1024*1024*64, used as int[stack_size], lamp.cc
 DEFINE_int32(give_size_max, 1024 * 1024 * 4, "maximum size of one give");
 DECLARE_int32(freq_max); // 1024*1024*64, "stack size for holding freq sets", lamp.cc
+DECLARE_bool(topology); // false, "topology aware steal and lifelines", ParallelDFS.cc
+DECLARE_int32(dtd_engine); // 0: echo, 1: nonblocking collectives, ParallelDFS.cc
+DECLARE_string(checkpoint_prefix); // "lamp", ParallelDFS.cc
+DEFINE_bool(restart, false,
+		"resume from the checkpoint at --checkpoint_prefix "
+		"(the number of processes may differ)");
+DEFINE_string(result_file, "",
+		"write the significant patterns to this file from all processes "
+		"(MPI-IO) instead of collecting them at rank 0");
+DEFINE_bool(perf, false,
+		"count cycles, instructions and LLC misses per phase and per node "
+		"with perf_event_open (shown with --log)");
+DEFINE_string(trace, "",
+		"write a timeline of the search (Chrome trace JSON) to this file");
+DEFINE_int32(trace_size, 1 << 20,
+		"events kept per process for --trace (the latest ones)");
+DEFINE_string(telemetry_file, "",
+		"rank 0 rewrites this file with the progress of the search every "
+		"--telemetry_interval seconds (Prometheus text if it ends with .prom, "
+		"JSON otherwise)");
+DEFINE_double(telemetry_interval, 10.0,
+		"seconds between the updates of --telemetry_file");
+DEFINE_string(phase1_save, "",
+		"save the closed sets of phase 1 to <prefix>.<rank>.cs for later runs "
+		"with other positives or alpha");
+DEFINE_string(phase1_load, "",
+		"take lambda and the closed sets from --phase1_save of the same "
+		"item file instead of phase 1");
 DEFINE_int32(sig_max, 1024 * 1024 * 64,
 		"stack size for holding significant sets");
-
+DEFINE_int32(stack_segment, 1024 * 1024,
+		"the node, freq and significant stacks are allocated in segments of "
+		"this many ints, up to --stack_size, --freq_max and --sig_max");
+DEFINE_string(spill_dir, "",
+		"write the testable sets of phase 2 to a file in this directory "
+		"(local disk) except the latest segment, and read them back in phase 3");
+
+DEFINE_int32(read_threads, 0,
+		"parse the text item file with this many threads from a mapped file "
+		"(0: read it as a stream)");
 DEFINE_int32(bsend_buffer_size, 1024 * 1024 * 64, "size of bsend buffer");
 
 DEFINE_int32(d, 10, "debug level. 0: none, higher level produce more log");
@@ -95,14 +134,16 @@ const int MP_LAMP::k_probe_period = 128;
 MP_LAMP::MP_LAMP(int rank, int nu_proc, int n, bool n_is_ms, int w, int l,
 		int m) :
 		dtd_(k_echo_tree_branch), mpi_data_(FLAGS_bsend_buffer_size, rank,
-				nu_proc, n, n_is_ms, w, l, m, k_echo_tree_branch, &dtd_), d_(
-		NULL), bsh_(NULL), timer_(Timer::GetInstance()), dtd_accum_array_base_(
+				nu_proc, n, n_is_ms, w, l, m, k_echo_tree_branch, &dtd_,
+				FLAGS_topology), d_(
+		NULL), bsh_(NULL), binary_(NULL), pos_array_(NULL), timer_(Timer::GetInstance()), dtd_accum_array_base_(
 		NULL), accum_array_(NULL), dtd_accum_recv_base_(NULL), accum_recv_(
 		NULL), give_stack_(NULL), stealer_(mpi_data_.nRandStealTrials_,
 				mpi_data_.hypercubeDimension_), phase_(0), sup_buf_(
 		NULL), child_sup_buf_(NULL), freq_stack_(NULL), significant_stack_(
 		NULL), total_expand_num_(0ll), expand_num_(0ll), closed_set_num_(0ll), final_closed_set_num_(
-				0ll), final_support_(0), final_sig_level_(0.0), last_bcast_was_dtd_(
+				0ll), final_support_(0), final_sig_level_(0.0), written_sig_num_(
+				0ll), last_bcast_was_dtd_(
 				false) {
 	printf("initializing MP_LAMP\n");
 	if (FLAGS_d > 0) {
@@ -123,6 +164,7 @@ MP_LAMP::MP_LAMP(int rank, int nu_proc, int n, bool n_is_ms, int w, int l,
 // note: should remove victim if in lifeline ???
 
 	dtd_.Init();
+	Checkpoint::InstallSignalHandlers();
 
 	printf("dtd\n");
 
@@ -233,6 +275,10 @@ MP_LAMP::~MP_LAMP() {
 
 	if (d_)
 		delete d_;
+	if (binary_)
+		delete binary_; // after d_, which may point into it
+	if (pos_array_)
+		bsh_->Delete(pos_array_);
 //	if (g_)
 //		delete g_;
 
@@ -273,7 +319,15 @@ void MP_LAMP::InitDatabaseRoot(std::istream & is1, std::istream & is2) {
 		item_names = new std::vector<std::string>;
 		transaction_names = new std::vector<std::string>;
 
-		if (FLAGS_lcm) {
+		if (FLAGS_read_threads > 0) {
+			// is1 is not read
+			reader.ReadItemsMapped(FLAGS_item, FLAGS_lcm, FLAGS_read_threads,
+					&nu_trans, &nu_items, &bsh_, &data, item_names,
+					transaction_names, &max_item_in_transaction);
+			reader.ReadPosNeg(is2, nu_trans,
+					FLAGS_lcm ? NULL : transaction_names, &nu_pos_total, bsh_,
+					&positive);
+		} else if (FLAGS_lcm) {
 			reader.ReadFilesLCM(&bsh_, is1, &data, &nu_trans, &nu_items, is2,
 					&positive, &nu_pos_total, item_names,
 					&max_item_in_transaction);
@@ -303,48 +357,7 @@ void MP_LAMP::InitDatabaseRoot(std::istream & is1, std::istream & is2) {
 
 //	g_ = new LampGraph<uint64>(*d_);
 
-	// Lambda max is initially the number of total transactions in the database.
-	lambda_max_ = d_->MaxX(); // used for getMinSup
-	// D() << "max_x=lambda_max=" << lambda_max_ << std::endl;
-	// D() << "pos_total=" << d_->PosTotal() << std::endl;
-	// d_->DumpItems(D(false));
-	// d_->DumpPMinTable(D(false));
-
-	double *pmin_thr_ = new double[lambda_max_ + 1]; // used for getMinSup
-	cs_thr_ = new long long int[lambda_max_ + 1]; // used for getMinSup
-
-	dtd_accum_array_base_ = new long long int[lambda_max_ + 4];
-	dtd_accum_recv_base_ = new long long int[lambda_max_ + 4];
-	accum_array_ = &(dtd_accum_array_base_[3]); // TODO: ???
-	accum_recv_ = &(dtd_accum_recv_base_[3]);
-
-	node_stack_ = new VariableLengthItemsetStack(FLAGS_stack_size);
-	give_stack_ = new VariableLengthItemsetStack(FLAGS_give_size_max);
-	freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max);
-	// node_stack_ =  new VariableLengthItemsetStack(FLAGS_stack_size, lambda_max_);
-	// give_stack_ =  new VariableLengthItemsetStack(FLAGS_give_size_max, lambda_max_);
-	// freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max, lambda_max_);
-
-	for (int i = 0; i <= lambda_max_; i++)
-		pmin_thr_[i] = d_->PMin(i);
-
-	cs_thr_[0] = 0ll; // should not be used ???
-	for (int i = 1; i <= lambda_max_; i++) {
-		cs_thr_[i] = (long long int) (std::min(
-				std::floor(FLAGS_a / pmin_thr_[i - 1]), (double) (k_cs_max)));
-		DBG(
-				D(2) << "cs_thr[" << i << "]=\t" << cs_thr_[i] << "\tpmin_thr="
-						<< pmin_thr_[i - 1] << std::endl
-				;);
-	}
-
-	for (int i = 0; i <= lambda_max_; i++)
-		accum_array_[i] = 0ll;
-
-	sup_buf_ = bsh_->New();
-	child_sup_buf_ = bsh_->New();
-
-	delete pmin_thr_;
+	InitSearch();
 }
 
 void MP_LAMP::InitDatabaseRoot(std::istream & is1, int posnum) {
@@ -368,7 +381,12 @@ void MP_LAMP::InitDatabaseRoot(std::istream & is1, int posnum) {
 		item_names = new std::vector<std::string>;
 		transaction_names = new std::vector<std::string>;
 
-		if (FLAGS_lcm) {
+		if (FLAGS_read_threads > 0) {
+			// is1 is not read
+			reader.ReadItemsMapped(FLAGS_item, FLAGS_lcm, FLAGS_read_threads,
+					&nu_trans, &nu_items, &bsh_, &data, item_names,
+					transaction_names, &max_item_in_transaction);
+		} else if (FLAGS_lcm) {
 			reader.ReadFilesLCM(&bsh_, is1, &data, &nu_trans, &nu_items,
 					item_names, &max_item_in_transaction);
 		} else {
@@ -392,46 +410,7 @@ void MP_LAMP::InitDatabaseRoot(std::istream & is1, int posnum) {
 			transaction_names);
 //	g_ = new LampGraph<uint64>(*d_);
 
-	lambda_max_ = d_->MaxX();
-	// D() << "max_x=lambda_max=" << lambda_max_ << std::endl;
-	// D() << "pos_total=" << d_->PosTotal() << std::endl;
-	// d_->DumpItems(D(false));
-	// d_->DumpPMinTable(D(false));
-
-	double* pmin_thr_ = new double[lambda_max_ + 1];
-	cs_thr_ = new long long int[lambda_max_ + 1];
-	dtd_accum_array_base_ = new long long int[lambda_max_ + 4];
-	dtd_accum_recv_base_ = new long long int[lambda_max_ + 4];
-	accum_array_ = &(dtd_accum_array_base_[3]);
-	accum_recv_ = &(dtd_accum_recv_base_[3]);
-
-	node_stack_ = new VariableLengthItemsetStack(FLAGS_stack_size);
-	give_stack_ = new VariableLengthItemsetStack(FLAGS_give_size_max);
-	freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max);
-	// node_stack_ =  new VariableLengthItemsetStack(FLAGS_stack_size, lambda_max_);
-	// give_stack_ =  new VariableLengthItemsetStack(FLAGS_give_size_max, lambda_max_);
-	// freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max, lambda_max_);
-
-	for (int i = 0; i <= lambda_max_; i++)
-		pmin_thr_[i] = d_->PMin(i);
-
-	cs_thr_[0] = 0ll; // should not be used ???
-	for (int i = 1; i <= lambda_max_; i++) {
-		cs_thr_[i] = (long long int) (std::min(
-				std::floor(FLAGS_a / pmin_thr_[i - 1]), (double) (k_cs_max)));
-		DBG(
-				D(2) << "cs_thr[" << i << "]=\t" << cs_thr_[i] << "\tpmin_thr="
-						<< pmin_thr_[i - 1] << std::endl
-				;);
-	}
-
-	for (int i = 0; i <= lambda_max_; i++)
-		accum_array_[i] = 0ll;
-
-	sup_buf_ = bsh_->New();
-	child_sup_buf_ = bsh_->New();
-
-	delete pmin_thr_;
+	InitSearch();
 }
 
 void MP_LAMP::InitDatabaseSub(bool pos) {
@@ -470,25 +449,156 @@ void MP_LAMP::InitDatabaseSub(bool pos) {
 			NULL, NULL);
 //	g_ = new LampGraph<uint64>(*d_);
 
-	lambda_max_ = d_->MaxX();
-// D() << "max_x=lambda_max=" << lambda_max_ << std::endl;
-// D() << "pos_total=" << d_->PosTotal() << std::endl;
-// d_->DumpItems(D(false));
-// d_->DumpPMinTable(D(false));
+	InitSearch();
+}
+
+void MP_LAMP::InitDatabaseBinary(const std::string & file_name,
+		const std::string & pos_file, int posnum) {
+	uint64 * data = NULL;
+	uint64 * positive = NULL;
+	boost::array<int, 6> counters; // nu_bits, nu_trans, nu_items, nu_pos_total, max_item_in_transaction, has positive
+	counters.assign(-1);
+
+	int nu_trans = 0;
+	int nu_items = 0;
+	int nu_pos_total = 0;
+	int max_item_in_transaction = 0;
+
+	std::vector<std::string> * item_names = NULL;
+	std::vector<std::string> * transaction_names = NULL;
+
+	// every process maps the file if it can see it (shared file system)
+	binary_ = new BinaryDatabase<uint64>;
+	int mapped = 1;
+	std::string error;
+	try {
+		binary_->Map(file_name);
+	} catch (std::runtime_error & err) {
+		mapped = 0;
+		error = err.what();
+	}
+	int root_mapped = mapped;
+	CallBcast(&root_mapped, 1, MPI_INT);
+	if (!root_mapped)
+		throw std::runtime_error(
+				mpi_data_.mpiRank_ == 0 ?
+						error : std::string("binary database not read"));
+	int all_mapped = 0;
+	MPI_Allreduce(&mapped, &all_mapped, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+	if (mpi_data_.mpiRank_ == 0 || all_mapped) {
+		bsh_ = new VariableBitsetHelper<uint64>(binary_->NuBits());
+		// mapped read only. the search does not write to the database
+		data = const_cast<uint64 *>(binary_->Data());
+		positive = const_cast<uint64 *>(binary_->PosNeg());
+		nu_trans = binary_->NuTransaction();
+		nu_items = binary_->NuItems();
+		if (positive)
+			nu_pos_total = binary_->PosTotal();
+		max_item_in_transaction = binary_->MaxItemInTransaction();
+		if (mpi_data_.mpiRank_ == 0) {
+			item_names = new std::vector<std::string>;
+			transaction_names = new std::vector<std::string>;
+			binary_->ItemNames(item_names);
+			binary_->TransactionNames(transaction_names);
+		}
+	} else {
+		binary_->Unmap();
+	}
+
+	if (!all_mapped) {
+		// process 0 broadcasts it as InitDatabaseRoot
+		if (mpi_data_.mpiRank_ == 0) {
+			counters[0] = (int) (bsh_->nu_bits);
+			counters[1] = nu_trans;
+			counters[2] = nu_items;
+			counters[3] = nu_pos_total;
+			counters[4] = max_item_in_transaction;
+			counters[5] = (positive != NULL);
+		}
+		CallBcast(&counters, 6, MPI_INT);
+		if (mpi_data_.mpiRank_ != 0) {
+			nu_trans = counters[1];
+			nu_items = counters[2];
+			nu_pos_total = counters[3];
+			max_item_in_transaction = counters[4];
+			bsh_ = new VariableBitsetHelper<uint64>(counters[0]);
+			data = bsh_->NewArray(nu_items);
+			if (counters[5])
+				positive = bsh_->New();
+		}
+		CallBcast(data, bsh_->NewArraySize(nu_items), MPI_UNSIGNED_LONG_LONG);
+		if (counters[5])
+			CallBcast(positive, bsh_->NuBlocks(), MPI_UNSIGNED_LONG_LONG);
+	}
+
+	// --pos and --posnum replace the positives in the file: same items,
+	// new labels
+	if (!pos_file.empty() || posnum > 0) {
+		if (positive != NULL && !binary_->Mapped())
+			bsh_->Delete(positive);
+		positive = NULL;
+		nu_pos_total = posnum;
+	}
+	if (!pos_file.empty()) {
+		// bits are kept for transactions with an item only, and the file
+		// does not tell which ones they are unless it is all of them
+		if ((int) (bsh_->nu_bits) != nu_trans)
+			throw std::runtime_error(
+					"--pos needs a binary database where every transaction has an item: give the text files instead, or write the database with the new positive file");
+		if (mpi_data_.mpiRank_ == 0) {
+			std::ifstream positive_file(pos_file.c_str(), std::ios::in);
+			if (positive_file.fail())
+				throw std::runtime_error(
+						std::string("file not found: ") + pos_file);
+			DatabaseReader<uint64> reader;
+			for (int t = 0; t < nu_trans; t++)
+				reader.non_zero_trans_list_.push_back(t);
+			reader.ReadPosNeg(positive_file, nu_trans,
+					((int) transaction_names->size() == nu_trans) ?
+							transaction_names : NULL, &nu_pos_total, bsh_,
+					&positive);
+		} else
+			positive = bsh_->New();
+		CallBcast(&nu_pos_total, 1, MPI_INT);
+		CallBcast(positive, bsh_->NuBlocks(), MPI_UNSIGNED_LONG_LONG);
+		if (binary_->Mapped())
+			pos_array_ = positive; // the database does not own it
+	}
+
+	// as the checks of --pos in bin-lamp
+	if (positive == NULL && (nu_pos_total <= 0 || FLAGS_third_phase))
+		throw std::runtime_error(
+				"binary database without positives: specify --pos, or --posnum and --third_phase=false");
+
+	long long int start_time = timer_->Elapsed();
+	d_ = new Database<uint64>(bsh_, data, nu_trans, nu_items, positive,
+			nu_pos_total, max_item_in_transaction, item_names,
+			transaction_names, !binary_->Mapped());
+	log_.d_.pval_table_time_ = timer_->Elapsed() - start_time;
+
+	InitSearch();
+}
+
+void MP_LAMP::InitSearch() {
+	lambda_max_ = d_->MaxX(); // used for getMinSup
+	// D() << "max_x=lambda_max=" << lambda_max_ << std::endl;
+	// D() << "pos_total=" << d_->PosTotal() << std::endl;
+	// d_->DumpItems(D(false));
+	// d_->DumpPMinTable(D(false));
+
+	double *pmin_thr_ = new double[lambda_max_ + 1]; // used for getMinSup
+	cs_thr_ = new long long int[lambda_max_ + 1]; // used for getMinSup
 
-	double* pmin_thr_ = new double[lambda_max_ + 1];
-	cs_thr_ = new long long int[lambda_max_ + 1];
 	dtd_accum_array_base_ = new long long int[lambda_max_ + 4];
 	dtd_accum_recv_base_ = new long long int[lambda_max_ + 4];
-	accum_array_ = &(dtd_accum_array_base_[3]);
+	accum_array_ = &(dtd_accum_array_base_[3]); // TODO: ???
 	accum_recv_ = &(dtd_accum_recv_base_[3]);
 
-	node_stack_ = new VariableLengthItemsetStack(FLAGS_stack_size);
-	give_stack_ = new VariableLengthItemsetStack(FLAGS_give_size_max);
-	freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max);
-// node_stack_ =  new VariableLengthItemsetStack(FLAGS_stack_size, lambda_max_);
-// give_stack_ =  new VariableLengthItemsetStack(FLAGS_give_size_max, lambda_max_);
-// freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max, lambda_max_);
+	InitStacks();
+	// node_stack_ =  new VariableLengthItemsetStack(FLAGS_stack_size, lambda_max_);
+	// give_stack_ =  new VariableLengthItemsetStack(FLAGS_give_size_max, lambda_max_);
+	// freq_stack_ = new VariableLengthItemsetStack(FLAGS_freq_max, lambda_max_);
 
 	for (int i = 0; i <= lambda_max_; i++)
 		pmin_thr_[i] = d_->PMin(i);
@@ -512,6 +622,36 @@ void MP_LAMP::InitDatabaseSub(bool pos) {
 	delete pmin_thr_;
 }
 
+void MP_LAMP::InitStacks() {
+	int max_items = d_->NuItems();
+	node_stack_ = new VariableLengthItemsetStack(
+			VariableLengthItemsetStack::SEGMENTED, FLAGS_stack_segment,
+			FLAGS_stack_size, max_items);
+	// sent and received as one array
+	give_stack_ = new VariableLengthItemsetStack(
+			VariableLengthItemsetStack::CONTIGUOUS, FLAGS_stack_segment,
+			FLAGS_give_size_max, max_items);
+	freq_stack_ = new VariableLengthItemsetStack(
+			VariableLengthItemsetStack::SEGMENTED, FLAGS_stack_segment,
+			FLAGS_freq_max, max_items);
+	if (!FLAGS_spill_dir.empty()) {
+		std::stringstream file_name;
+		file_name << FLAGS_spill_dir << "/lamp_freq." << mpi_data_.mpiRank_
+				<< ".spill";
+		if (!freq_stack_->Spill(file_name.str()))
+			printf("rank %d: cannot open %s, testable sets stay in memory\n",
+					mpi_data_.mpiRank_, file_name.str().c_str());
+	}
+	freq_map_.Init(freq_stack_);
+}
+
+void MP_LAMP::LogStacks() {
+	if (node_stack_)
+		log_.d_.node_stack_peak_bytes_ = node_stack_->PeakBytes();
+	log_.d_.freq_stack_peak_bytes_ = freq_stack_->PeakBytes();
+	log_.d_.freq_stack_spill_bytes_ = freq_stack_->SpilledBytes();
+}
+
 void MP_LAMP::Init() {
 	// todo: move accum cs count variable to inner class
 	mpi_data_.echo_waiting_ = false;
@@ -584,6 +724,7 @@ void MP_LAMP::ClearTasks() {
 		src = probe_status.MPI_SOURCE;
 		tag = probe_status.MPI_TAG;
 
+		give_stack_->Reserve(data_count);
 		error = MPI_Recv(give_stack_->Stack(), data_count, MPI_INT, src, tag,
 		MPI_COMM_WORLD, &recv_status);
 		if (error != MPI_SUCCESS) {
@@ -610,7 +751,15 @@ void MP_LAMP::Search() {
 	GetTestableData* gettestable_data_;
 	GetSignificantData* getsignificant_data_;
 
+	log_.trace_.Init(MPI_COMM_WORLD,
+			FLAGS_trace.empty() ? 0ll : (long long int) FLAGS_trace_size);
+	log_.telemetry_.Init(MPI_COMM_WORLD, FLAGS_telemetry_interval,
+			FLAGS_telemetry_file);
+	if (FLAGS_perf && !log_.perf_.Open())
+		DBG(D(1) << "perf counters are not available" << std::endl
+		;);
 	log_.d_.search_start_time_ = timer_->Elapsed();
+	log_.StartPhase(0);
 	total_expand_num_ = 0ll;
 
 	// --------
@@ -625,7 +774,36 @@ void MP_LAMP::Search() {
 
 	lambda_ = 1;
 
-	{
+	// --restart: this rank's share of the checkpoint
+	Checkpoint * ckpt = NULL;
+	int restart_phase = 0;
+	if (FLAGS_restart) {
+		ckpt = new Checkpoint();
+		if (!ckpt->Load(FLAGS_checkpoint_prefix, mpi_data_.mpiRank_,
+				mpi_data_.nTotalProc_) || ckpt->lambda_max_ != lambda_max_) {
+			printf("cannot restart from checkpoint %s\n",
+					FLAGS_checkpoint_prefix.c_str());
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		restart_phase = ckpt->phase_;
+		if (mpi_data_.mpiRank_ == 0)
+			printf("# restart: phase=%d lambda=%d\n", restart_phase,
+					ckpt->lambda_);
+	}
+
+	// --phase1_load: phase 1 of an earlier run on the same item file
+	ClosedSetFile * stored = NULL;
+	int stored_lambda = -1;
+	if (!FLAGS_phase1_load.empty() && restart_phase == 0) {
+		stored = new ClosedSetFile();
+		stored_lambda = LoadClosedSets(stored);
+		if (stored_lambda < 0) {
+			delete stored;
+			stored = NULL;
+		}
+	}
+
+	if (restart_phase == 0 && stored == NULL) {
 		// TODO: This should be a part of PreProcessRootNode method.
 		// push root state to stack
 		int * root_itemset;
@@ -639,7 +817,35 @@ void MP_LAMP::Search() {
 			accum_recv_); // The name Phase1 is already so nonsense...
 
 	// TODO: this should be a part of ::GetMinimalSupport.
-	psearch->PreProcessRootNode(getminsup_data_);
+	if (stored != NULL) {
+		psearch->LoadCandidates(getminsup_data_, stored->sets_);
+		for (int l = 0; l <= lambda_max_; l++) {
+			accum_array_[l] = stored->accum_[l];
+			accum_recv_[l] = 0ll;
+		}
+		delete stored;
+	} else if (restart_phase == 0)
+		psearch->PreProcessRootNode(getminsup_data_);
+	else {
+		node_stack_->Clear();
+		if (!ckpt->node_.empty()
+				&& !node_stack_->MergeStack(&(ckpt->node_[0]),
+						ckpt->node_.size())) {
+			printf("node stack is too small for the checkpoint\n");
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		psearch->RestoreCheckpoint(*ckpt, getminsup_data_);
+		if (restart_phase == 1) {
+			getminsup_data_->lambda_ = ckpt->lambda_;
+			// like PreProcessRootNode: the reduced counts at rank 0, or at
+			// all ranks with --dtd_engine=1
+			bool has_accum = (mpi_data_.mpiRank_ == 0 || FLAGS_dtd_engine == 1);
+			for (int l = 0; l <= lambda_max_; l++) {
+				accum_array_[l] = has_accum ? ckpt->accum_[l] : 0ll;
+				accum_recv_[l] = 0ll;
+			}
+		}
+	}
 	{
 		if (mpi_data_.mpiRank_ == 0 && FLAGS_show_progress) {
 			std::cout << "# " << "preprocess end\n";
@@ -675,6 +881,7 @@ void MP_LAMP::Search() {
 	// prepare phase 1
 	// TODO: phase 1 should be started when PreProcessRootNode started.
 	phase_ = 1;
+	log_.StartPhase(1);
 	log_.StartPeriodicLog();
 
 	{
@@ -709,11 +916,18 @@ void MP_LAMP::Search() {
 						<< (timer_->Elapsed() - log_.d_.search_start_time_)
 								/ GIGA << std::endl
 				;);
-		psearch->GetMinimalSupport(getminsup_data_);
+		if (stored_lambda >= 0)
+			getminsup_data_->lambda_ = stored_lambda;
+		else if (restart_phase <= 1)
+			psearch->GetMinimalSupport(getminsup_data_);
+		else
+			getminsup_data_->lambda_ = ckpt->lambda_ + 1; // decremented below
 //		GetMinimalSupport(mpi_data_, treesearch_data_, getminsup_data_);
 		lambda_max_ = getminsup_data_->lambda_max_;
 		lambda_ = getminsup_data_->lambda_;
 		assert(cs_thr_ == getminsup_data_->cs_thr_);
+		log_.d_.phase1_end_time_ = timer_->Elapsed()
+				- log_.d_.search_start_time_;
 
 		// todo: reduce expand_num_
 		if (mpi_data_.mpiRank_ == 0 && FLAGS_show_progress) {
@@ -745,14 +959,24 @@ void MP_LAMP::Search() {
 	// --------
 	// prepare phase 2
 	phase_ = 2;
+	log_.StartPhase(2);
 	CheckPoint();
 
 	lambda_--;
 	CallBcast(&lambda_, 1, MPI_INT); // Rank-0 process broadcasts its lambda to all the other processes
 	final_support_ = lambda_;
 
+	if (!FLAGS_phase1_save.empty())
+		SaveClosedSets(psearch);
+
 	if (!FLAGS_second_phase) {
+		if (ckpt)
+			delete ckpt;
 		log_.d_.search_finish_time_ = timer_->Elapsed();
+		log_.FinishPhase();
+		StopTelemetry(1);
+		WriteTrace();
+		LogStacks();
 		log_.GatherLog(mpi_data_.nTotalProc_);
 		DBG(D(1) << "log" << std::endl
 		;);
@@ -766,7 +990,10 @@ void MP_LAMP::Search() {
 	expand_num_ = 0ll;
 	closed_set_num_ = 0ll;
 
-	{
+	if (psearch->Fused()) {
+		// --fused: phase 1 kept the closed sets, no enumeration
+		node_stack_->Clear();
+	} else if (restart_phase != 2) {
 		// push root state to stack
 		int * root_itemset;
 		node_stack_->Clear();
@@ -774,12 +1001,33 @@ void MP_LAMP::Search() {
 		root_itemset = node_stack_->Top();
 		node_stack_->SetSup(root_itemset, lambda_max_);
 		node_stack_->PushPostNoSort();
+	} else { // node_stack_ is restored. testable itemsets found so far
+		if (freq_stack_->UsedCapacity() + (long long int) ckpt->freq_.size()
+				> freq_stack_->TotalCapacity()) {
+			printf("freq stack is too small for the checkpoint\n");
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		// as RecordTestable. the stack may spill, no NextItemset
+		std::size_t i = 0;
+		for (std::size_t k = 0; k < ckpt->freq_.size();
+				k += VariableLengthItemsetStack::ITM
+						+ VariableLengthItemsetStack::GetItemNum(
+								&(ckpt->freq_[k]))) {
+			freq_stack_->PushPre();
+			freq_stack_->CopyItem(&(ckpt->freq_[k]), freq_stack_->Top());
+			freq_stack_->PushPostNoSort();
+			freq_map_.Push(ckpt->pval_[i++], freq_stack_->Top());
+		}
 	}
 
 	double int_sig_lev = 0.0;
-	if (mpi_data_.mpiRank_ == 0) {
+	if (restart_phase == 2)
+		int_sig_lev = ckpt->sig_level_;
+	else if (mpi_data_.mpiRank_ == 0) {
 		int_sig_lev = GetInterimSigLevel(lambda_);
 	}
+	if (ckpt)
+		delete ckpt;
 	// todo: reduce expand_num_
 
 	{
@@ -808,13 +1056,22 @@ void MP_LAMP::Search() {
 		gettestable_data_ = new GetTestableData(lambda_, freq_stack_,
 				&freq_map_, sig_level_);
 
-		psearch->GetTestablePatterns(gettestable_data_);
+		if (psearch->Fused())
+			psearch->FilterTestablePatterns(gettestable_data_);
+		else
+			psearch->GetTestablePatterns(gettestable_data_);
 //		GetTestablePatterns(mpi_data_, treesearch_data_, gettestable_data_);
 //		freq_stack_ = gettestable_data_->freq_stack_; // No need: two are the same.
 		//		freq_map_ = gettestable_data_->freq_map_; // No need?
 		sig_level_ = gettestable_data_->sig_level_;
 		assert(freq_stack_ == gettestable_data_->freq_stack_);
-		assert(freq_map_.size() == gettestable_data_->freq_map_->size());
+		assert(freq_map_.Size() == gettestable_data_->freq_map_->Size());
+		closed_set_num_ = psearch->ClosedSetNum();
+		log_.d_.freq_num_ = freq_map_.Size();
+		log_.d_.freq_index_bytes_ = freq_map_.Bytes();
+		log_.d_.freq_stack_bytes_ = freq_stack_->UsedCapacity()
+				* (long long int) sizeof(int);
+		LogStacks();
 	}
 
 	DBG(D(1) << "closed_set_num=" << closed_set_num_ << std::endl
@@ -850,6 +1107,9 @@ void MP_LAMP::Search() {
 
 	if (!FLAGS_third_phase) {
 		log_.d_.search_finish_time_ = timer_->Elapsed();
+		log_.FinishPhase();
+		StopTelemetry(2);
+		WriteTrace();
 		log_.GatherLog(mpi_data_.nTotalProc_);
 		DBG(D(1) << "log" << std::endl
 		;);
@@ -862,13 +1122,16 @@ void MP_LAMP::Search() {
 
 	// prepare 3rd phase
 	phase_ = 3;
+	log_.StartPhase(3);
 	//ClearTasks();
 	CheckPoint(); // needed for reseting dtd_.terminated_
 
 	if (node_stack_)
 		delete node_stack_;
 	node_stack_ = NULL;
-	significant_stack_ = new VariableLengthItemsetStack(FLAGS_sig_max);
+	significant_stack_ = new VariableLengthItemsetStack(
+			VariableLengthItemsetStack::SEGMENTED, FLAGS_stack_segment,
+			FLAGS_sig_max, d_->NuItems());
 	// significant_stack_ = new VariableLengthItemsetStack(FLAGS_sig_max, lambda_max_);
 
 	final_sig_level_ = FLAGS_a / final_closed_set_num_;
@@ -878,7 +1141,10 @@ void MP_LAMP::Search() {
 		getsignificant_data_ = new GetSignificantData(freq_stack_, &freq_map_,
 				final_sig_level_, significant_stack_, &significant_set_);
 //		GetSignificantPatterns(mpi_data_, getsignificant_data_);
-		psearch->GetSignificantPatterns(getsignificant_data_);
+		if (FLAGS_result_file.empty())
+			psearch->GetSignificantPatterns(getsignificant_data_);
+		else
+			WriteSignificantSets();
 		// TODO: put back to global variables.
 	}
 
@@ -886,9 +1152,12 @@ void MP_LAMP::Search() {
 	// collect itemset
 	//   can reuse the other stack (needs to compute pval again)
 	//   or prepare simpler data structure
-	if (mpi_data_.mpiRank_ == 0)
+	if (mpi_data_.mpiRank_ == 0 && FLAGS_result_file.empty())
 		SortSignificantSets();
 	log_.d_.search_finish_time_ = timer_->Elapsed();
+	log_.FinishPhase();
+	StopTelemetry(3);
+	WriteTrace();
 	MPI_Barrier( MPI_COMM_WORLD);
 
 	{
@@ -954,6 +1223,165 @@ void MP_LAMP::SortSignificantSets() {
 	}
 }
 
+void MP_LAMP::WriteTrace() {
+	if (FLAGS_trace.empty())
+		return;
+	if (!log_.trace_.Write(FLAGS_trace)) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("cannot write %s\n", FLAGS_trace.c_str());
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+}
+
+void MP_LAMP::StopTelemetry(int phase) {
+	std::vector<long long int> values(Telemetry::kFieldNum, 0ll);
+	if (mpi_data_.mpiRank_ == 0) {
+		values[Telemetry::PHASE] = phase;
+		values[Telemetry::LAMBDA] = final_support_;
+	}
+	if (phase == 1) { // reduced counts
+		if (mpi_data_.mpiRank_ == 0)
+			values[Telemetry::CLOSED_SETS] = accum_array_[final_support_];
+	} else
+		values[Telemetry::CLOSED_SETS] = closed_set_num_;
+	values[Telemetry::NODES] = log_.d_.process_node_num_;
+	values[Telemetry::IDLE] = 1; // stack and remaining work are 0
+	values[Telemetry::STEALS] = log_.d_.steal_num_
+			+ log_.d_.lifeline_steal_num_;
+	values[Telemetry::REJECTS] = log_.d_.steal_reject_num_;
+	log_.telemetry_.Stop(&(values[0]));
+}
+
+void MP_LAMP::WriteSignificantSets() {
+	long long int start_time = timer_->Elapsed();
+	ResultFile result(MPI_COMM_WORLD);
+	// support computed as in SortSignificantSets
+	std::size_t nu_sig = freq_map_.Partition(final_sig_level_);
+	for (std::size_t k = 0; k < nu_sig; k++) {
+		const int * set = freq_map_.Itemset(k);
+		bsh_->Set(sup_buf_);
+		int n = significant_stack_->GetItemNum(set);
+		for (int i = 0; i < n; i++)
+			bsh_->And(d_->NthData(significant_stack_->GetNthItem(set, i)),
+					sup_buf_);
+		int sup_num = bsh_->Count(sup_buf_);
+		int pos_sup_num = bsh_->AndCount(d_->PosNeg(), sup_buf_);
+		assert(sup_num == significant_stack_->GetSup(set));
+		result.Add(d_->PVal(sup_num, pos_sup_num), pos_sup_num, set);
+	}
+	result.Exchange();
+
+	long long int local_num = result.Size();
+	MPI_Allreduce(&local_num, &written_sig_num_, 1, MPI_LONG_LONG_INT,
+			MPI_SUM, MPI_COMM_WORLD);
+	CallBcast(&final_closed_set_num_, 1, MPI_LONG_LONG_INT);
+
+	// item names are read by rank 0 only
+	const std::vector<std::string> * item_names = d_->ItemNames();
+	std::vector<std::string> names_buf;
+	std::string packed;
+	if (mpi_data_.mpiRank_ == 0 && item_names != NULL)
+		for (std::size_t i = 0; i < item_names->size(); i++)
+			packed.append((*item_names)[i]).push_back('\0');
+	long long int packed_size = packed.size();
+	CallBcast(&packed_size, 1, MPI_LONG_LONG_INT);
+	if (packed_size > 0) {
+		packed.resize(packed_size);
+		CallBcast(&(packed[0]), packed_size, MPI_CHAR);
+		if (mpi_data_.mpiRank_ != 0) {
+			for (std::size_t p = 0; p < packed.size();
+					p = packed.find('\0', p) + 1)
+				names_buf.push_back(std::string(packed.c_str() + p));
+			item_names = &names_buf;
+		}
+	}
+
+	std::stringstream header;
+	PrintSignificantHeader(header, written_sig_num_);
+	if (!result.Write(FLAGS_result_file, header.str(), final_closed_set_num_,
+			item_names)) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("cannot write %s\n", FLAGS_result_file.c_str());
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	log_.d_.result_num_ = local_num;
+	log_.d_.result_exchange_size_ = result.ExchangeSize();
+	log_.d_.result_bytes_ = result.WriteBytes();
+	log_.d_.result_time_ = timer_->Elapsed() - start_time;
+}
+
+unsigned long long int MP_LAMP::ItemHash() const {
+	unsigned long long int h = ClosedSetFile::kHashInit;
+	for (int i = 0; i < d_->NuItems(); i++)
+		h = ClosedSetFile::Hash(d_->NthData(i), bsh_->NuBlocks(), h);
+	return h;
+}
+
+void MP_LAMP::SaveClosedSets(ParallelPatternMining * psearch) {
+	ClosedSetFile file;
+	int ok = psearch->CopyCandidates(final_support_, &file.sets_) ? 1 : 0;
+	int all_ok = 0;
+	MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	if (!all_ok) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("# closed sets exceeded --fused_max, %s is not saved\n",
+					FLAGS_phase1_save.c_str());
+		return;
+	}
+	file.nu_proc_ = mpi_data_.nTotalProc_;
+	file.min_sup_ = final_support_;
+	file.lambda_max_ = lambda_max_;
+	file.nu_items_ = d_->NuItems();
+	file.nu_trans_ = d_->NuTransaction();
+	file.item_hash_ = ItemHash();
+	// the reduced counts are at rank 0
+	file.accum_.assign(accum_array_, accum_array_ + lambda_max_ + 1);
+	CallBcast(&(file.accum_[0]), lambda_max_ + 1, MPI_LONG_LONG_INT);
+
+	ok = file.Write(
+			ClosedSetFile::FileName(FLAGS_phase1_save, mpi_data_.mpiRank_),
+			mpi_data_.mpiRank_) ? 1 : 0;
+	MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	if (!all_ok) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("cannot write %s\n", FLAGS_phase1_save.c_str());
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+}
+
+int MP_LAMP::LoadClosedSets(ClosedSetFile * stored) {
+	int ok = (stored->Load(FLAGS_phase1_load, mpi_data_.mpiRank_,
+			mpi_data_.nTotalProc_) && stored->lambda_max_ == lambda_max_
+			&& stored->nu_items_ == d_->NuItems()
+			&& stored->nu_trans_ == d_->NuTransaction()
+			&& stored->item_hash_ == ItemHash()) ? 1 : 0;
+	int all_ok = 0;
+	MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	if (!all_ok) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("cannot load %s for this item file\n",
+					FLAGS_phase1_load.c_str());
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+
+	// as NextLambdaThr. accum is exact for l >= min_sup, so the lambda is
+	// that of phase 1 if min. sup (lambda - 1) is not below min_sup
+	int si;
+	for (si = lambda_max_; si >= stored->min_sup_; si--)
+		if (stored->accum_[si] > cs_thr_[si])
+			break;
+	if (si < stored->min_sup_) {
+		if (mpi_data_.mpiRank_ == 0)
+			printf("# lower min. sup than %s, running phase 1\n",
+					FLAGS_phase1_load.c_str());
+		return -1;
+	}
+	if (mpi_data_.mpiRank_ == 0)
+		printf("# phase 1 from %s: lambda=%d\n", FLAGS_phase1_load.c_str(),
+				si + 1);
+	return si + 1;
+}
+
 // TODO: Ideally, this should also be hidden in other class.
 int MP_LAMP::CallBcast(void * buffer, int data_count, MPI_Datatype type) {
 	long long int start_time;
@@ -990,8 +1418,15 @@ std::ostream & MP_LAMP::PrintResults(std::ostream & out) const {
 		s << "\tcorrection factor=" << final_closed_set_num_;
 	s << std::endl;
 
-	if (FLAGS_third_phase)
+	if (FLAGS_third_phase && !FLAGS_result_file.empty()) {
+		s << "# number of significant patterns=" << written_sig_num_
+				<< std::endl;
+		s << "# significant patterns are in " << FLAGS_result_file
+				<< std::endl;
+	} else if (FLAGS_third_phase)
 		PrintSignificantSet(s);
+	if (!FLAGS_trace.empty())
+		s << "# timeline is in " << FLAGS_trace << std::endl;
 
 	out << s.str() << std::flush;
 	return out;
@@ -1000,10 +1435,7 @@ std::ostream & MP_LAMP::PrintResults(std::ostream & out) const {
 std::ostream & MP_LAMP::PrintSignificantSet(std::ostream & out) const {
 	std::stringstream s;
 
-	s << "# number of significant patterns=" << significant_set_.size()
-			<< std::endl;
-	s
-			<< "# pval (raw)    pval (corr)         freq     pos        # items items\n";
+	PrintSignificantHeader(s, significant_set_.size());
 	for (std::set<SignificantSetResult, sigset_compare>::const_iterator it =
 			significant_set_.begin(); it != significant_set_.end(); ++it) {
 
@@ -1026,6 +1458,14 @@ std::ostream & MP_LAMP::PrintSignificantSet(std::ostream & out) const {
 	return out;
 }
 
+std::ostream & MP_LAMP::PrintSignificantHeader(std::ostream & out,
+		long long int num) const {
+	out << "# number of significant patterns=" << num << std::endl;
+	out
+			<< "# pval (raw)    pval (corr)         freq     pos        # items items\n";
+	return out;
+}
+
 //==============================================================================
 
 std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
@@ -1048,6 +1488,20 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 
 	s << std::setprecision(3);
 
+	// wall: rank 0, max, avg. cpu: rank 0, total, avg
+	for (int p = 0; p < Log::kPhaseNum; p++) {
+		s << "# phase" << p << "_wall_time  =" << std::setw(16)
+				<< log_.d_.phase_wall_time_[p] / MEGA << std::setw(16)
+				<< log_.a_.phase_wall_time_[p] / MEGA // max
+				<< std::setw(16) << "---" << "(ms)" << std::endl;
+		s << "# phase" << p << "_cpu_time   =" << std::setw(16)
+				<< log_.d_.phase_cpu_time_[p] / MEGA << std::setw(16)
+				<< log_.a_.phase_cpu_time_[p] / MEGA // sum
+				<< std::setw(16)
+				<< log_.a_.phase_cpu_time_[p] / MEGA / mpi_data_.nTotalProc_ // avg
+				<< "(ms)" << std::endl;
+	}
+
 	s << "# process_node_num  =" << std::setw(16) << log_.d_.process_node_num_
 			<< std::setw(16) << log_.a_.process_node_num_
 			// sum
@@ -1074,6 +1528,23 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< log_.a_.idle_time_ / MEGA / mpi_data_.nTotalProc_ // avg
 			<< "(ms)" << std::endl;
 
+	if (log_.a_.granularity_update_num_ > 0) {
+		s << "# granularity_upd   =" << std::setw(16)
+				<< log_.d_.granularity_update_num_ << std::setw(16)
+				<< log_.a_.granularity_update_num_ // sum
+				<< std::endl;
+		s << "# granularity       =" << std::setw(16)
+				<< log_.a_.granularity_min_ / KILO // min
+				<< std::setw(16) << log_.a_.granularity_max_ / KILO // max
+				<< std::setw(16)
+				<< log_.a_.granularity_sum_ / KILO
+						/ log_.a_.granularity_update_num_ // avg
+				<< "(us) min max avg" << std::endl;
+	}
+
+	if (FLAGS_perf)
+		PrintPerfLog(s);
+
 	s << "# pval_table_time   =" << std::setw(16)
 			<< log_.d_.pval_table_time_ / MEGA << std::setw(16)
 			<< log_.a_.pval_table_time_ / MEGA // sum
@@ -1081,6 +1552,20 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< log_.a_.pval_table_time_ / MEGA / mpi_data_.nTotalProc_ // avg
 			<< "(ms)" << std::endl;
 
+	if (log_.a_.progress_msg_num_ > 0) {
+		s << "# progress_msg_num  =" << std::setw(16)
+				<< log_.d_.progress_msg_num_ << std::setw(16)
+				<< log_.a_.progress_msg_num_ // sum
+				<< std::endl;
+		s << "# progress_wait     =" << std::setw(16)
+				<< log_.a_.progress_wait_time_ / KILO
+						/ log_.a_.progress_msg_num_ // avg
+				<< std::setw(16) << log_.a_.progress_wait_time_max_ / KILO // max
+				<< std::setw(16)
+				<< log_.a_.progress_request_wait_time_max_ / KILO // max of steal requests
+				<< "(us) avg max max(request)" << std::endl;
+	}
+
 	s << "# probe_num         =" << std::setw(16) << log_.d_.probe_num_
 			<< std::setw(16) << log_.a_.probe_num_ // sum
 			<< std::setw(16) << log_.a_.probe_num_ / mpi_data_.nTotalProc_ // avg
@@ -1111,7 +1596,7 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16) << log_.a_.iprobe_time_ / KILO// sum
 			<< std::setw(16) << log_.a_.iprobe_time_ / KILO / mpi_data_.nTotalProc_// avg
 			<< "(us)" << std::endl; s << "# iprobe_time_max   =" << std::setw(16) << log_.d_.iprobe_time_max_ / KILO << std::setw(16) << log_.a_.iprobe_time_max_ / KILO// max
-			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_time_ / log_.d_.iprobe_num_ / KILO// rank 0
+			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_time_ / std::max(log_.d_.iprobe_num_, 1ll) / KILO// rank 0
 			<< std::setw(16) << log_.a_.iprobe_time_ / log_.a_.iprobe_num_ / KILO// global
 			<< "(us)" << std::endl;);
 
@@ -1124,7 +1609,7 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16) << log_.a_.iprobe_succ_time_ / KILO// sum
 			<< std::setw(16) << log_.a_.iprobe_succ_time_ / KILO / mpi_data_.nTotalProc_// avg
 			<< "(us)" << std::endl; s << "# iprobe_succ_time_m=" << std::setw(16) << log_.d_.iprobe_succ_time_max_ / KILO << std::setw(16) << log_.a_.iprobe_succ_time_max_ / KILO// max
-			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_succ_time_ / log_.d_.iprobe_succ_num_ / KILO// rank 0
+			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_succ_time_ / std::max(log_.d_.iprobe_succ_num_, 1ll) / KILO// rank 0
 			<< std::setw(16) << log_.a_.iprobe_succ_time_ / log_.a_.iprobe_succ_num_ / KILO// global
 			<< "(us)" << std::endl;);
 
@@ -1137,7 +1622,7 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16) << log_.a_.iprobe_fail_time_ / KILO// sum
 			<< std::setw(16) << log_.a_.iprobe_fail_time_ / KILO / mpi_data_.nTotalProc_// avg
 			<< "(us)" << std::endl; s << "# iprobe_fail_time_m=" << std::setw(16) << log_.d_.iprobe_fail_time_max_ / KILO << std::setw(16) << log_.a_.iprobe_fail_time_max_ / KILO// max
-			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_fail_time_ / log_.d_.iprobe_fail_num_ / KILO// rank 0
+			<< "(us)" << std::endl; s << "# us / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_fail_time_ / std::max(log_.d_.iprobe_fail_num_, 1ll) / KILO// rank 0
 			<< std::setw(16) << log_.a_.iprobe_fail_time_ / log_.a_.iprobe_fail_num_ / KILO// global
 			<< "(us)" << std::endl;);
 
@@ -1218,6 +1703,75 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< log_.d_.dtd_accum_phase_num_ << std::endl;
 	s << "# dtd_ac_ph_per_sec_=" << std::setw(16)
 			<< log_.d_.dtd_accum_phase_per_sec_ << std::endl;
+	if (log_.a_.dtd_accum_reply_num_ > 0) {
+		s << "# dtd_accum_reply   =" << std::setw(16)
+				<< log_.a_.dtd_accum_reply_num_ // sum
+				<< std::setw(16) << log_.a_.dtd_accum_sparse_num_ // sparse
+				<< "  (sum sparse)" << std::endl;
+		s << "# dtd_accum_bytes   =" << std::setw(16)
+				<< log_.a_.dtd_accum_reply_bytes_ // sum
+				<< std::setw(16)
+				<< log_.a_.dtd_accum_reply_bytes_
+						/ log_.a_.dtd_accum_reply_num_ // per reply
+				<< std::setw(16) << log_.a_.dtd_accum_reply_bytes_max_ // max
+				<< "  (sum per_reply max)" << std::endl;
+	}
+	if (log_.a_.dtd_coll_round_num_ > 0) {
+		s << "# dtd_coll_rounds   =" << std::setw(16)
+				<< log_.d_.dtd_coll_round_num_ << std::setw(16)
+				<< log_.a_.dtd_coll_test_num_ / mpi_data_.nTotalProc_ // avg
+				<< "  (rounds, tests per rank)" << std::endl;
+		s << "# dtd_coll_time     =" << std::setw(16)
+				<< log_.a_.dtd_coll_round_time_ / KILO
+						/ log_.a_.dtd_coll_round_num_ // per round
+				<< std::setw(16) << log_.a_.dtd_coll_round_time_max_ / KILO // max
+				<< std::setw(16)
+				<< log_.a_.dtd_coll_test_time_ / GIGA / mpi_data_.nTotalProc_ // avg
+				<< "  (us per round, us max, s test avg)" << std::endl;
+	}
+	s << "# lambda final      =" << std::setw(16) << final_support_ + 1
+			<< std::setw(16) << log_.a_.lambda_final_time_ / MEGA // max
+			<< std::setw(16) << log_.a_.phase1_end_time_ / MEGA // max
+			<< std::setw(16) << log_.a_.lambda_update_num_ // sum
+			<< "  (lambda, ms to final lambda, ms 1st phase, updates)"
+			<< std::endl;
+	if (log_.a_.lambda_probe_num_ > 0)
+		s << "# lambda probe      =" << std::setw(16) << log_.a_.lambda_probe_
+				<< std::setw(16) << log_.a_.lambda_probe_num_ // sum
+				<< std::setw(16) << log_.a_.lambda_probe_time_ / MEGA // max
+				<< "  (lambda bound, closed sets expanded, ms max)"
+				<< std::endl;
+	if (log_.d_.checkpoint_num_ > 0) {
+		s << "# checkpoint        =" << std::setw(16)
+				<< log_.d_.checkpoint_num_ << std::setw(16)
+				<< log_.d_.checkpoint_round_num_ // rounds until quiescent
+				<< std::setw(16) << log_.a_.checkpoint_time_ / GIGA // max
+				<< std::setw(16) << log_.a_.checkpoint_bytes_ // sum
+				<< "  (num, rounds, s max, bytes)" << std::endl;
+	}
+	if (log_.a_.freq_num_ > 0)
+		s << "# freq store        =" << std::setw(16) << log_.a_.freq_num_
+				<< std::setw(16) << log_.a_.freq_index_bytes_
+				<< std::setw(16) << log_.a_.freq_stack_bytes_
+				<< "  (sets, index bytes, stack bytes)" << std::endl;
+	if (!FLAGS_result_file.empty()) {
+		s << "# result file       =" << std::setw(16) << log_.a_.result_num_
+				<< std::setw(16) << log_.a_.result_num_max_ << std::setw(16)
+				<< log_.a_.result_exchange_size_ * sizeof(int)
+				<< std::setw(16) << log_.a_.result_bytes_ << std::setw(16)
+				<< log_.a_.result_time_ / GIGA
+				<< "  (sets, sets max, bytes sent, bytes written, s max)"
+				<< std::endl;
+	}
+	if (log_.a_.fused_store_peak_ > 0) {
+		s << "# fused store       =" << std::setw(16)
+				<< log_.a_.fused_store_peak_ // max bytes per process
+				<< std::setw(16) << log_.a_.fused_compact_num_
+				<< std::setw(16) << log_.d_.fused_fallback_
+				<< std::setw(16) << log_.a_.fused_filter_time_ / GIGA
+				<< "  (bytes max, compactions, fallback, s filter)"
+				<< std::endl;
+	}
 
 	// s << "# dtd_request_num   ="
 	//   << std::setw(16) << log_.d_.dtd_request_num_
@@ -1255,6 +1809,32 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16) << log_.a_.nodes_received_ // sum
 			<< std::setw(16) << log_.a_.nodes_received_ / mpi_data_.nTotalProc_ // avg
 			<< std::endl;
+	s << "# steal_reject_num  =" << std::setw(16) << log_.d_.steal_reject_num_
+			<< std::setw(16) << log_.a_.steal_reject_num_ // sum
+			<< std::setw(16)
+			<< log_.a_.steal_reject_num_ / mpi_data_.nTotalProc_ // avg
+			<< std::endl;
+
+	if (log_.a_.rma_claim_num_ > 0) {
+		s << "# rma_deposit_num   =" << std::setw(16)
+				<< log_.d_.rma_deposit_num_ << std::setw(16)
+				<< log_.a_.rma_deposit_num_ // sum
+				<< std::setw(16) << log_.a_.rma_deposit_fail_num_ // kept
+				<< std::setw(16) << log_.a_.rma_reclaim_num_ // taken back
+				<< "  (sum fail reclaim)" << std::endl;
+		s << "# rma_steal_fail    =" << std::setw(16)
+				<< log_.d_.rma_steal_fail_num_ << std::setw(16)
+				<< log_.a_.rma_steal_fail_num_ // sum
+				<< std::setw(16)
+				<< log_.a_.rma_steal_fail_num_ / mpi_data_.nTotalProc_ // avg
+				<< std::endl;
+		s << "# rma_claim_time    =" << std::setw(16)
+				<< log_.d_.rma_claim_time_ / GIGA << std::setw(16)
+				<< log_.a_.rma_claim_time_ / GIGA / mpi_data_.nTotalProc_ // avg
+				<< std::setw(16)
+				<< log_.a_.rma_claim_time_ / KILO / log_.a_.rma_claim_num_ // per claim
+				<< "  (s avg, us per claim)" << std::endl;
+	}
 
 	s << "# lfl_given_num     =" << std::setw(16) << log_.d_.lifeline_given_num_
 			<< std::setw(16) << log_.a_.lifeline_given_num_
@@ -1277,6 +1857,23 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 			<< std::setw(16) << log_.a_.nodes_given_ // sum
 			<< std::setw(16) << log_.a_.nodes_given_ / mpi_data_.nTotalProc_ // avg
 			<< std::endl;
+	s << "# give_nodes_max    =" << std::setw(16) << log_.d_.give_nodes_max_
+			<< std::setw(16) << log_.a_.give_nodes_max_ // global
+			<< std::endl;
+	s << "# give_nodes_hist   =";
+	for (int i = 0; i < Log::kGiveHistSize; i++)
+		if (log_.a_.give_nodes_hist_[i] > 0)
+			s << " [" << (1ll << i) << "-" << ((1ll << (i + 1)) - 1) << "]:"
+					<< log_.a_.give_nodes_hist_[i];
+	s << std::endl;
+	s << "# thief_busy_num    =" << std::setw(16) << log_.d_.give_busy_num_
+			<< std::setw(16) << log_.a_.give_busy_num_ // sum
+			<< std::endl;
+	if (log_.a_.give_busy_num_ > 0)
+		s << "# thief_busy_time   =" << std::setw(16)
+				<< log_.a_.give_busy_time_ / KILO / log_.a_.give_busy_num_ // avg
+				<< std::setw(16) << log_.a_.give_busy_time_max_ / KILO // max
+				<< "(us) avg max" << std::endl;
 
 	s << "# node_stack_max_itm=" << std::setw(16) << log_.d_.node_stack_max_itm_ // rank 0
 			<< std::setw(16) << log_.a_.node_stack_max_itm_ // global
@@ -1291,6 +1888,11 @@ std::ostream & MP_LAMP::PrintAggrLog(std::ostream & out) {
 	s << "# give_stack_max_cap=" << std::setw(16) << log_.d_.give_stack_max_cap_ // rank 0
 			<< std::setw(16) << log_.a_.give_stack_max_cap_ // global
 			<< std::endl;
+	s << "# stack_peak_bytes  =" << std::setw(16)
+			<< log_.a_.node_stack_peak_bytes_ // max
+			<< std::setw(16) << log_.a_.freq_stack_peak_bytes_ // max
+			<< std::setw(16) << log_.a_.freq_stack_spill_bytes_ // sum
+			<< "  (node max, freq max, freq spilled)" << std::endl;
 
 	s << "# cleared_tasks_    =" << std::setw(16) << log_.d_.cleared_tasks_
 			<< std::setw(16) << log_.a_.cleared_tasks_ // sum
@@ -1313,14 +1915,17 @@ std::ostream & MP_LAMP::PrintPLog(std::ostream & out) {
 	std::stringstream s;
 
 	s << "# periodic log of node stack capacity" << std::endl;
-	s << "# phase nano_sec seconds lambda capacity" << std::endl;
+	s << "# phase nano_sec seconds lambda capacity granularity accum_bytes"
+			<< std::endl;
 	for (std::size_t i = 0; i < log_.plog_.size(); i++) {
 		s << "# " << std::setw(1) << log_.plog_[i].phase_ << std::setw(12)
 
 		<< log_.plog_[i].seconds_ << std::setw(6)
 				<< (int) (log_.plog_[i].seconds_ / 1000000000) << std::setw(5)
 				<< log_.plog_[i].lambda_ << " " << std::setw(13)
-				<< log_.plog_[i].capacity_ << std::endl;
+				<< log_.plog_[i].capacity_ << " " << std::setw(13)
+				<< log_.plog_[i].granularity_ << " " << std::setw(13)
+				<< log_.plog_[i].accum_bytes_ << std::endl;
 	}
 
 	out << s.str() << std::flush;
@@ -1331,11 +1936,14 @@ std::ostream & MP_LAMP::PrintAggrPLog(std::ostream & out) {
 	std::stringstream s;
 
 	s << "# periodic log of node stack capacity" << std::endl;
-	s << "# phase nano_sec seconds lambda min max mean sd" << std::endl;
+	s << "# phase nano_sec seconds lambda min max mean sd granularity_mean"
+			<< " accum_bytes_sum" << std::endl;
 	for (int si = 0; si < log_.sec_max_; si++) {
 		long long int sum = 0ll;
 		long long int max = -1;
 		long long int min = std::numeric_limits<long long int>::max();
+		long long int granularity_sum = 0ll;
+		long long int accum_bytes_sum = 0ll;
 
 		for (int p = 0; p < mpi_data_.nTotalProc_; p++) {
 			long long int cap =
@@ -1343,6 +1951,10 @@ std::ostream & MP_LAMP::PrintAggrPLog(std::ostream & out) {
 			sum += cap;
 			max = std::max(max, cap);
 			min = std::min(min, cap);
+			granularity_sum +=
+					log_.plog_gather_buf_[p * log_.sec_max_ + si].granularity_;
+			accum_bytes_sum +=
+					log_.plog_gather_buf_[p * log_.sec_max_ + si].accum_bytes_;
 		}
 		double mean = sum / (double) (mpi_data_.nTotalProc_);
 		double sq_diff_sum = 0.0;
@@ -1362,13 +1974,44 @@ std::ostream & MP_LAMP::PrintAggrPLog(std::ostream & out) {
 				<< std::setw(5) << log_.plog_buf_[si].lambda_ << " "
 				<< std::setw(13) << min << " " << std::setw(13) << max
 				<< std::setprecision(3) << " " << std::setw(17) << mean << " "
-				<< std::setw(13) << sd << std::endl;
+				<< std::setw(13) << sd << " " << std::setw(13)
+				<< granularity_sum / (double) (mpi_data_.nTotalProc_) << " "
+				<< std::setw(13) << accum_bytes_sum << std::endl;
 	}
 
 	out << s.str() << std::flush;
 	return out;
 }
 
+// sums over the ranks
+std::ostream & MP_LAMP::PrintPerfLog(std::ostream & out) const {
+	const long long int * e = log_.a_.perf_expand_;
+	if (log_.a_.perf_avail_ < mpi_data_.nTotalProc_)
+		out << "# perf counters     = available at " << log_.a_.perf_avail_
+				<< " of " << mpi_data_.nTotalProc_ << " ranks" << std::endl;
+	if (log_.a_.perf_avail_ == 0)
+		return out;
+
+	for (int p = 0; p < Log::kPhaseNum; p++) {
+		const long long int * v = log_.a_.perf_phase_[p];
+		out << "# perf_phase" << p << "       =" << std::setw(16)
+				<< v[PerfCounters::CYCLES] << std::setw(16)
+				<< v[PerfCounters::INSTRUCTIONS] << std::setw(16)
+				<< v[PerfCounters::LLC_MISSES]
+				<< "  (cycles, instructions, LLC misses)" << std::endl;
+	}
+	double nodes = std::max(log_.a_.process_node_num_, 1ll);
+	out << "# perf_per_node     =" << std::setw(16)
+			<< e[PerfCounters::CYCLES] / nodes << std::setw(16)
+			<< e[PerfCounters::INSTRUCTIONS] / nodes << std::setw(16)
+			<< e[PerfCounters::LLC_MISSES] * PerfCounters::kLineBytes / nodes
+			<< "  (cycles, instructions, LLC miss bytes)" << std::endl;
+	out << "# perf_expand_ipc   =" << std::setw(16)
+			<< (double) e[PerfCounters::INSTRUCTIONS]
+					/ std::max(e[PerfCounters::CYCLES], 1ll) << std::endl;
+	return out;
+}
+
 std::ostream & MP_LAMP::PrintLog(std::ostream & out) const {
 	std::stringstream s;
 
@@ -1384,6 +2027,12 @@ std::ostream & MP_LAMP::PrintLog(std::ostream & out) const {
 
 	s << std::setprecision(3);
 
+	for (int p = 0; p < Log::kPhaseNum; p++)
+		s << "# phase" << p << "_time       =" << std::setw(16)
+				<< log_.d_.phase_wall_time_[p] / MEGA << std::setw(16)
+				<< log_.d_.phase_cpu_time_[p] / MEGA << "(ms wall, ms cpu)"
+				<< std::endl;
+
 	s << "# process_node_num  =" << std::setw(16) << log_.d_.process_node_num_
 			<< std::endl;
 	s << "# process_node_time =" << std::setw(16)
@@ -1396,9 +2045,25 @@ std::ostream & MP_LAMP::PrintLog(std::ostream & out) const {
 	s << "# idle_time         =" << std::setw(16) << log_.d_.idle_time_ / MEGA
 			<< "(ms)" << std::endl;
 
+	if (log_.d_.granularity_update_num_ > 0)
+		s << "# granularity       =" << std::setw(16)
+				<< log_.d_.granularity_sum_ / KILO
+						/ log_.d_.granularity_update_num_ << "(us) avg"
+				<< std::endl;
+
 	s << "# pval_table_time   =" << std::setw(16)
 			<< log_.d_.pval_table_time_ / MEGA << "(ms)" << std::endl;
 
+	s << "# lambda_final_time =" << std::setw(16)
+			<< log_.d_.lambda_final_time_ / MEGA << std::setw(16)
+			<< log_.d_.phase1_end_time_ / MEGA << "(ms, ms 1st phase)"
+			<< std::endl;
+
+	s << "# freq_store        =" << std::setw(16) << log_.d_.freq_num_
+			<< std::setw(16) << log_.d_.freq_index_bytes_ << std::setw(16)
+			<< log_.d_.freq_stack_bytes_ << "  (sets, index bytes, stack bytes)"
+			<< std::endl;
+
 	s << "# probe_num         =" << std::setw(16) << log_.d_.probe_num_
 			<< std::endl;
 	s << "# probe_time        =" << std::setw(16) << log_.d_.probe_time_ / MEGA
@@ -1413,21 +2078,21 @@ std::ostream & MP_LAMP::PrintLog(std::ostream & out) const {
 			<< std::endl;
 	LOG(
 			s << "# iprobe_time       =" << std::setw(16) << log_.d_.iprobe_time_ / MEGA // rank 0
-			<< "(ms)" << std::endl; s << "# iprobe_time_max   =" << std::setw(16) << log_.d_.iprobe_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_time_ / log_.d_.iprobe_num_ / MEGA// rank 0
+			<< "(ms)" << std::endl; s << "# iprobe_time_max   =" << std::setw(16) << log_.d_.iprobe_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_time_ / std::max(log_.d_.iprobe_num_, 1ll) / MEGA// rank 0
 			<< "(ms)" << std::endl;);
 
 	s << "# iprobe_succ_num   =" << std::setw(16) << log_.d_.iprobe_succ_num_ // rank 0
 			<< std::endl;
 	LOG(
 			s << "# iprobe_succ_time  =" << std::setw(16) << log_.d_.iprobe_succ_time_ / MEGA // rank 0
-			<< "(ms)" << std::endl; s << "# iprobe_succ_time_m=" << std::setw(16) << log_.d_.iprobe_succ_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_succ_time_ / log_.d_.iprobe_succ_num_ / MEGA// rank 0
+			<< "(ms)" << std::endl; s << "# iprobe_succ_time_m=" << std::setw(16) << log_.d_.iprobe_succ_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_succ_time_ / std::max(log_.d_.iprobe_succ_num_, 1ll) / MEGA// rank 0
 			<< "(ms)" << std::endl;);
 
 	s << "# iprobe_fail_num   =" << std::setw(16) << log_.d_.iprobe_fail_num_ // rank 0
 			<< std::endl;
 	LOG(
 			s << "# iprobe_fail_time  =" << std::setw(16) << log_.d_.iprobe_fail_time_ / MEGA // rank 0
-			<< "(ms)" << std::endl; s << "# iprobe_fail_time_m=" << std::setw(16) << log_.d_.iprobe_fail_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_fail_time_ / log_.d_.iprobe_fail_num_ / MEGA// rank 0
+			<< "(ms)" << std::endl; s << "# iprobe_fail_time_m=" << std::setw(16) << log_.d_.iprobe_fail_time_max_ / MEGA << "(ms)" << std::endl; s << "# ms / (one iprobe) =" << std::setw(16) << log_.d_.iprobe_fail_time_ / std::max(log_.d_.iprobe_fail_num_, 1ll) / MEGA// rank 0
 			<< "(ms)" << std::endl;);
 
 	s << "# recv_num          =" << std::setw(16) << log_.d_.recv_num_
@@ -1518,6 +2183,11 @@ std::ostream & MP_LAMP::PrintLog(std::ostream & out) const {
 			<< std::endl;
 	s << "# give_stack_max_cap=" << std::setw(16) << log_.d_.give_stack_max_cap_
 			<< std::endl;
+	s << "# stack_peak_bytes  =" << std::setw(16)
+			<< log_.d_.node_stack_peak_bytes_ << std::setw(16)
+			<< log_.d_.freq_stack_peak_bytes_ << std::setw(16)
+			<< log_.d_.freq_stack_spill_bytes_
+			<< "  (node, freq, freq spilled)" << std::endl;
 
 	s << "# cleared_tasks_    =" << std::setw(16)
 			<< log_.d_.cleared_tasks_ / MEGA << std::endl;
@@ -48,6 +48,7 @@
 
 #include "random.h"
 #include "database.h"
+#include "binary_database.h"
 #include "lamp_graph.h"
 
 #include "MPI_Data.h"
@@ -60,6 +61,9 @@
 
 namespace lamp_search {
 
+class ParallelPatternMining;
+class ClosedSetFile;
+
 class MP_LAMP {
 public:
 	/**
@@ -95,6 +99,17 @@ public:
 	void InitDatabaseRoot(std::istream & is1, int posnum);
 	// other
 	void InitDatabaseSub(bool pos);
+	// all procs, from a file written by BinaryDatabase. the positives in
+	// the file are replaced with pos_file if given, or with the first
+	// posnum transactions if posnum > 0
+	void InitDatabaseBinary(const std::string & file_name,
+			const std::string & pos_file, int posnum);
+	// lambda_max_, thresholds, stacks and buffers, after d_
+	void InitSearch();
+	// node_stack_, give_stack_ and freq_stack_, after the database
+	void InitStacks();
+	// peak sizes of the stacks to log_
+	void LogStacks();
 
 	void Search();
 //	void MainLoop();
@@ -113,9 +128,13 @@ public:
 	std::ostream & PrintResults(std::ostream & out) const;
 	// std::ostream & PrintSignificantMap(std::ostream & out) const;
 	std::ostream & PrintSignificantSet(std::ostream & out) const;
+	std::ostream & PrintSignificantHeader(std::ostream & out,
+			long long int num) const;
 
 	std::ostream & PrintLog(std::ostream & out) const;
 	std::ostream & PrintAggrLog(std::ostream & out);
+	// --perf, part of PrintAggrLog
+	std::ostream & PrintPerfLog(std::ostream & out) const;
 
 	std::ostream & PrintPLog(std::ostream & out);
 	std::ostream & PrintAggrPLog(std::ostream & out);
@@ -147,6 +166,8 @@ private:
 	Database<uint64> * d_;
 //	LampGraph<uint64> * g_;
 	VariableBitsetHelper<uint64> * bsh_; // bitset helper
+	BinaryDatabase<uint64> * binary_; // NULL unless read by InitDatabaseBinary
+	uint64 * pos_array_; // read from --pos for a mapped binary_, not in d_
 //	}
 
 	Log log_;
@@ -343,7 +364,7 @@ private:
 	uint64 * sup_buf_, *child_sup_buf_;
 
 	VariableLengthItemsetStack * freq_stack_; // record freq itemsets
-	std::multimap<double, int *> freq_map_; // record (pval, *itemsets)
+	TestableSet freq_map_; // record (pval, itemset offset)
 
 	VariableLengthItemsetStack * significant_stack_;
 
@@ -380,6 +401,17 @@ private:
 
 // insert pointer into significant_map_ (do not sort the stack itself)
 	void SortSignificantSets();
+// --result_file: sort across processes and write with MPI-IO
+	void WriteSignificantSets();
+// --trace: merge the timelines of all processes into one file
+	void WriteTrace();
+// --telemetry_file: the last round with the final values
+	void StopTelemetry(int phase);
+// --phase1_save, --phase1_load
+	unsigned long long int ItemHash() const;
+	void SaveClosedSets(ParallelPatternMining * psearch);
+// lambda given by the stored counts, or -1 if they are not enough
+	int LoadClosedSets(ClosedSetFile * stored);
 
 //--------
 // for printing results
@@ -387,6 +419,7 @@ private:
 	long long int final_closed_set_num_;
 	int final_support_;
 	double final_sig_level_;
+	long long int written_sig_num_; // --result_file
 
 // true if bcast_targets_ are all -1
 //	bool IsLeaf(MPI_Data& mpi_data) const;
@@ -24,6 +24,7 @@ struct Tag {
 		CONT_LAMBDA,
 
 		BCAST_FINISH,
+		CHECKPOINT, // pause at a quiescent point and write a checkpoint
 		CONTROL_TASK_END,
 
 		// basic tasks
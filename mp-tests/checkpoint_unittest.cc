@@ -0,0 +1,249 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "Checkpoint.h"
+#include "ClosedSetFile.h"
+
+using namespace lamp_search;
+
+// Checkpoint and ClosedSetFile share the file layout (header, raw arrays)
+// and the restriping of itemsets, so they are tested with the same helpers
+
+namespace {
+
+// append an itemset {id, id+1, ..., id+n-1} with support sup
+void PushItemset(std::vector<int> * v, int id, int n, int sup) {
+	v->push_back(-(n + 1)); // VariableLengthItemsetStack::NUM
+	v->push_back(sup);
+	for (int i = 0; i < n; i++)
+		v->push_back(id + i);
+}
+
+// the first item of each itemset of v
+std::vector<int> FirstItems(const std::vector<int>& v) {
+	std::vector<int> ids;
+	for (std::size_t i = 0; i < v.size(); i += 2 + (-v[i] - 1)) // NUM, SUP, items
+		ids.push_back(v[i + 2]);
+	return ids;
+}
+
+// ids has n elements, all different
+void ExpectEachOnce(std::vector<int> ids, std::size_t n) {
+	EXPECT_EQ(n, ids.size());
+	std::sort(ids.begin(), ids.end());
+	EXPECT_TRUE(std::unique(ids.begin(), ids.end()) == ids.end());
+}
+
+// file names are per rank so that mpirun -np >1 does not race on them
+std::string Prefix() {
+	int rank = 0;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	std::stringstream s;
+	s << "checkpoint_unittest_" << rank;
+	return s.str();
+}
+
+} // namespace
+
+TEST (CheckpointTest, WriteReadTest) {
+	Checkpoint c;
+	c.nu_proc_ = 1;
+	c.phase_ = 2;
+	c.lambda_ = 7;
+	c.lambda_max_ = 20;
+	c.closed_set_num_ = 12345ll;
+	c.sig_level_ = 0.01;
+	c.accum_.assign(c.lambda_max_ + 1, 3ll);
+	PushItemset(&c.node_, 1, 3, 10);
+	PushItemset(&c.freq_, 5, 1, 8);
+	c.pval_.push_back(0.5);
+
+	std::string name = Checkpoint::FileName(Prefix(), 0);
+	EXPECT_EQ(Prefix() + ".0.ckpt", name);
+	ASSERT_TRUE(c.Write(name, 0));
+
+	Checkpoint r;
+	ASSERT_TRUE(r.Read(name));
+	EXPECT_EQ(c.phase_, r.phase_);
+	EXPECT_EQ(c.lambda_, r.lambda_);
+	EXPECT_EQ(c.lambda_max_, r.lambda_max_);
+	EXPECT_EQ(c.closed_set_num_, r.closed_set_num_);
+	EXPECT_EQ(c.sig_level_, r.sig_level_);
+	EXPECT_EQ(c.accum_, r.accum_);
+	EXPECT_EQ(c.node_, r.node_);
+	EXPECT_EQ(c.freq_, r.freq_);
+	EXPECT_EQ(c.pval_, r.pval_);
+	EXPECT_EQ(c.Bytes(), r.Bytes());
+	std::remove(name.c_str());
+}
+
+// 3 files restarted on 2 ranks: every itemset and pval is kept exactly once
+TEST (CheckpointTest, RestripeTest) {
+	const int old_nu_proc = 3;
+	const int new_nu_proc = 2;
+	for (int r = 0; r < old_nu_proc; r++) {
+		Checkpoint c;
+		c.nu_proc_ = old_nu_proc;
+		c.phase_ = 2;
+		c.lambda_max_ = 4;
+		c.closed_set_num_ = 1ll;
+		c.accum_.assign(c.lambda_max_ + 1, 0ll);
+		for (int i = 0; i < 2 + r; i++) {
+			PushItemset(&c.node_, 100 * r + i, 1 + i, 1);
+			PushItemset(&c.freq_, 100 * r + i, 2, 1);
+			c.pval_.push_back(100 * r + i);
+		}
+		ASSERT_TRUE(
+				c.Write(Checkpoint::FileName(Prefix(), r), r));
+	}
+
+	std::vector<int> ids;
+	long long int closed_set_num = 0ll;
+	for (int rank = 0; rank < new_nu_proc; rank++) {
+		Checkpoint c;
+		ASSERT_TRUE(c.Load(Prefix(), rank, new_nu_proc));
+		EXPECT_EQ(new_nu_proc, c.nu_proc_);
+		closed_set_num += c.closed_set_num_;
+
+		std::vector<int> freq_ids = FirstItems(c.freq_);
+		ASSERT_EQ(freq_ids.size(), c.pval_.size());
+		for (std::size_t n = 0; n < freq_ids.size(); n++)
+			EXPECT_EQ((double )freq_ids[n], c.pval_[n]);
+		ids.insert(ids.end(), freq_ids.begin(), freq_ids.end());
+	}
+	EXPECT_EQ(old_nu_proc, closed_set_num);
+	ExpectEachOnce(ids, 2u + 3u + 4u);
+
+	for (int r = 0; r < old_nu_proc; r++)
+		std::remove(Checkpoint::FileName(Prefix(), r).c_str());
+}
+
+TEST (CheckpointTest, MissingFileTest) {
+	Checkpoint c;
+	EXPECT_FALSE(c.Load(Prefix() + "_missing", 0, 1));
+}
+
+TEST (ClosedSetFileTest, WriteReadTest) {
+	ClosedSetFile c;
+	c.nu_proc_ = 1;
+	c.min_sup_ = 6;
+	c.lambda_max_ = 20;
+	c.nu_items_ = 30;
+	c.nu_trans_ = 40;
+	unsigned long long int words[] = { 1ull, 2ull, 3ull };
+	c.item_hash_ = ClosedSetFile::Hash(words, 3, ClosedSetFile::kHashInit);
+	c.accum_.assign(c.lambda_max_ + 1, 3ll);
+	PushItemset(&c.sets_, 1, 3, 10);
+	PushItemset(&c.sets_, 5, 1, 8);
+
+	std::string name = ClosedSetFile::FileName(Prefix(), 0);
+	EXPECT_EQ(Prefix() + ".0.cs", name);
+	ASSERT_TRUE(c.Write(name, 0));
+
+	ClosedSetFile r;
+	ASSERT_TRUE(r.Read(name));
+	EXPECT_EQ(c.min_sup_, r.min_sup_);
+	EXPECT_EQ(c.lambda_max_, r.lambda_max_);
+	EXPECT_EQ(c.nu_items_, r.nu_items_);
+	EXPECT_EQ(c.nu_trans_, r.nu_trans_);
+	EXPECT_EQ(c.item_hash_, r.item_hash_);
+	EXPECT_EQ(c.accum_, r.accum_);
+	EXPECT_EQ(c.sets_, r.sets_);
+	std::remove(name.c_str());
+}
+
+TEST (ClosedSetFileTest, HashTest) {
+	unsigned long long int a[] = { 1ull, 2ull }, b[] = { 2ull, 1ull };
+	unsigned long long int h = ClosedSetFile::Hash(a, 2,
+			ClosedSetFile::kHashInit);
+	EXPECT_EQ(h, ClosedSetFile::Hash(a, 2, ClosedSetFile::kHashInit));
+	EXPECT_NE(h, ClosedSetFile::Hash(b, 2, ClosedSetFile::kHashInit));
+	// continued over two calls as over one
+	EXPECT_EQ(h,
+			ClosedSetFile::Hash(a + 1, 1,
+					ClosedSetFile::Hash(a, 1, ClosedSetFile::kHashInit)));
+}
+
+// 3 files loaded on 2 ranks: every set is kept exactly once
+TEST (ClosedSetFileTest, RestripeTest) {
+	const int old_nu_proc = 3;
+	const int new_nu_proc = 2;
+	for (int r = 0; r < old_nu_proc; r++) {
+		ClosedSetFile c;
+		c.nu_proc_ = old_nu_proc;
+		c.min_sup_ = 2;
+		c.lambda_max_ = 4;
+		c.accum_.assign(c.lambda_max_ + 1, 9ll);
+		for (int i = 0; i < 2 + r; i++)
+			PushItemset(&c.sets_, 100 * r + i, 2, 3);
+		ASSERT_TRUE(c.Write(ClosedSetFile::FileName(Prefix(), r), r));
+	}
+
+	std::vector<int> ids;
+	for (int rank = 0; rank < new_nu_proc; rank++) {
+		ClosedSetFile c;
+		ASSERT_TRUE(c.Load(Prefix(), rank, new_nu_proc));
+		EXPECT_EQ(new_nu_proc, c.nu_proc_);
+		EXPECT_EQ(2, c.min_sup_);
+		EXPECT_EQ(std::vector<long long int>(5, 9ll), c.accum_);
+		std::vector<int> set_ids = FirstItems(c.sets_);
+		ids.insert(ids.end(), set_ids.begin(), set_ids.end());
+	}
+	ExpectEachOnce(ids, 2u + 3u + 4u);
+
+	for (int r = 0; r < old_nu_proc; r++)
+		std::remove(ClosedSetFile::FileName(Prefix(), r).c_str());
+}
+
+TEST (ClosedSetFileTest, MissingFileTest) {
+	ClosedSetFile c;
+	EXPECT_FALSE(c.Load(Prefix() + "_missing", 0, 1));
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "CsAccumHistogram.h"
+
+using namespace lamp_search;
+
+namespace {
+
+// the loop CsAccumHistogram replaces (ParallelPatternMining::IncCsAccum)
+void IncLoop(long long int * accum, int sup, int lambda) {
+	for (int i = sup; i >= lambda - 1; i--)
+		accum[i]++;
+}
+
+} // namespace
+
+TEST (CsAccumHistogramTest, SameAsLoopTest) {
+	const int lambda_max = 50;
+	std::vector<long long int> expected(lambda_max + 1, 0ll);
+	std::vector<long long int> actual(lambda_max + 1, 0ll);
+	CsAccumHistogram hist;
+	hist.Init(lambda_max);
+
+	srand(1);
+	int lambda = 1;
+	for (int n = 0; n < 10000; n++) {
+		int sup = lambda + rand() % (lambda_max - lambda + 1);
+		IncLoop(&expected[0], sup, lambda);
+		hist.Inc(sup, lambda);
+		if (rand() % 7 == 0) {
+			hist.Flush(&actual[0]);
+			EXPECT_FALSE(hist.Dirty());
+			for (int i = 0; i <= lambda_max; i++)
+				ASSERT_EQ(expected[i], actual[i]) << "i=" << i;
+		}
+		if (rand() % 500 == 0 && lambda < lambda_max)
+			lambda++;
+		if (rand() % 1000 == 0) { // like SendDTDAccumReply
+			hist.Flush(&actual[0]);
+			for (int i = 0; i <= lambda_max; i++)
+				expected[i] = actual[i] = 0ll;
+		}
+	}
+	hist.Flush(&actual[0]);
+	for (int i = 0; i <= lambda_max; i++)
+		EXPECT_EQ(expected[i], actual[i]) << "i=" << i;
+}
+
+TEST (CsAccumHistogramTest, LambdaOneTest) {
+	std::vector<long long int> accum(11, 0ll);
+	CsAccumHistogram hist;
+	hist.Init(10);
+	EXPECT_FALSE(hist.Dirty());
+	hist.Inc(3, 1); // [0, 3]
+	hist.Inc(10, 5); // [4, 10]
+	EXPECT_TRUE(hist.Dirty());
+	hist.Flush(&accum[0]);
+	long long int e[] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+	for (int i = 0; i <= 10; i++)
+		EXPECT_EQ(e[i], accum[i]) << "i=" << i;
+}
+
+// reply of a child received with the threshold lambda, sparse and dense
+TEST (CsAccumHistogramTest, ReplyTest) {
+	const int lambda_max = 30;
+	srand(2);
+	for (int round = 0; round < 100; round++) {
+		CsAccumHistogram child;
+		child.Init(lambda_max);
+		for (int n = 0; n < rand() % 20; n++) {
+			int lambda = 1 + rand() % 10;
+			child.Inc(lambda + rand() % (lambda_max - lambda + 1), lambda);
+		}
+		std::vector<long long int> child_accum(lambda_max + 1, 0ll);
+		CsAccumHistogram copy = child;
+		copy.Flush(&child_accum[0]);
+
+		int lambda = 1 + rand() % 15; // of the parent
+		// RecvDTDAccumReply before the histogram
+		std::vector<long long int> expected(lambda_max + 1, 0ll);
+		for (int l = lambda - 1; l <= lambda_max; l++)
+			expected[l] += child_accum[l];
+
+		std::vector<long long int> pairs(2 * (lambda_max + 1));
+		int nu_pair = child.TakeDiff(&pairs[0], lambda_max + 1);
+		ASSERT_LE(0, nu_pair);
+		EXPECT_FALSE(child.Dirty());
+
+		CsAccumHistogram sparse, dense;
+		sparse.Init(lambda_max);
+		dense.Init(lambda_max);
+		sparse.AddDiff(&pairs[0], nu_pair, lambda - 1);
+		dense.AddAccum(&child_accum[0], lambda - 1);
+		std::vector<long long int> a(lambda_max + 1, 0ll), b(
+				lambda_max + 1, 0ll);
+		sparse.Flush(&a[0]);
+		dense.Flush(&b[0]);
+		for (int i = 0; i <= lambda_max; i++) {
+			ASSERT_EQ(expected[i], a[i]) << "round=" << round << " i=" << i;
+			ASSERT_EQ(expected[i], b[i]) << "round=" << round << " i=" << i;
+		}
+	}
+}
+
+TEST (CsAccumHistogramTest, TakeDiffLimitTest) {
+	CsAccumHistogram hist;
+	hist.Init(10);
+	hist.Inc(3, 1); // diff[3] = 1
+	hist.Inc(8, 6); // diff[8] = 1, diff[4] = -1
+	long long int pairs[6];
+	EXPECT_EQ(-1, hist.TakeDiff(pairs, 2));
+	EXPECT_TRUE(hist.Dirty());
+	EXPECT_EQ(3, hist.TakeDiff(pairs, 3));
+	long long int e[] = { 8, 1, 4, -1, 3, 1 };
+	for (int i = 0; i < 6; i++)
+		EXPECT_EQ(e[i], pairs[i]) << "i=" << i;
+	EXPECT_FALSE(hist.Dirty());
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
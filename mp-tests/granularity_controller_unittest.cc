@@ -0,0 +1,154 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "GranularityController.h"
+
+using namespace lamp_search;
+
+// --n without --n_is_ms: number of nodes
+TEST (GranularityControllerTest, FixedNodeNumTest) {
+	GranularityController ctl(100, false, false, 1000ll, 1000000000ll, 0.0);
+	EXPECT_FALSE(ctl.Adaptive());
+	EXPECT_FALSE(ctl.TimeBased());
+	EXPECT_EQ(100ll, ctl.Granularity());
+	EXPECT_FALSE(ctl.ProcessNodeEnd(99, 0ll));
+	EXPECT_TRUE(ctl.ProcessNodeEnd(100, 0ll));
+
+	long long int interval = ctl.Interval();
+	ctl.Update(1000ll, 3, 10, 0ll); // no op
+	EXPECT_EQ(0ll, ctl.NuUpdate());
+	EXPECT_EQ(interval, ctl.Interval());
+}
+
+// --n with --n_is_ms: milli sec
+TEST (GranularityControllerTest, FixedTimeTest) {
+	GranularityController ctl(2, true, false, 1000ll, 1000000000ll, 0.0);
+	EXPECT_TRUE(ctl.TimeBased());
+	EXPECT_EQ(2000000ll, ctl.Granularity());
+	EXPECT_FALSE(ctl.ProcessNodeEnd(0, 5000000ll)); // expand at least one
+	EXPECT_FALSE(ctl.ProcessNodeEnd(1, 1999999ll));
+	EXPECT_TRUE(ctl.ProcessNodeEnd(1, 2000000ll));
+}
+
+TEST (GranularityControllerTest, AdaptiveProcessNodeEndTest) {
+	GranularityController ctl(100, false, true, 1000ll, 1000000000ll, 0.0);
+	EXPECT_TRUE(ctl.TimeBased());
+	EXPECT_EQ(1000000ll, ctl.Interval()); // node count, start from 1 ms
+	EXPECT_EQ(ctl.Interval(), ctl.Granularity());
+	EXPECT_FALSE(ctl.ProcessNodeEnd(0, 2000000ll));
+	EXPECT_FALSE(ctl.ProcessNodeEnd(1000, 999999ll)); // n is ignored
+	EXPECT_TRUE(ctl.ProcessNodeEnd(1, 1000000ll));
+}
+
+// no thief, not idle: additive increase by 1/8
+TEST (GranularityControllerTest, GrowTest) {
+	GranularityController ctl(100, false, true, 1000ll, 1000000000ll, 0.0);
+	long long int interval = ctl.Interval();
+	for (int i = 1; i <= 5; i++) {
+		ctl.Update(100ll, 0, 10, 0ll);
+		interval += interval / 8 + 1;
+		EXPECT_EQ(interval, ctl.Interval()) << "i=" << i;
+		EXPECT_EQ((long long int) i, ctl.NuUpdate());
+	}
+
+	// an empty stack grows too, there is nothing to give
+	GranularityController empty(100, false, true, 1000ll, 1000000000ll,
+			0.0);
+	empty.Update(100ll, 0, 0, 0ll);
+	EXPECT_EQ(1125001ll, empty.Interval());
+}
+
+TEST (GranularityControllerTest, ShrinkTest) {
+	GranularityController ctl(100, false, true, 1000ll, 1000000000ll, 0.0);
+
+	// thieves waiting and the stack can be split: halve
+	ctl.Update(100ll, 2, 10, 0ll);
+	EXPECT_EQ(500000ll, ctl.Interval());
+
+	// thieves waiting but one itemset only: keep
+	ctl.Update(100ll, 1, 1, 0ll);
+	EXPECT_EQ(500000ll, ctl.Interval());
+
+	// idle since the last Probe: halve
+	ctl.Update(100ll, 0, 2, 300ll);
+	EXPECT_EQ(250000ll, ctl.Interval());
+
+	// idle time unchanged: grow again
+	ctl.Update(100ll, 0, 2, 300ll);
+	EXPECT_EQ(250000ll + 250000ll / 8 + 1, ctl.Interval());
+	EXPECT_EQ(4ll, ctl.NuUpdate());
+}
+
+TEST (GranularityControllerTest, ClampTest) {
+	// initial interval of 50 ms is above max_ns
+	GranularityController ctl(50, true, true, 10000ll, 4000000ll, 0.0);
+	EXPECT_EQ(4000000ll, ctl.Interval());
+
+	for (int i = 0; i < 100; i++)
+		ctl.Update(100ll, 1, 10, 0ll);
+	EXPECT_EQ(10000ll, ctl.Interval()); // min_ns
+
+	for (int i = 0; i < 100; i++)
+		ctl.Update(100ll, 0, 10, 0ll);
+	EXPECT_EQ(4000000ll, ctl.Interval()); // max_ns
+
+	// max_ns below min_ns is raised to min_ns
+	GranularityController flat(1, true, true, 20000ll, 10000ll, 0.0);
+	EXPECT_EQ(20000ll, flat.Interval());
+	flat.Update(100ll, 0, 10, 0ll);
+	EXPECT_EQ(20000ll, flat.Interval());
+}
+
+// probe cost / interval stays below overhead
+TEST (GranularityControllerTest, OverheadFloorTest) {
+	GranularityController ctl(100, false, true, 1000ll, 1000000000ll, 0.01);
+	for (int i = 0; i < 100; i++)
+		ctl.Update(2000ll, 1, 10, 0ll);
+	EXPECT_EQ(200000ll, ctl.Interval()); // 2000 / 0.01
+
+	// the smoothed cost moves by 1/8 of the difference
+	ctl.Update(10000ll, 1, 10, 0ll);
+	EXPECT_EQ(300000ll, ctl.Interval()); // (2000 + 8000 / 8) / 0.01
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
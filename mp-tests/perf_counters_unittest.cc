@@ -0,0 +1,80 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "PerfCounters.h"
+
+using namespace lamp_search;
+
+namespace {
+volatile long long int sink;
+}
+
+// counters are often missing in virtual machines and containers
+TEST (PerfCountersTest, ReadTest) {
+	PerfCounters p;
+	bool open = p.Open();
+	EXPECT_EQ(open, p.Available());
+
+	long long int v0[PerfCounters::kNum], v1[PerfCounters::kNum];
+	p.Read(v0);
+	for (long long int i = 0; i < 10000000ll; i++)
+		sink += i;
+	p.Read(v1);
+
+	if (open) {
+		EXPECT_LT(v0[PerfCounters::CYCLES], v1[PerfCounters::CYCLES]);
+		EXPECT_LT(v0[PerfCounters::INSTRUCTIONS] + 10000000ll,
+				v1[PerfCounters::INSTRUCTIONS]);
+	} else {
+		for (int k = 0; k < PerfCounters::kNum; k++)
+			EXPECT_EQ(0ll, v1[k]);
+	}
+
+	p.Close();
+	EXPECT_FALSE(p.Available());
+	p.Read(v1);
+	EXPECT_EQ(0ll, v1[PerfCounters::CYCLES]);
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
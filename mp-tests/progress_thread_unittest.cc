@@ -0,0 +1,186 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "ProgressThread.h"
+#include "SPSCQueue.h"
+
+using namespace lamp_search;
+
+namespace {
+
+const int kNum = 200000;
+
+// pushes 0, 1, ... to the queue, waits while it is full
+void * Produce(void * arg) {
+	SPSCQueue<int> * q = static_cast<SPSCQueue<int> *>(arg);
+	for (int i = 0; i < kNum; i++)
+		while (!q->Push(i))
+			sched_yield();
+	return NULL;
+}
+
+const int kUrgentTag = 7;
+const int kOtherTag = 8;
+
+// the int sent in the next message, -1 if nothing received
+int PollValue(ProgressThread * pt, int * tag) {
+	ProgressThread::Message * msg = pt->Poll();
+	if (msg == NULL)
+		return -1;
+	int v = *reinterpret_cast<int *>(&(msg->data_[0]));
+	*tag = msg->tag_;
+	pt->Done(msg);
+	return v;
+}
+
+} // namespace
+
+TEST (SPSCQueueTest, WrapAroundTest) {
+	SPSCQueue<int> q(5);
+	EXPECT_EQ(8u, q.Capacity()); // rounded up
+	EXPECT_TRUE(q.Empty());
+	int v;
+	EXPECT_FALSE(q.Pop(&v));
+
+	int next_push = 0, next_pop = 0;
+	for (int i = 0; i < 8; i++)
+		EXPECT_TRUE(q.Push(next_push++));
+	EXPECT_FALSE(q.Push(-1)); // full
+	// the positions wrap around the array many times
+	for (int round = 0; round < 100; round++) {
+		for (int i = 0; i < 3; i++) {
+			ASSERT_TRUE(q.Pop(&v));
+			ASSERT_EQ(next_pop++, v);
+		}
+		for (int i = 0; i < 3; i++)
+			ASSERT_TRUE(q.Push(next_push++));
+		ASSERT_FALSE(q.Push(-1));
+	}
+	while (q.Pop(&v))
+		EXPECT_EQ(next_pop++, v);
+	EXPECT_EQ(next_push, next_pop);
+	EXPECT_TRUE(q.Empty());
+}
+
+TEST (SPSCQueueTest, TwoThreadTest) {
+	// small, so that both sides often find it full or empty
+	SPSCQueue<int> q(4);
+	pthread_t producer;
+	ASSERT_EQ(0, pthread_create(&producer, NULL, Produce, &q));
+	int v;
+	long long int empty_num = 0ll;
+	for (int i = 0; i < kNum; i++) {
+		while (!q.Pop(&v)) {
+			empty_num++;
+			sched_yield();
+		}
+		ASSERT_EQ(i, v);
+	}
+	pthread_join(producer, NULL);
+	EXPECT_TRUE(q.Empty());
+	EXPECT_FALSE(q.Pop(&v));
+	RecordProperty("empty_num", (int) empty_num);
+}
+
+// messages to itself, received by the progress thread
+TEST (ProgressThreadTest, OverflowOrderTest) {
+	if (!ProgressThread::Available()) {
+		std::cout << "no MPI_THREAD_MULTIPLE, skipped" << std::endl;
+		return;
+	}
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	const int n = 10;
+	std::vector<int> values(n);
+	std::vector<MPI_Request> requests(n);
+
+	// queue_ holds 2. the 3rd message waits in Loop for the search thread
+	ProgressThread pt(2, kUrgentTag);
+	pt.Start();
+	for (int i = 0; i < n; i++) {
+		values[i] = i;
+		MPI_Isend(&(values[i]), 1, MPI_INT, rank,
+				(i % 2 == 0) ? kUrgentTag : kOtherTag, MPI_COMM_WORLD,
+				&(requests[i]));
+	}
+	usleep(200000);
+	EXPECT_TRUE(pt.Urgent());
+	// the waiting message moves to overflow_
+	pt.Stop();
+	EXPECT_EQ(3ll, pt.Received());
+
+	int next = 0, tag;
+	int v;
+	while ((v = PollValue(&pt, &tag)) >= 0) {
+		EXPECT_EQ(next, v);
+		EXPECT_EQ((next % 2 == 0) ? kUrgentTag : kOtherTag, tag);
+		next++;
+	}
+	EXPECT_EQ(3, next); // queue_, then overflow_
+	EXPECT_FALSE(pt.Urgent());
+
+	// the rest after the restart, still in order
+	pt.Start();
+	while (next < n) {
+		v = PollValue(&pt, &tag);
+		if (v < 0) {
+			sched_yield();
+			continue;
+		}
+		ASSERT_EQ(next, v);
+		next++;
+	}
+	pt.Stop();
+	EXPECT_EQ((long long int) n, pt.Received());
+	EXPECT_EQ(-1, PollValue(&pt, &tag));
+	EXPECT_FALSE(pt.Urgent());
+	MPI_Waitall(n, &(requests[0]), MPI_STATUSES_IGNORE);
+}
+
+int main(int argc, char **argv) {
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "ResultFile.h"
+
+using namespace lamp_search;
+
+namespace {
+
+struct Set {
+	double pval;
+	std::vector<int> items;
+	bool operator<(const Set& rhs) const { // sigset_compare
+		if (pval != rhs.pval)
+			return pval < rhs.pval;
+		if (items.size() != rhs.items.size())
+			return items.size() > rhs.items.size();
+		return items < rhs.items;
+	}
+};
+
+// sets of rank, with many ties in pval. unique by the first item
+std::vector<Set> Generate(int rank) {
+	std::vector<Set> sets;
+	int n = 50 + 37 * rank;
+	for (int i = 0; i < n; i++) {
+		Set s;
+		s.pval = (i % 7) * 0.125; // exact in the output
+		s.items.push_back(rank * 1000 + i);
+		for (int k = 0; k < i % 3; k++)
+			s.items.push_back(100000 + k);
+		sets.push_back(s);
+	}
+	return sets;
+}
+
+void AddAll(const std::vector<Set>& sets, ResultFile * result) {
+	for (std::size_t i = 0; i < sets.size(); i++) {
+		std::vector<int> buf;
+		buf.push_back(-(int) sets[i].items.size() - 1); // NUM
+		buf.push_back(10); // SUP
+		buf.insert(buf.end(), sets[i].items.begin(), sets[i].items.end());
+		result->Add(sets[i].pval, 5, &(buf[0]));
+	}
+}
+
+} // namespace
+
+TEST (ResultFileTest, SortedFileTest) {
+	int rank, nu_proc;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nu_proc);
+
+	ResultFile result(MPI_COMM_WORLD);
+	std::vector<Set> mine = Generate(rank);
+	AddAll(mine, &result);
+	result.Exchange();
+
+	long long int local = result.Size(), total = 0ll;
+	MPI_Allreduce(&local, &total, 1, MPI_LONG_LONG_INT, MPI_SUM,
+			MPI_COMM_WORLD);
+	std::vector<Set> expected;
+	for (int r = 0; r < nu_proc; r++) {
+		std::vector<Set> s = Generate(r);
+		expected.insert(expected.end(), s.begin(), s.end());
+	}
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ((long long int )expected.size(), total);
+
+	const char * name = "result_file_unittest.txt";
+	ASSERT_TRUE(result.Write(name, "# header\n", 2, NULL));
+
+	if (rank == 0) {
+		std::ifstream ifs(name);
+		std::string line;
+		std::getline(ifs, line);
+		EXPECT_EQ("# header", line);
+		std::size_t i = 0;
+		while (std::getline(ifs, line)) {
+			ASSERT_LT(i, expected.size());
+			std::stringstream s(line);
+			double pval, corr;
+			int sup, pos, n;
+			s >> pval >> corr >> sup >> pos >> n;
+			EXPECT_EQ(expected[i].pval, pval) << "line " << i;
+			EXPECT_EQ(expected[i].pval * 2, corr);
+			EXPECT_EQ(10, sup);
+			EXPECT_EQ(5, pos);
+			ASSERT_EQ((int )expected[i].items.size(), n) << "line " << i;
+			for (int k = 0; k < n; k++) {
+				int item;
+				s >> item;
+				EXPECT_EQ(expected[i].items[k], item);
+			}
+			i++;
+		}
+		EXPECT_EQ(expected.size(), i);
+		std::remove(name);
+	}
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "Telemetry.h"
+
+using namespace lamp_search;
+
+namespace {
+std::string ReadFile(const char * name) {
+	std::ifstream f(name);
+	std::stringstream s;
+	s << f.rdbuf();
+	return s.str();
+}
+}
+
+TEST (TelemetryTest, DisabledTest) {
+	Telemetry t;
+	t.Init(MPI_COMM_WORLD, 1.0, "");
+	EXPECT_FALSE(t.Enabled());
+	EXPECT_FALSE(t.Due());
+	t.Stop(NULL);
+	t.Init(MPI_COMM_WORLD, 0.0, "telemetry_unittest.json");
+	EXPECT_FALSE(t.Enabled());
+}
+
+TEST (TelemetryTest, RoundTest) {
+	int rank, nu_proc;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nu_proc);
+	Telemetry t;
+	t.Init(MPI_COMM_WORLD, 1e-9, "telemetry_unittest.json");
+	ASSERT_TRUE(t.Enabled());
+	while (!t.Due())
+		;
+	long long int * v = t.Prepare();
+	v[Telemetry::NODES] = rank + 1;
+	v[Telemetry::IDLE] = 1;
+	v[Telemetry::STACK] = 4;
+	if (rank == 0)
+		v[Telemetry::PHASE] = 2;
+	t.Start();
+	EXPECT_FALSE(t.Due()); // one round at a time
+	while (t.Active())
+		t.Test();
+
+	if (rank == 0) {
+		EXPECT_EQ(nu_proc * (nu_proc + 1) / 2, t.Last()[Telemetry::NODES]);
+		EXPECT_EQ(nu_proc, t.Last()[Telemetry::IDLE]);
+		std::string json = ReadFile("telemetry_unittest.json");
+		EXPECT_EQ(0u, json.find("{"));
+		EXPECT_NE(std::string::npos, json.find("\"phase\": 2,"));
+		EXPECT_NE(std::string::npos, json.find("\"finished\": false"));
+	}
+	// the final values, not the last round
+	std::vector<long long int> final(Telemetry::kFieldNum, 0ll);
+	final[Telemetry::NODES] = rank + 2;
+	final[Telemetry::IDLE] = 1;
+	if (rank == 0)
+		final[Telemetry::PHASE] = 3;
+	t.Stop(&(final[0]));
+	if (rank == 0) {
+		EXPECT_EQ(nu_proc * (nu_proc + 3) / 2, t.Last()[Telemetry::NODES]);
+		EXPECT_EQ(0, t.Last()[Telemetry::STACK]);
+		std::string json = ReadFile("telemetry_unittest.json");
+		EXPECT_NE(std::string::npos, json.find("\"phase\": 3,"));
+		EXPECT_NE(std::string::npos, json.find("\"stack_itemsets\": 0,"));
+		EXPECT_NE(std::string::npos, json.find("\"eta_seconds\": 0.0,"));
+		EXPECT_NE(std::string::npos, json.find("\"finished\": true"));
+		// renamed, not left behind
+		EXPECT_EQ(NULL, std::fopen("telemetry_unittest.json.tmp", "r"));
+		std::remove("telemetry_unittest.json");
+	}
+}
+
+TEST (TelemetryTest, UnevenStopTest) {
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	Telemetry t;
+	t.Init(MPI_COMM_WORLD, 1e-9, "telemetry_unittest.prom");
+	t.Prepare()[Telemetry::STACK] = 1;
+	t.Start();
+	while (t.Active())
+		t.Test();
+	// rank 0 is one round ahead, the others join it in Stop
+	if (rank == 0) {
+		t.Prepare()[Telemetry::STACK] = 1;
+		t.Start();
+	}
+	std::vector<long long int> final(Telemetry::kFieldNum, 0ll);
+	t.Stop(&(final[0]));
+	EXPECT_FALSE(t.Active());
+	EXPECT_EQ(2, t.Rounds());
+	if (rank == 0) {
+		std::string prom = ReadFile("telemetry_unittest.prom");
+		EXPECT_NE(std::string::npos,
+				prom.find("# TYPE lamp_stack_itemsets gauge"));
+		EXPECT_NE(std::string::npos, prom.find("lamp_stack_itemsets 0\n"));
+		EXPECT_NE(std::string::npos, prom.find("lamp_finished 1"));
+		std::remove("telemetry_unittest.prom");
+	}
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
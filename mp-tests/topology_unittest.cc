@@ -0,0 +1,204 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "MPI_Data.h"
+#include "Topology.h"
+
+using namespace lamp_search;
+
+namespace {
+
+// node_of for nu_node nodes with ranks_per_node consecutive ranks each
+std::vector<int> Layout(int nu_node, int ranks_per_node) {
+	std::vector<int> node_of;
+	for (int n = 0; n < nu_node; n++)
+		for (int i = 0; i < ranks_per_node; i++)
+			node_of.push_back(n);
+	return node_of;
+}
+
+// work flows from a lifeline buddy to the rank which registered it
+int Reachable(const Topology& t, int l, int src) {
+	std::vector<std::vector<int> > given(t.NuProc());
+	for (int p = 0; p < t.NuProc(); p++) {
+		std::vector<int> ll = t.Lifelines(p, l);
+		for (std::size_t i = 0; i < ll.size(); i++)
+			given[ll[i]].push_back(p);
+	}
+	std::vector<bool> visited(t.NuProc(), false);
+	std::queue<int> q;
+	q.push(src);
+	visited[src] = true;
+	int count = 1;
+	while (!q.empty()) {
+		int p = q.front();
+		q.pop();
+		for (std::size_t i = 0; i < given[p].size(); i++) {
+			int c = given[p][i];
+			if (!visited[c]) {
+				visited[c] = true;
+				count++;
+				q.push(c);
+			}
+		}
+	}
+	return count;
+}
+
+}
+
+TEST (TopologyTest, FlatLayoutIsHypercube) {
+	// one node: same buddies as MPI_Data::prepareLifelines
+	int p = 12;
+	int l = 2;
+	Topology t(Layout(1, p));
+	int z = MPI_Data::ComputeZ(p, l);
+	for (int rank = 0; rank < p; rank++) {
+		std::vector<int> expected;
+		int radix = 1;
+		for (int j = 0; j < z; j++) {
+			int next_radix = radix * l;
+			int buddy = rank - rank % next_radix
+					+ (rank + next_radix - radix) % next_radix;
+			if (buddy < p)
+				expected.push_back(buddy);
+			radix = next_radix;
+		}
+		EXPECT_EQ(expected, t.Lifelines(rank, l));
+	}
+}
+
+TEST (TopologyTest, LifelinesMostlyIntraNode) {
+	int nu_node = 8;
+	int ranks_per_node = 16;
+	Topology t(Layout(nu_node, ranks_per_node));
+	ASSERT_EQ(nu_node, t.NuNode());
+
+	int intra = 0, inter = 0;
+	for (int p = 0; p < t.NuProc(); p++) {
+		std::vector<int> ll = t.Lifelines(p, 2);
+		for (std::size_t i = 0; i < ll.size(); i++) {
+			EXPECT_NE(p, ll[i]);
+			EXPECT_EQ(1, std::count(ll.begin(), ll.end(), ll[i]));
+			if (t.SameNode(p, ll[i]))
+				intra++;
+			else
+				inter++;
+		}
+	}
+	EXPECT_GT(intra, 2 * inter);
+
+	for (int p = 0; p < t.NuProc(); p++)
+		EXPECT_EQ(t.NuProc(), Reachable(t, 2, p));
+}
+
+TEST (TopologyTest, UnevenLayoutConnected) {
+	std::vector<int> node_of;
+	int sizes[] = { 3, 1, 5, 2, 4 };
+	for (int n = 0; n < 5; n++)
+		for (int i = 0; i < sizes[n]; i++)
+			node_of.push_back(n);
+	Topology t(node_of);
+	for (int l = 2; l <= 3; l++)
+		for (int p = 0; p < t.NuProc(); p++)
+			EXPECT_EQ(t.NuProc(), Reachable(t, l, p));
+}
+
+TEST (TopologyTest, SimulatedNodes) {
+	int rank, nu_proc;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nu_proc);
+
+	setenv(Topology::RanksPerNodeEnv(), "1", 1);
+	Topology t(Topology::DetectNodes(MPI_COMM_WORLD));
+	EXPECT_EQ(nu_proc, t.NuNode());
+	EXPECT_EQ(rank, t.NodeOf(rank));
+
+	DTD dtd(3);
+	{
+		MPI_Data mpi_data(1024 * 1024, rank, nu_proc, 1, false, 4, 4, 2, 3,
+				&dtd, true);
+		EXPECT_EQ(0, mpi_data.nLocalVictims_);
+		for (int i = 0; i < mpi_data.hypercubeDimension_; i++) {
+			if (mpi_data.lifelines_[i] >= 0) {
+				EXPECT_NE(rank, mpi_data.lifelines_[i]);
+			}
+		}
+	}
+	unsetenv(Topology::RanksPerNodeEnv());
+}
+
+TEST (TopologyTest, DetectedNodes) {
+	int rank, nu_proc;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nu_proc);
+
+	Topology t(Topology::DetectNodes(MPI_COMM_WORLD));
+	EXPECT_EQ(nu_proc, t.NuProc());
+	int local = 0;
+	for (int p = 0; p < nu_proc; p++)
+		if (t.SameNode(p, rank))
+			local++;
+	int shm_size;
+	MPI_Comm shm;
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+			MPI_INFO_NULL, &shm);
+	MPI_Comm_size(shm, &shm_size);
+	MPI_Comm_free(&shm);
+	EXPECT_EQ(shm_size, local);
+
+	if (nu_proc > 1 && local == nu_proc) {
+		DTD dtd(3);
+		MPI_Data mpi_data(1024 * 1024, rank, nu_proc, 1, false, 4, 4, 2, 3,
+				&dtd, true);
+		// everything is on one node: plain random victims
+		EXPECT_EQ(4, mpi_data.nLocalVictims_);
+	}
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gflags/gflags.h"
+
+#include "gtest/gtest.h"
+
+#include "mpi.h"
+
+#include "Tracer.h"
+
+using namespace lamp_search;
+
+TEST (TracerTest, DisabledTest) {
+	Tracer t;
+	t.Init(MPI_COMM_WORLD, 0);
+	EXPECT_FALSE(t.Enabled());
+	t.Instant(Tracer::STEAL, 1, -1);
+	t.Complete(Tracer::EXPAND, t.Now(), 0, 10);
+	EXPECT_EQ(0, t.Size());
+	EXPECT_EQ(0, t.Dropped());
+}
+
+TEST (TracerTest, RingTest) {
+	Tracer t;
+	t.Init(MPI_COMM_WORLD, 4);
+	EXPECT_TRUE(t.Enabled());
+	for (int i = 0; i < 6; i++)
+		t.Instant(Tracer::LAMBDA, 0, i);
+	EXPECT_EQ(4, t.Size());
+	EXPECT_EQ(2, t.Dropped());
+}
+
+TEST (TracerTest, WriteTest) {
+	int rank, nu_proc;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nu_proc);
+	Tracer t;
+	t.Init(MPI_COMM_WORLD, 16);
+	if (rank == 0) {
+		EXPECT_EQ(0, t.Offset()); // the reference clock
+	}
+	long long int start = t.Now();
+	t.Instant(Tracer::GIVE, 1, 5);
+	t.Complete(Tracer::PHASE, start, 1);
+	ASSERT_TRUE(t.Write("tracer_unittest.json"));
+
+	if (rank == 0) {
+		std::ifstream f("tracer_unittest.json");
+		std::stringstream s;
+		s << f.rdbuf();
+		std::string json = s.str();
+		EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+		EXPECT_NE(std::string::npos, json.rfind("]"));
+		for (int r = 0; r < nu_proc; r++) {
+			std::stringstream name;
+			name << "\"rank " << r << "\"";
+			EXPECT_NE(std::string::npos, json.find(name.str()));
+		}
+		EXPECT_NE(std::string::npos, json.find("\"name\":\"phase 1\""));
+		EXPECT_NE(std::string::npos, json.find("\"nodes\":5"));
+		EXPECT_EQ(std::string::npos, json.find(",,"));
+		std::remove("tracer_unittest.json");
+	}
+}
+
+int main(int argc, char **argv) {
+	MPI_Init(&argc, &argv);
+	::testing::InitGoogleTest(&argc, argv);
+	google::ParseCommandLineFlags(&argc, &argv, true);
+
+	int res = RUN_ALL_TESTS();
+	MPI_Finalize();
+	return res;
+}
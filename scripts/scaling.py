@@ -0,0 +1,357 @@
+#!/usr/bin/env python
+# Copyright (c) 2016, Kazuki Yoshizoe
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its contributors
+# may be used to endorse or promote products derived from this software without
+# specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+# Strong and weak scaling of bin-lamp / cont-lamp on the local machine.
+#
+# Runs the binary under mpirun for each number of processes (--ranks), reads
+# the output of --log (PrintAggrLog and the periodic log) into JSON and
+# reports speedup, efficiency, idle fraction, steal success rate and the time
+# of each phase. The significant patterns of every run are compared with
+# those of the first run on the same data, and a mismatch makes the exit
+# status 1.
+#
+# strong scaling of existing data:
+#   scripts/scaling.py --bin mp_build/opt/mp-main/bin-lamp \
+#     --item item.csv --pos pos.csv --ranks 2,4,8 --out scaling.json
+# weak scaling of data from gen_data, --trans transactions per process:
+#   scripts/scaling.py --bin mp_build/opt/mp-main/bin-lamp \
+#     --gen build/opt/main/gen_data --trans 100000 --weak --out weak.json
+
+from __future__ import print_function
+
+import argparse
+import json
+import multiprocessing
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+NUMBER = r'[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?|[-+]?(?:inf|nan)'
+
+
+def ParseAggrLine(line):
+    # "# name   =   v0   v1   v2(unit)  (comment)"
+    m = re.match(r'^# ([^=]+?)\s*=(.*)$', line)
+    if not m:
+        return None
+    name, rest = m.group(1).strip(), m.group(2)
+    values = [float(v) for v in re.findall(NUMBER, rest.split('(')[0])]
+    unit = re.search(r'\((s|ms|us|ns)\)', rest)
+    entry = {'values': values}
+    if unit:
+        entry['unit'] = unit.group(1)
+    comment = re.search(r'\(([^()]*\s[^()]*)\)\s*$', rest)
+    if comment:
+        entry['comment'] = comment.group(1)
+    return name, entry
+
+
+def ParseOutput(text):
+    """Structured form of the output of bin-lamp / cont-lamp --log."""
+    run = {'aggr': {}, 'periodic': [], 'patterns': []}
+    lines = text.splitlines()
+    in_patterns = False
+    periodic_fields = None
+    for line in lines:
+        m = re.match(r'^# time all=\s*(\S+)\s+time search=\s*(\S+)', line)
+        if m:
+            run['time_all'] = float(m.group(1))
+            run['time_search'] = float(m.group(2))
+            continue
+        m = re.search(r'min\. sup=(\S+)', line)
+        if m and line.startswith('#'):
+            run['min_sup'] = float(m.group(1))
+        m = re.search(r'correction factor=(\S+)', line)
+        if m and line.startswith('#'):
+            run['correction_factor'] = float(m.group(1))
+        m = re.match(r'^# number of significant patterns=\s*(\d+)', line)
+        if m:
+            run['significant'] = int(m.group(1))
+            continue
+        if line.startswith('# pval (raw)'):
+            in_patterns = True
+            continue
+        if in_patterns:
+            if re.match(r'^\s*(' + NUMBER + r')\s', line):
+                run['patterns'].append(' '.join(line.split()))
+                continue
+            if line.startswith('#'):
+                in_patterns = False
+        if line.startswith('# periodic log'):
+            periodic_fields = []
+            continue
+        if periodic_fields is not None:
+            if line.startswith('# phase'):
+                periodic_fields = line[2:].split()
+                continue
+            fields = line[1:].split() if line.startswith('#') else []
+            if periodic_fields and len(fields) == len(periodic_fields):
+                try:
+                    run['periodic'].append(
+                        dict(zip(periodic_fields, [float(f) for f in fields])))
+                    continue
+                except ValueError:
+                    pass
+        if line.startswith('# ') and not line.startswith('# lambda='):
+            parsed = ParseAggrLine(line)
+            if parsed and parsed[1]['values']:
+                run['aggr'][parsed[0]] = parsed[1]
+    return run
+
+
+def Aggr(run, name, column, default=0.0):
+    entry = run['aggr'].get(name)
+    if entry is None or len(entry['values']) <= column:
+        return default
+    return entry['values'][column]
+
+
+def Median(values):
+    s = sorted(values)
+    n = len(s)
+    return s[n // 2] if n % 2 else 0.5 * (s[n // 2 - 1] + s[n // 2])
+
+
+def Metrics(run, nu_proc):
+    """Derived values of one run. log values are (rank 0, total, avg)."""
+    m = {}
+    t = run.get('time_search', 0.0)
+    idle = Aggr(run, 'idle_time', 1) / 1000.0  # ms, sum of all processes
+    if t > 0:
+        m['idle_fraction'] = idle / (t * nu_proc)
+    succ = Aggr(run, 'steal_num', 1) + Aggr(run, 'lfl_steal_num', 1)
+    fail = Aggr(run, 'steal_reject_num', 1) + Aggr(run, 'rma_steal_fail', 1)
+    m['steal_success'] = succ
+    m['steal_fail'] = fail
+    if succ + fail > 0:
+        m['steal_success_rate'] = succ / (succ + fail)
+    for phase in range(4):
+        wall = 'phase%d_wall_time' % phase
+        if wall in run['aggr']:
+            # max over the processes, ms
+            m['phase%d_time' % phase] = Aggr(run, wall, 1) / 1000.0
+    if t > 0 and 'process_node_num' in run['aggr']:
+        m['nodes_per_second'] = Aggr(run, 'process_node_num', 1) / t
+    return m
+
+
+def Run(args, nu_proc, item, pos, log_dir, rep):
+    cmd = [args.mpirun, '-np', str(nu_proc)]
+    if args.oversubscribe:
+        cmd.append('--oversubscribe')
+    cmd += shlex.split(args.mpirun_args)
+    cmd += [args.bin, '--item', item, '--pos', pos, '--a', str(args.a),
+            '--log']
+    cmd += shlex.split(args.args)
+    log_file = os.path.join(log_dir, 'np%d_%d.log' % (nu_proc, rep))
+    print('# ' + ' '.join(cmd), file=sys.stderr)
+    with open(log_file, 'w') as f:
+        ret = subprocess.call(cmd, stdout=f, stderr=subprocess.STDOUT)
+    with open(log_file) as f:
+        text = f.read()
+    run = ParseOutput(text)
+    run['log'] = log_file
+    run['returncode'] = ret
+    run['command'] = cmd
+    return run
+
+
+def Generate(args, trans, work_dir):
+    prefix = os.path.join(work_dir, 'synth_%d' % trans)
+    fmt = 'cont' if args.cont else 'csv'
+    cmd = [args.gen, '--out', prefix, '--format', fmt, '--trans', str(trans)]
+    cmd += shlex.split(args.gen_args)
+    print('# ' + ' '.join(cmd), file=sys.stderr)
+    subprocess.check_call(cmd, stdout=sys.stderr)
+    if args.cont:
+        return prefix + '.data', prefix + '.class'
+    return prefix + '.csv', prefix + '_pos.csv'
+
+
+def OpenMPI(mpirun):
+    try:
+        out = subprocess.check_output([mpirun, '--version'],
+                                      stderr=subprocess.STDOUT)
+        return b'Open MPI' in out or b'OpenRTE' in out
+    except (OSError, subprocess.CalledProcessError):
+        return False
+
+
+def main():
+    p = argparse.ArgumentParser(
+        description='strong and weak scaling of bin-lamp and cont-lamp')
+    p.add_argument('--bin', required=True, help='bin-lamp or cont-lamp')
+    p.add_argument('--cont', action='store_true',
+                   help='cont-lamp input (default: if --bin is cont-lamp)')
+    p.add_argument('--ranks', default='',
+                   help='comma separated numbers of processes '
+                   '(default: 2, 4, ... up to the number of cores)')
+    p.add_argument('--repeat', type=int, default=1,
+                   help='runs per number of processes, the median is used')
+    p.add_argument('--item', help='item file (strong scaling)')
+    p.add_argument('--pos', help='positive file (strong scaling)')
+    p.add_argument('--gen', help='gen_data to generate the data')
+    p.add_argument('--trans', type=int, default=100000,
+                   help='transactions for --gen (per process with --weak)')
+    p.add_argument('--gen_args', default='--items 100 --density 0.1',
+                   help='more options of gen_data')
+    p.add_argument('--weak', action='store_true',
+                   help='weak scaling: data grows with the processes')
+    p.add_argument('--a', type=float, default=0.05, help='significance level')
+    p.add_argument('--args', default='', help='more options of --bin')
+    p.add_argument('--mpirun', default='mpirun')
+    p.add_argument('--mpirun_args', default='',
+                   help='e.g. --mpirun_args=--allow-run-as-root; use the = '
+                   'form for values that start with -')
+    p.add_argument('--oversubscribe', default='auto',
+                   choices=['auto', 'yes', 'no'],
+                   help='pass --oversubscribe (Open MPI) when there are more '
+                   'processes than cores')
+    p.add_argument('--work_dir', default='scaling_work',
+                   help='generated data and the logs of the runs')
+    p.add_argument('--out', default='scaling.json', help='JSON result')
+    args = p.parse_args()
+
+    if not args.cont and 'cont' in os.path.basename(args.bin):
+        args.cont = True
+    cores = multiprocessing.cpu_count()
+    if args.ranks:
+        ranks = [int(r) for r in args.ranks.split(',')]
+    else:
+        ranks = [2]
+        while ranks[-1] * 2 <= max(cores, 2):
+            ranks.append(ranks[-1] * 2)
+    if args.weak and not args.gen:
+        p.error('--weak needs --gen')
+    if not args.gen and not (args.item and args.pos):
+        p.error('give --item and --pos, or --gen')
+    if not os.path.isdir(args.work_dir):
+        os.makedirs(args.work_dir)
+    is_openmpi = OpenMPI(args.mpirun)
+
+    data = {}  # number of processes -> (item, pos)
+    for nu_proc in ranks:
+        if args.item:
+            data[nu_proc] = (args.item, args.pos)
+        elif args.weak:
+            data[nu_proc] = Generate(args, args.trans * nu_proc,
+                                     args.work_dir)
+        elif not data:
+            data[nu_proc] = Generate(args, args.trans, args.work_dir)
+        else:
+            data[nu_proc] = data[ranks[0]]
+
+    results = []
+    reference = {}  # data -> patterns of the first run
+    mismatches = []
+    for nu_proc in ranks:
+        over = (args.oversubscribe == 'yes' or
+                (args.oversubscribe == 'auto' and is_openmpi and
+                 nu_proc > cores))
+        args_np = argparse.Namespace(**vars(args))
+        args_np.oversubscribe = over
+        runs = []
+        for rep in range(args.repeat):
+            run = Run(args_np, nu_proc, data[nu_proc][0], data[nu_proc][1],
+                      args.work_dir, rep)
+            key = data[nu_proc]
+            patterns = sorted(run['patterns'])
+            if run['returncode'] != 0 or 'time_search' not in run:
+                mismatches.append({'ranks': nu_proc, 'repeat': rep,
+                                   'error': 'failed, see ' + run['log']})
+            elif key not in reference:
+                reference[key] = (nu_proc, patterns)
+            elif reference[key][1] != patterns:
+                ref = set(reference[key][1])
+                cur = set(patterns)
+                mismatches.append({
+                    'ranks': nu_proc, 'repeat': rep,
+                    'reference_ranks': reference[key][0],
+                    'missing': sorted(ref - cur)[:20],
+                    'extra': sorted(cur - ref)[:20]})
+            run['metrics'] = Metrics(run, nu_proc)
+            runs.append(run)
+        ok = [r for r in runs if 'time_search' in r]
+        entry = {'ranks': nu_proc, 'item': data[nu_proc][0],
+                 'oversubscribed': over, 'runs': runs}
+        if ok:
+            entry['time_search'] = Median([r['time_search'] for r in ok])
+            entry['time_all'] = Median([r['time_all'] for r in ok])
+            for name in sorted(ok[0]['metrics']):
+                vals = [r['metrics'][name] for r in ok
+                        if name in r['metrics']]
+                if vals:
+                    entry[name] = Median(vals)
+            entry['significant'] = ok[0].get('significant')
+        results.append(entry)
+
+    base = [e for e in results if 'time_search' in e]
+    if base:
+        b = base[0]
+        for e in base:
+            if e['time_search'] <= 0:
+                continue
+            if args.weak:
+                e['efficiency'] = b['time_search'] / e['time_search']
+            else:
+                e['speedup'] = b['time_search'] / e['time_search']
+                e['efficiency'] = e['speedup'] * b['ranks'] / e['ranks']
+
+    report = {'binary': args.bin, 'scaling': 'weak' if args.weak else 'strong',
+              'cores': cores, 'ranks': ranks, 'repeat': args.repeat,
+              'results': results, 'mismatches': mismatches}
+    with open(args.out, 'w') as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+
+    print('# %s scaling of %s, %d cores' % (report['scaling'], args.bin,
+                                             cores))
+    print('%6s %12s %9s %9s %9s %9s %10s %10s %10s' % (
+        'ranks', 'search(s)', 'speedup', 'effic.', 'idle', 'steal',
+        'phase1(s)', 'phase2(s)', 'phase3(s)'))
+    for e in results:
+        def F(name, fmt='%9.3f'):
+            return fmt % e[name] if name in e else '%9s' % '-'
+        print('%6d %12s %9s %9s %9s %9s %10s %10s %10s' % (
+            e['ranks'], F('time_search', '%12.4f'), F('speedup'),
+            F('efficiency'), F('idle_fraction'), F('steal_success_rate'),
+            F('phase1_time', '%10.4f'), F('phase2_time', '%10.4f'),
+            F('phase3_time', '%10.4f')))
+    if mismatches:
+        print('# RESULT MISMATCH in %d runs, see %s' % (len(mismatches),
+                                                       args.out))
+        return 1
+    print('# results are the same for all the runs')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,275 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "binary_database.h"
+
+namespace lamp_search {
+
+namespace {
+const char kMagic[8] = { 'L', 'A', 'M', 'P', 'D', 'B', '\0', '\0' };
+
+// names joined with '\0' after each
+void AppendNames(const std::vector<std::string> * names, std::string * s) {
+  if (names == NULL) return;
+  for (std::size_t i=0 ; i<names->size() ; i++) {
+    s->append((*names)[i]);
+    s->push_back('\0');
+  }
+}
+
+void WritePadded(std::ofstream & ofs, const void * p, std::size_t size,
+                 std::size_t padded) {
+  static const char zero[64] = { 0 };
+  ofs.write(static_cast<const char *>(p), size);
+  for (std::size_t rest = padded - size; rest > 0; ) {
+    std::size_t n = std::min(rest, sizeof(zero));
+    ofs.write(zero, n);
+    rest -= n;
+  }
+}
+}
+
+template<typename Block>
+BinaryDatabase<Block>::BinaryDatabase() :
+    map_ (NULL),
+    map_size_ (0),
+    header_ (NULL),
+    data_ (NULL),
+    positive_ (NULL),
+    names_ (NULL)
+{
+}
+
+template<typename Block>
+BinaryDatabase<Block>::~BinaryDatabase() {
+  Unmap();
+}
+
+template<typename Block>
+uint64 BinaryDatabase<Block>::Hash(const void * p, std::size_t size, uint64 h) {
+  // FNV-1a on 64 bit words
+  const char * c = static_cast<const char *>(p);
+  for (std::size_t i=0 ; i+sizeof(uint64)<=size ; i+=sizeof(uint64)) {
+    uint64 w;
+    std::memcpy(&w, c + i, sizeof(w));
+    h ^= w;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+template<typename Block>
+bool BinaryDatabase<Block>::IsBinary(const std::string & file_name) {
+  std::ifstream ifs(file_name.c_str(), std::ios::in | std::ios::binary);
+  char magic[sizeof(kMagic)];
+  ifs.read(magic, sizeof(magic));
+  return ifs.good() && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+template<typename Block>
+void BinaryDatabase<Block>::Write(const std::string & file_name,
+                                  const VariableBitsetHelper<Block> * bsh,
+                                  const Block * data,
+                                  int nu_trans,
+                                  int nu_items,
+                                  const Block * positive,
+                                  int nu_pos_total,
+                                  int max_item_in_transaction,
+                                  const std::vector< std::string > * item_names,
+                                  const std::vector< std::string > * trans_names) {
+  if (item_names != NULL && (int)item_names->size() != nu_items)
+    throw std::runtime_error("binary database: item names mismatch");
+  if (item_names == NULL && trans_names != NULL && !trans_names->empty())
+    throw std::runtime_error("binary database: transaction names without item names");
+
+  std::string names;
+  AppendNames(item_names, &names);
+  AppendNames(trans_names, &names);
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.byte_order_ = kByteOrder;
+  header.version_ = kVersion;
+  header.block_bytes_ = sizeof(Block);
+  header.nu_bits_ = (int)(bsh->nu_bits);
+  header.nu_trans_ = nu_trans;
+  header.nu_items_ = nu_items;
+  header.nu_pos_total_ = nu_pos_total;
+  header.max_item_in_transaction_ = max_item_in_transaction;
+  header.nu_trans_names_ = (trans_names == NULL) ? 0 : (int)trans_names->size();
+  header.has_positive_ = (positive != NULL);
+  header.names_bytes_ = names.size();
+
+  std::size_t data_bytes = (std::size_t)bsh->NewArraySize(nu_items) * sizeof(Block);
+  std::size_t pos_bytes = bsh->NuBlocks() * sizeof(Block);
+
+  // padding is zero, so the checksum of a section is that of its padded form
+  uint64 h = kHashInit;
+  h = Hash(data, data_bytes, h);
+  if (positive != NULL) h = Hash(positive, pos_bytes, h);
+  names.resize(Padded(names.size()), '\0');
+  h = Hash(names.data(), names.size(), h);
+  header.checksum_ = h;
+
+  std::ofstream ofs(file_name.c_str(),
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  if (ofs.fail())
+    throw std::runtime_error(std::string("cannot write: ") + file_name);
+  WritePadded(ofs, &header, sizeof(header), Padded(sizeof(header)));
+  WritePadded(ofs, data, data_bytes, Padded(data_bytes));
+  if (positive != NULL) WritePadded(ofs, positive, pos_bytes, Padded(pos_bytes));
+  ofs.write(names.data(), names.size());
+  ofs.close();
+  if (ofs.fail())
+    throw std::runtime_error(std::string("cannot write: ") + file_name);
+}
+
+template<typename Block>
+void BinaryDatabase<Block>::Map(const std::string & file_name) {
+  Unmap();
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error(std::string("file not found: ") + file_name);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error(std::string("not a binary database: ") + file_name);
+  }
+  map_size_ = st.st_size;
+  // shared, so processes on a node read the same page cache
+  void * p = mmap(NULL, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    throw std::runtime_error(std::string("cannot map: ") + file_name);
+  map_ = p;
+  header_ = static_cast<const Header *>(map_);
+
+  std::string error;
+  if (std::memcmp(header_->magic_, kMagic, sizeof(kMagic)) != 0)
+    error = "not a binary database";
+  else if (header_->byte_order_ != kByteOrder)
+    error = "binary database written with another byte order";
+  else if (header_->version_ != kVersion)
+    error = "unknown binary database version";
+  else if (header_->block_bytes_ != sizeof(Block))
+    error = "binary database block size mismatch";
+
+  if (error.empty()) {
+    VariableBitsetHelper<Block> bsh(header_->nu_bits_);
+    std::size_t data_bytes =
+        (std::size_t)bsh.NewArraySize(header_->nu_items_) * sizeof(Block);
+    std::size_t pos_bytes =
+        header_->has_positive_ ? bsh.NuBlocks() * sizeof(Block) : 0;
+    std::size_t names_bytes = Padded(header_->names_bytes_);
+    std::size_t size = Padded(sizeof(Header)) + Padded(data_bytes)
+        + Padded(pos_bytes) + names_bytes;
+    if (size != map_size_) {
+      error = "binary database size mismatch";
+    } else {
+      const char * c = static_cast<const char *>(map_) + Padded(sizeof(Header));
+      data_ = reinterpret_cast<const Block *>(c);
+      c += Padded(data_bytes);
+      positive_ = header_->has_positive_ ? reinterpret_cast<const Block *>(c) : NULL;
+      c += Padded(pos_bytes);
+      names_ = c;
+
+      uint64 h = kHashInit;
+      h = Hash(data_, data_bytes, h);
+      if (positive_ != NULL) h = Hash(positive_, pos_bytes, h);
+      h = Hash(names_, names_bytes, h);
+      if (h != header_->checksum_)
+        error = "binary database checksum mismatch";
+      else if (header_->names_bytes_ > 0
+               && (names_[header_->names_bytes_ - 1] != '\0'
+                   || std::count(names_, names_ + header_->names_bytes_, '\0')
+                   != header_->nu_items_ + header_->nu_trans_names_))
+        error = "binary database names mismatch";
+    }
+  }
+
+  if (!error.empty()) {
+    Unmap();
+    throw std::runtime_error(error + ": " + file_name);
+  }
+}
+
+template<typename Block>
+void BinaryDatabase<Block>::Unmap() {
+  if (map_ != NULL) munmap(map_, map_size_);
+  map_ = NULL;
+  map_size_ = 0;
+  header_ = NULL;
+  data_ = NULL;
+  positive_ = NULL;
+  names_ = NULL;
+}
+
+template<typename Block>
+void BinaryDatabase<Block>::ItemNames(std::vector< std::string > * names) const {
+  const char * c = names_;
+  names->clear();
+  if (header_->names_bytes_ == 0) return; // written without names
+  for (int i=0 ; i<header_->nu_items_ ; i++) {
+    names->push_back(std::string(c));
+    c += names->back().size() + 1;
+  }
+}
+
+template<typename Block>
+void BinaryDatabase<Block>::TransactionNames(std::vector< std::string > * names) const {
+  const char * c = names_;
+  names->clear();
+  if (header_->names_bytes_ == 0) return;
+  for (int i=0 ; i<header_->nu_items_ ; i++)
+    c += std::strlen(c) + 1;
+  for (int i=0 ; i<header_->nu_trans_names_ ; i++) {
+    names->push_back(std::string(c));
+    c += names->back().size() + 1;
+  }
+}
+
+template class BinaryDatabase<uint64>;
+
+} // namespace lamp_search
+
+/* Local Variables:  */
+/* compile-command: "scons -u" */
+/* End:              */
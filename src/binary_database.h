@@ -0,0 +1,152 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _LAMP_SEARCH_BINARY_DATABASE_H_
+#define _LAMP_SEARCH_BINARY_DATABASE_H_
+
+#include <string>
+#include <vector>
+
+#include "utils.h"
+#include "variable_bitset_array.h"
+
+namespace lamp_search {
+
+// binary form of an item file and a positive file, read by mapping it.
+//
+// layout (version 1), all sections start at a multiple of 64 bytes:
+//   header   : Header below
+//   items    : nu_items bitsets of NuBlocks() Blocks, as DatabaseReader
+//              makes them (one bit per transaction with an item)
+//   positive : one bitset, only if has_positive
+//   names    : item names, then transaction names, each ending with '\0'
+// the checksum is taken over everything after the header. the file is
+// written in the byte order of the machine, which Map checks.
+template<typename Block>
+class BinaryDatabase {
+public:
+	static const unsigned int kVersion = 1;
+	static const std::size_t kAlign = 64;
+
+	struct Header {
+		char magic_[8]; // "LAMPDB" padded with '\0'
+		unsigned int byte_order_; // kByteOrder as written
+		unsigned int version_;
+		unsigned int block_bytes_; // sizeof(Block)
+		int nu_bits_; // transactions with an item
+		int nu_trans_;
+		int nu_items_;
+		int nu_pos_total_;
+		int max_item_in_transaction_;
+		int nu_trans_names_;
+		int has_positive_;
+		uint64 names_bytes_;
+		uint64 checksum_;
+	};
+
+	BinaryDatabase();
+	~BinaryDatabase();
+
+	// true if the file starts as a binary database
+	static bool IsBinary(const std::string & file_name);
+
+	// throw std::runtime_error if the file cannot be written.
+	// positive, item_names and trans_names may be NULL
+	static void Write(const std::string & file_name,
+			const VariableBitsetHelper<Block> * bsh, const Block * data,
+			int nu_trans, int nu_items, const Block * positive,
+			int nu_pos_total, int max_item_in_transaction,
+			const std::vector<std::string> * item_names,
+			const std::vector<std::string> * trans_names);
+
+	// map the file read only and check it. throw std::runtime_error if it
+	// is not a binary database of this version and byte order, or broken
+	void Map(const std::string & file_name);
+	void Unmap();
+	bool Mapped() const {
+		return map_ != NULL;
+	}
+
+	int NuBits() const {
+		return header_->nu_bits_;
+	}
+	int NuTransaction() const {
+		return header_->nu_trans_;
+	}
+	int NuItems() const {
+		return header_->nu_items_;
+	}
+	int PosTotal() const {
+		return header_->nu_pos_total_;
+	}
+	int MaxItemInTransaction() const {
+		return header_->max_item_in_transaction_;
+	}
+
+	// valid until Unmap
+	const Block * Data() const {
+		return data_;
+	}
+	// NULL if written without positives
+	const Block * PosNeg() const {
+		return positive_;
+	}
+
+	void ItemNames(std::vector<std::string> * names) const;
+	void TransactionNames(std::vector<std::string> * names) const;
+
+	// checksum of size bytes (a multiple of 8), continued from h
+	static uint64 Hash(const void * p, std::size_t size, uint64 h);
+
+private:
+	static const unsigned int kByteOrder = 0x01020304u;
+	static const uint64 kHashInit = 14695981039346656037ull;
+
+	static std::size_t Padded(std::size_t size) {
+		return (size + kAlign - 1) / kAlign * kAlign;
+	}
+
+	void * map_;
+	std::size_t map_size_;
+	const Header * header_;
+	const Block * data_;
+	const Block * positive_;
+	const char * names_;
+
+	BinaryDatabase(const BinaryDatabase &);
+	BinaryDatabase & operator=(const BinaryDatabase &);
+};
+
+} // namespace lamp_search
+
+#endif // _LAMP_SEARCH_BINARY_DATABASE_H_
+
+/* Local Variables:  */
+/* compile-command: "scons -u" */
+/* End:              */
@@ -35,6 +35,14 @@
 #include <cmath>
 #include <set>
 #include <map>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <boost/array.hpp>
 
@@ -412,6 +420,384 @@ void DatabaseReader<Block>::ReadItemsLCM(std::istream & is,
     throw std::runtime_error("read 1st 2nd phase mismatch (shouldn't happen)");
 }
 
+namespace {
+
+// a token in the mapped file (not copied)
+struct Token {
+  const char * p_;
+  std::size_t n_;
+
+  bool operator==(const Token & t) const {
+    return n_ == t.n_ && std::memcmp(p_, t.p_, n_) == 0;
+  }
+  bool operator!=(const char * s) const {
+    return !(n_ == std::strlen(s) && std::memcmp(p_, s, n_) == 0);
+  }
+  std::string String() const { return std::string(p_, n_); }
+};
+
+// as boost::algorithm::trim in the "C" locale
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// as boost::char_separator<char>(", ") or (" \t") for lcm
+inline bool IsSeparator(char c, bool lcm) {
+  return lcm ? (c == ' ' || c == '\t') : (c == ',' || c == ' ');
+}
+
+// next token in [*b, e), skipping empty ones. false if none
+inline bool NextToken(const char ** b, const char * e, bool lcm, Token * t) {
+  const char * p = *b;
+  while (p < e && IsSeparator(*p, lcm)) p++;
+  if (p == e) { *b = e; return false; }
+  const char * q = p;
+  while (q < e && !IsSeparator(*q, lcm)) q++;
+  t->p_ = p;
+  t->n_ = q - p;
+  *b = q;
+  return true;
+}
+
+// item name in an lcm token, as (std::istringstream(token) >> name)
+inline Token LCMName(const Token & t) {
+  const char * p = t.p_, * e = t.p_ + t.n_;
+  while (p < e && IsSpace(*p)) p++;
+  const char * q = p;
+  while (q < e && !IsSpace(*q)) q++;
+  Token name = { p, (std::size_t)(q - p) };
+  return name;
+}
+
+// line [begin_, end_) of the mapped file, trimmed
+struct Line {
+  std::size_t begin_;
+  std::size_t end_;
+};
+
+// lines ending with '\n' in [b, e) of text, trimmed. as std::getline with
+// is.good(), a last line without '\n' is not read
+void FindLines(const char * text, std::size_t b, std::size_t e,
+               std::vector<Line> * lines) {
+  while (b < e) {
+    const char * nl = static_cast<const char *>(std::memchr(text + b, '\n', e - b));
+    if (nl == NULL) break;
+    Line l = { b, (std::size_t)(nl - text) };
+    while (l.begin_ < l.end_ && IsSpace(text[l.begin_])) l.begin_++;
+    while (l.end_ > l.begin_ && IsSpace(text[l.end_ - 1])) l.end_--;
+    lines->push_back(l);
+    b = nl - text + 1;
+  }
+}
+
+// open addressing table of distinct tokens, numbered in order of insertion
+class TokenTable {
+public:
+  TokenTable() : slots_(64, -1) {}
+
+  // -1 if not found
+  int Find(const Token & t) const {
+    for (std::size_t i = Hash(t) & (slots_.size() - 1); ;
+         i = (i + 1) & (slots_.size() - 1)) {
+      if (slots_[i] < 0) return -1;
+      if (tokens_[slots_[i]] == t) return slots_[i];
+    }
+  }
+  int Insert(const Token & t) {
+    int id = Find(t);
+    if (id >= 0) return id;
+    if (2 * (tokens_.size() + 1) > slots_.size()) Grow();
+    id = tokens_.size();
+    tokens_.push_back(t);
+    Place(id);
+    return id;
+  }
+  const std::vector<Token> & Tokens() const { return tokens_; }
+
+private:
+  static std::size_t Hash(const Token & t) {
+    uint64 h = 14695981039346656037ull; // FNV-1a
+    for (std::size_t i=0 ; i<t.n_ ; i++) {
+      h ^= (unsigned char)t.p_[i];
+      h *= 1099511628211ull;
+    }
+    return (std::size_t)h;
+  }
+  void Place(int id) {
+    std::size_t i = Hash(tokens_[id]) & (slots_.size() - 1);
+    while (slots_[i] >= 0) i = (i + 1) & (slots_.size() - 1);
+    slots_[i] = id;
+  }
+  void Grow() {
+    slots_.assign(2 * slots_.size(), -1);
+    for (std::size_t id=0 ; id<tokens_.size() ; id++) Place(id);
+  }
+
+  std::vector<int> slots_; // power of 2
+  std::vector<Token> tokens_;
+};
+
+// read only mapping of a whole file
+class MappedFile {
+public:
+  explicit MappedFile(const std::string & file_name) : text_(NULL), size_(0) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error(std::string("file not found: ") + file_name);
+    struct stat st;
+    st.st_size = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void * p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        text_ = static_cast<const char *>(p);
+        size_ = st.st_size;
+        madvise(p, size_, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+    if (text_ == NULL && st.st_size > 0)
+      throw std::runtime_error(std::string("cannot map: ") + file_name);
+  }
+  ~MappedFile() {
+    if (text_ != NULL) munmap(const_cast<char *>(text_), size_);
+  }
+  const char * Text() const { return text_; }
+  std::size_t Size() const { return size_; }
+
+private:
+  const char * text_;
+  std::size_t size_;
+
+  MappedFile(const MappedFile &);
+  MappedFile & operator=(const MappedFile &);
+};
+
+// calls (*f)(k) for k in [0, n): k > 0 on new threads, 0 on the caller
+template<typename F>
+struct ThreadArg {
+  F * f_;
+  int k_;
+};
+
+template<typename F>
+void * ThreadMain(void * arg) {
+  ThreadArg<F> * a = static_cast<ThreadArg<F> *>(arg);
+  (*a->f_)(a->k_);
+  return NULL;
+}
+
+template<typename F>
+void RunThreads(int n, F * f) {
+  std::vector< ThreadArg<F> > args(n);
+  std::vector<pthread_t> threads(n);
+  std::vector<bool> started(n, false);
+  for (int k=1 ; k<n ; k++) {
+    args[k].f_ = f;
+    args[k].k_ = k;
+    started[k] = (pthread_create(&threads[k], NULL, ThreadMain<F>, &args[k]) == 0);
+    if (!started[k]) (*f)(k);
+  }
+  (*f)(0);
+  for (int k=1 ; k<n ; k++)
+    if (started[k]) pthread_join(threads[k], NULL);
+}
+
+// 1st pass over the lines of chunk k: lines, transaction names (csv),
+// item names (lcm) and items per line
+struct ScanChunks {
+  const char * text_;
+  bool lcm_;
+  int nu_items_; // csv
+  std::vector<std::size_t> bounds_; // chunk k is [bounds_[k], bounds_[k+1])
+  std::vector< std::vector<Line> > lines_;
+  std::vector< std::vector<Token> > trans_names_;
+  std::vector< std::vector<int> > pos_counts_; // as pos_counter in ReadItems
+  std::vector<TokenTable> item_names_;
+  std::vector<long long int> error_line_; // in the chunk, -1 if none
+
+  void operator()(int k) {
+    FindLines(text_, bounds_[k], bounds_[k+1], &lines_[k]);
+    for (std::size_t l=0 ; l<lines_[k].size() ; l++) {
+      const char * p = text_ + lines_[k][l].begin_;
+      const char * e = text_ + lines_[k][l].end_;
+      Token t;
+      int counter = 0;
+      int pos_counter = 0;
+      if (lcm_) {
+        while (NextToken(&p, e, true, &t)) {
+          item_names_[k].Insert(LCMName(t));
+          pos_counter++;
+        }
+      } else {
+        Token name = { p, 0 };
+        if (NextToken(&p, e, false, &t)) name = t;
+        trans_names_[k].push_back(name);
+        while (NextToken(&p, e, false, &t)) {
+          if (t != "0") pos_counter++;
+          counter++;
+        }
+        if (counter > nu_items_ && error_line_[k] < 0) error_line_[k] = l;
+      }
+      pos_counts_[k].push_back(pos_counter);
+    }
+  }
+};
+
+// 2nd pass over the non zero lines [begin_[k], begin_[k+1]). each chunk
+// starts at a block boundary, so the threads set bits in distinct blocks
+template<typename Block>
+struct SetBits {
+  const char * text_;
+  bool lcm_;
+  const std::vector<Line> * lines_;
+  const TokenTable * item_names_; // lcm
+  const std::vector<int> * item_ids_; // lcm, by index in item_names_
+  const VariableBitsetHelper<Block> * bsh_;
+  Block * data_;
+  std::vector<std::size_t> begin_;
+
+  void operator()(int k) {
+    for (std::size_t j=begin_[k] ; j<begin_[k+1] ; j++) {
+      const char * p = text_ + (*lines_)[j].begin_;
+      const char * e = text_ + (*lines_)[j].end_;
+      Token t;
+      if (lcm_) {
+        while (NextToken(&p, e, true, &t)) {
+          int id = (*item_ids_)[item_names_->Find(LCMName(t))];
+          bsh_->Doset(j, bsh_->N(data_, id));
+        }
+      } else {
+        NextToken(&p, e, false, &t); // transaction name
+        int counter = 0;
+        while (NextToken(&p, e, false, &t)) {
+          if (t != "0") bsh_->Doset(j, bsh_->N(data_, counter));
+          counter++;
+        }
+      }
+    }
+  }
+};
+
+} // namespace
+
+template<typename Block>
+void DatabaseReader<Block>::ReadItemsMapped(const std::string & file_name,
+                                            bool lcm,
+                                            int nu_threads,
+                                            int * nu_trans,
+                                            int * nu_items,
+                                            VariableBitsetHelper<Block> ** bsh,
+                                            Block ** data,
+                                            std::vector< std::string > * item_names,
+                                            std::vector< std::string > * transaction_names,
+                                            int * max_item_in_transaction) {
+  MappedFile file(file_name);
+  const char * text = file.Text();
+  nu_threads = std::max(nu_threads, 1);
+
+  // header line of csv
+  std::size_t body = 0;
+  *nu_items = 0;
+  if (!lcm) {
+    std::vector<Line> header;
+    FindLines(text, 0, file.Size(), &header);
+    if (header.empty())
+      throw std::runtime_error(std::string("no header line: ") + file_name);
+    const char * p = text + header[0].begin_;
+    const char * e = text + header[0].end_;
+    Token t;
+    NextToken(&p, e, false, &t); // should be "#gene"
+    while (NextToken(&p, e, false, &t)) {
+      item_names->push_back(t.String());
+      (*nu_items)++;
+    }
+    body = static_cast<const char *>(std::memchr(text, '\n', file.Size())) - text + 1;
+  }
+
+  // 1st pass. chunks start after a '\n'
+  ScanChunks scan;
+  scan.text_ = text;
+  scan.lcm_ = lcm;
+  scan.nu_items_ = *nu_items;
+  scan.bounds_.push_back(body);
+  for (int k=1 ; k<nu_threads ; k++) {
+    std::size_t b = std::max(body + (file.Size() - body) / nu_threads * k,
+                             scan.bounds_.back());
+    const void * nl = (b < file.Size()) ?
+        std::memchr(text + b, '\n', file.Size() - b) : NULL;
+    scan.bounds_.push_back(nl ? static_cast<const char *>(nl) - text + 1 : file.Size());
+  }
+  scan.bounds_.push_back(file.Size());
+  scan.lines_.resize(nu_threads);
+  scan.trans_names_.resize(nu_threads);
+  scan.pos_counts_.resize(nu_threads);
+  scan.item_names_.resize(nu_threads);
+  scan.error_line_.assign(nu_threads, -1);
+  RunThreads(nu_threads, &scan);
+
+  // merge in the order of the lines
+  std::vector<Line> non_zero_lines;
+  *nu_trans = 0;
+  *max_item_in_transaction = -1;
+  for (int k=0 ; k<nu_threads ; k++) {
+    if (scan.error_line_[k] >= 0) {
+      std::ostringstream s;
+      s << "more items than the header in line "
+        << (*nu_trans + scan.error_line_[k] + 2) << ": " << file_name;
+      throw std::runtime_error(s.str());
+    }
+    for (std::size_t l=0 ; l<scan.lines_[k].size() ; l++) {
+      if (!lcm) transaction_names->push_back(scan.trans_names_[k][l].String());
+      if (scan.pos_counts_[k][l] > 0) {
+        non_zero_trans_list_.push_back(*nu_trans);
+        non_zero_lines.push_back(scan.lines_[k][l]);
+        *max_item_in_transaction =
+            std::max(*max_item_in_transaction, scan.pos_counts_[k][l]);
+      }
+      (*nu_trans)++;
+    }
+  }
+
+  // item ids of lcm are in the order of the names, as ReadFirstPhaseLCM
+  TokenTable names;
+  std::vector<int> ids;
+  if (lcm) {
+    for (int k=0 ; k<nu_threads ; k++)
+      for (std::size_t i=0 ; i<scan.item_names_[k].Tokens().size() ; i++)
+        names.Insert(scan.item_names_[k].Tokens()[i]);
+    std::vector< std::pair<std::string, int> > sorted;
+    for (std::size_t i=0 ; i<names.Tokens().size() ; i++)
+      sorted.push_back(std::make_pair(names.Tokens()[i].String(), (int)i));
+    std::sort(sorted.begin(), sorted.end());
+    ids.resize(sorted.size());
+    for (std::size_t id=0 ; id<sorted.size() ; id++) {
+      ids[sorted[id].second] = id;
+      item_name_id_map_.insert(std::make_pair(sorted[id].first, (int)id));
+      item_names->push_back(sorted[id].first);
+    }
+    *nu_items = sorted.size();
+  }
+
+  *bsh = new VariableBitsetHelper<Block>(non_zero_lines.size());
+  *data = (*bsh)->NewArray( (std::size_t)(*nu_items));
+
+  // 2nd pass
+  SetBits<Block> set;
+  set.text_ = text;
+  set.lcm_ = lcm;
+  set.lines_ = &non_zero_lines;
+  set.item_names_ = &names;
+  set.item_ids_ = &ids;
+  set.bsh_ = *bsh;
+  set.data_ = *data;
+  std::size_t bits = VariableBitsetHelper<Block>::traits::bits_per_block;
+  std::size_t per_thread = (non_zero_lines.size() + nu_threads - 1) / nu_threads;
+  per_thread = (per_thread + bits - 1) / bits * bits;
+  for (int k=0 ; k<=nu_threads ; k++)
+    set.begin_.push_back(std::min(per_thread * k, non_zero_lines.size()));
+  RunThreads(nu_threads, &set);
+}
+
 template<typename Block>
 void DatabaseReader<Block>::ReadPosNeg(std::istream & is,
                                        int nu_trans,
@@ -555,7 +941,8 @@ Database<Block>::Database(VariableBitsetHelper<Block> * bsh,
                           Block * pos_array, std::size_t nu_pos_total,
                           int max_item_in_transaction,
                           std::vector< std::string > * item_names,
-                          std::vector< std::string > * trans_names) :
+                          std::vector< std::string > * trans_names,
+                          bool own_arrays) :
     bsh_ (bsh),
     nu_items_ (nu_items),
     item_names_ (item_names),
@@ -567,7 +954,8 @@ Database<Block>::Database(VariableBitsetHelper<Block> * bsh,
     has_positives_ ( !(pos_array == NULL) ),
     posneg_ (pos_array),
     max_t_ (-1),
-    max_item_in_transaction_ (max_item_in_transaction)
+    max_item_in_transaction_ (max_item_in_transaction),
+    own_arrays_ (own_arrays)
 {
   assert(nu_pos_total > 0);
   Init();
@@ -575,8 +963,8 @@ Database<Block>::Database(VariableBitsetHelper<Block> * bsh,
 
 template<typename Block>
 Database<Block>::~Database() {
-  if (data_)   bsh_->Delete(data_);
-  if (posneg_) bsh_->Delete(posneg_);
+  if (data_ && own_arrays_)   bsh_->Delete(data_);
+  if (posneg_ && own_arrays_) bsh_->Delete(posneg_);
 
   if (item_names_) delete item_names_;
   if (transaction_names_) delete transaction_names_;
@@ -104,6 +104,15 @@ public:
 			std::vector<std::string> * item_names,
 			int * max_item_in_transaction);
 
+	// same as ReadItems (csv) or ReadItemsLCM (lcm), from the file mapped
+	// into memory and parsed by nu_threads threads
+	void ReadItemsMapped(const std::string & file_name, bool lcm,
+			int nu_threads, int * nu_trans, int * nu_items,
+			VariableBitsetHelper<Block> ** bsh, Block ** data,
+			std::vector<std::string> * item_names,
+			std::vector<std::string> * transaction_names,
+			int * max_item_in_transaction);
+
 	// if item name is NULL, use numbers
 	std::ostream & PrintLCM(std::ostream & out, int nu_trans, int nu_items,
 			const VariableBitsetHelper<Block> * bsh, const Block * data) const;
@@ -142,11 +151,13 @@ class Database {
 public:
 	typedef VariableBitsetHelper<Block> VBH;
 
+	// own_arrays is false if item_array and pos_array are not deleted here
+	// (e.g. mapped by BinaryDatabase)
 	Database(VariableBitsetHelper<Block> * bsh, Block * item_array,
 			std::size_t nu_trans, std::size_t nu_items, Block * pos_array,
 			std::size_t nu_pos_total, int max_item_in_transaction,
 			std::vector<std::string> * item_names,
-			std::vector<std::string> * trans_names);
+			std::vector<std::string> * trans_names, bool own_arrays = true);
 
 	~Database();
 
@@ -317,6 +328,7 @@ private:
 	int max_t_;
 
 	int max_item_in_transaction_;
+	bool own_arrays_;
 
 	// ----
 	// these are following lampeler variable naming. no trailing _. be careful
@@ -30,6 +30,9 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 #include "gflags/gflags.h"
 
 #include "timer.h"
@@ -39,9 +42,78 @@ namespace lamp_search {
 //Timer g_timer; // global timer
 static Timer &timer = *(Timer::GetInstance());
 
+bool FastClock::tsc_ = false;
+unsigned long long int FastClock::base_tsc_ = 0ull;
+long long int FastClock::base_ns_ = 0ll;
+double FastClock::ns_per_tick_ = 0.0;
+
+long long int FastClock::Monotonic() {
+  long long int nsec;
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ct;
+  clock_gettime(CLOCK_MONOTONIC, &ct);
+  nsec = ct.tv_sec * 1000000000ll + (ct.tv_nsec);
+#else
+  struct timeval t;
+  struct timezone tz;
+  gettimeofday(&t, &tz);
+  nsec = t.tv_sec * 1000000000ll + t.tv_usec * 1000;
+#endif
+  return nsec;
+}
+
+long long int FastClock::Cpu() {
+  long long int nsec;
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ct;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ct);
+  nsec = ct.tv_sec * 1000000000ll + (ct.tv_nsec);
+#else
+  struct rusage r;
+  getrusage(RUSAGE_SELF, &r);
+  nsec = (r.ru_utime.tv_sec + r.ru_stime.tv_sec) * 1000000000ll
+      + (r.ru_utime.tv_usec + r.ru_stime.tv_usec) * 1000ll;
+#endif
+  return nsec;
+}
+
+void FastClock::Calibrate() {
+  tsc_ = false;
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int eax, ebx, ecx, edx;
+  // CPUID.80000007H:EDX[8], invariant TSC
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+    return;
+
+  // 2 milli sec against CLOCK_MONOTONIC. the error is that of the two
+  // clock_gettime, well below 0.01%
+  long long int ns0 = Monotonic();
+  unsigned long long int tsc0 = __builtin_ia32_rdtsc();
+  long long int ns1;
+  do {
+    ns1 = Monotonic();
+  } while (ns1 - ns0 < 2000000ll);
+  unsigned long long int tsc1 = __builtin_ia32_rdtsc();
+  if (tsc1 <= tsc0)
+    return;
+
+  ns_per_tick_ = (double) (ns1 - ns0) / (double) (tsc1 - tsc0);
+  base_tsc_ = tsc1;
+  base_ns_ = ns1;
+  tsc_ = true;
+#endif
+}
+
+namespace {
+struct CalibrateFastClock {
+  CalibrateFastClock() { FastClock::Calibrate(); }
+} calibrate_fast_clock;
+} // namespace
+
 long long int Timer::Start() {
   start_time_ = GetTimeInternal();
   lap_time_ = start_time_;
+  cpu_start_time_ = FastClock::Cpu();
   return start_time_;
 }
 
@@ -57,23 +129,15 @@ long long int Timer::Elapsed() const {
   return ct - start_time_;
 }
 
-long long int Timer::GetTimeInternal() {
-  long long int nsec;
-#ifdef HAVE_CLOCK_GETTIME
-  struct timespec ct;
-  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ct);
-  // clock_gettime(CLOCK_MONOTONIC, &ct);
-  nsec = ct.tv_sec * 1000000000 + (ct.tv_nsec);
-#else
-  struct timeval t;
-  struct timezone tz;
-  gettimeofday(&t, &tz);
-  nsec = t.tv_sec * 1000000000 + t.tv_usec * 1000;
-#endif
-  return nsec;
+long long int Timer::CpuElapsed() const {
+  return FastClock::Cpu() - cpu_start_time_;
 }
 
-
+// used to be CLOCK_PROCESS_CPUTIME_ID, which did not count the time blocked
+// in MPI (idle, probe, recv)
+long long int Timer::GetTimeInternal() {
+  return FastClock::Now();
+}
 
 } // namespace lamp_search
 /* Local Variables:  */
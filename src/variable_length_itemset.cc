@@ -27,11 +27,16 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 #include "utils.h"
 #include "variable_length_itemset.h"
@@ -40,28 +45,244 @@ namespace lamp_search {
 
 VariableLengthItemsetStack::VariableLengthItemsetStack(
 		std::size_t size) :
-		stack_(NULL), top_(NULL) {
+		stack_(NULL), top_(NULL), growth_(FIXED), reserve_(0), bytes_(0ll), peak_bytes_(
+				0ll), spill_(NULL), spilled_bytes_(0ll) {
 	//assert(size >= kMaxItemsPerSet + SENTINEL);
 
 	total_capacity_ = size;
-	stack_ = new int[size];
+	Init(size);
+
+	// sup_hist_ = new int[sup_max_];
+	// for (int i=0;i<sup_max_;i++)
+	//   sup_hist_[i] = 0;
+}
+
+VariableLengthItemsetStack::VariableLengthItemsetStack(Growth growth,
+		std::size_t segment_size, std::size_t max_size, int max_items) :
+		stack_(NULL), top_(NULL), growth_(growth), reserve_(
+				ITM + max_items + 1), bytes_(0ll), peak_bytes_(0ll), spill_(
+				NULL), spilled_bytes_(0ll) {
+	total_capacity_ = max_size;
+	// the header and two of the largest itemsets
+	std::size_t size = std::max(segment_size,
+			(std::size_t) (SENTINEL + 1 + 2 * reserve_));
+	if (growth_ == FIXED)
+		size = max_size;
+	else if (growth_ == CONTIGUOUS)
+		size = std::min(size, max_size);
+	Init(size);
+}
+
+void VariableLengthItemsetStack::Init(std::size_t size) {
+	segment_size_ = size;
+	stack_ = Allocate(size);
+	segments_.push_back(stack_);
 	stack_[TIMESTAMP] = 0; // timestamp // TODO: why the shit do we need to do this???
+	stack_[FLAG] = 0;
 	stack_[SENTINEL] = -1; // sentinel
 	top_ = &(stack_[SENTINEL]); // is this correct?
 	nu_itemset_ = 0;
 	used_capacity_ = SENTINEL + 1; // including sentinel
-
-	// sup_hist_ = new int[sup_max_];
-	// for (int i=0;i<sup_max_;i++)
-	//   sup_hist_[i] = 0;
+	cur_ = 0;
+	next_ = &(stack_[SENTINEL + 1]);
+	end_ = stack_ + segment_size_;
 }
 
 VariableLengthItemsetStack::~VariableLengthItemsetStack() {
-	if (stack_)
-		delete[] stack_;
+	for (std::size_t k = 0; k < segments_.size(); k++)
+		if (segments_[k])
+			delete[] segments_[k];
+	if (spill_)
+		std::fclose(spill_);
 	// if (sup_hist_) delete [] sup_hist_;
 }
 
+int * VariableLengthItemsetStack::Allocate(std::size_t size) {
+	int * array = new int[size];
+	bytes_ += size * (long long int) sizeof(int);
+	peak_bytes_ = std::max(peak_bytes_, bytes_);
+	return array;
+}
+
+void VariableLengthItemsetStack::Free(int * array, std::size_t size) {
+	delete[] array;
+	bytes_ -= size * (long long int) sizeof(int);
+}
+
+void VariableLengthItemsetStack::Grow() {
+	if (growth_ == SEGMENTED) {
+		if (used_capacity_ + 1 + reserve_ > total_capacity_)
+			throw std::runtime_error("VariableLengthItemsetStack is full");
+		NextSegment();
+		return;
+	}
+	// CONTIGUOUS
+	int need = (next_ - stack_) + reserve_ + 1;
+	if (need > total_capacity_)
+		throw std::runtime_error("VariableLengthItemsetStack is full");
+	Reserve(std::min(std::max(2 * segment_size_, need), total_capacity_));
+}
+
+bool VariableLengthItemsetStack::CanPush(
+		const std::vector<int> & sizes) const {
+	// replay PushPre / Grow on the counters only
+	long long int used = used_capacity_;
+	long long int pos = next_
+			- (growth_ == SEGMENTED ? segments_[cur_] : stack_);
+	long long int size = segment_size_;
+	for (std::size_t i = 0; i < sizes.size(); i++) {
+		if (growth_ != FIXED && pos + reserve_ >= size) {
+			if (growth_ == SEGMENTED) {
+				if (used + 1 + reserve_ > total_capacity_)
+					return false;
+				used++; // the marker, the tail of the segment is wasted
+				pos = 1;
+			} else {
+				long long int need = pos + reserve_ + 1;
+				if (need > total_capacity_)
+					return false;
+				size = std::min(std::max(2 * size, need),
+						(long long int) total_capacity_);
+			}
+		}
+		used += sizes[i];
+		pos += sizes[i];
+	}
+	return used <= total_capacity_;
+}
+
+void VariableLengthItemsetStack::Reserve(int size) {
+	if (size <= segment_size_)
+		return;
+	if (growth_ != CONTIGUOUS || size > total_capacity_)
+		throw std::runtime_error("VariableLengthItemsetStack is full");
+	int * array = Allocate(size);
+	std::copy(stack_, next_, array);
+	top_ = array + (top_ - stack_);
+	next_ = array + (next_ - stack_);
+	Free(stack_, segment_size_);
+	stack_ = segments_[0] = array;
+	segment_size_ = size;
+	end_ = stack_ + segment_size_;
+}
+
+void VariableLengthItemsetStack::NextSegment() {
+	*next_ = cur_ + 1; // the next itemset is in the next segment
+	segment_used_.push_back(next_ - segments_[cur_]);
+	cur_++;
+	if (cur_ == (int) segments_.size())
+		segments_.push_back(NULL);
+	if (segments_[cur_] == NULL)
+		segments_[cur_] = Allocate(segment_size_);
+	segments_[cur_][0] = -1; // sentinel for RemoveOneItemset
+	next_ = segments_[cur_] + 1;
+	end_ = segments_[cur_] + segment_size_;
+	used_capacity_++;
+	// the segments between the first and the current are finished
+	if (spill_ && cur_ >= 2)
+		SpillSegment(cur_ - 1);
+}
+
+void VariableLengthItemsetStack::PrevSegment() {
+	used_capacity_--; // the sentinel
+	cur_--;
+	if (segments_[cur_] == NULL)
+		LoadSegment(cur_);
+	next_ = segments_[cur_] + segment_used_.back();
+	end_ = segments_[cur_] + segment_size_;
+	segment_used_.pop_back();
+	FreeSpare();
+}
+
+void VariableLengthItemsetStack::FreeSpare() {
+	for (std::size_t k = cur_ + 2; k < segments_.size(); k++)
+		if (segments_[k]) {
+			Free(segments_[k], segment_size_);
+			segments_[k] = NULL;
+		}
+}
+
+bool VariableLengthItemsetStack::Spill(const std::string & file_name) {
+	if (growth_ != SEGMENTED)
+		return false;
+	spill_ = std::fopen(file_name.c_str(), "w+b");
+	if (spill_ == NULL)
+		return false;
+	std::remove(file_name.c_str()); // still open
+	return true;
+}
+
+void VariableLengthItemsetStack::SpillSegment(int k) {
+	// with its marker. at the same offset as in At
+	std::size_t size = segment_used_[k] + 1;
+	if (fseeko(spill_, (off_t) k * segment_size_ * sizeof(int), SEEK_SET)
+			!= 0
+			|| std::fwrite(segments_[k], sizeof(int), size, spill_) != size)
+		throw std::runtime_error("VariableLengthItemsetStack: spill failed");
+	spilled_bytes_ += size * sizeof(int);
+	Free(segments_[k], segment_size_);
+	segments_[k] = NULL;
+}
+
+void VariableLengthItemsetStack::LoadSegment(int k) {
+	std::size_t size = segment_used_[k] + 1;
+	segments_[k] = Allocate(segment_size_);
+	if (fseeko(spill_, (off_t) k * segment_size_ * sizeof(int), SEEK_SET)
+			!= 0
+			|| std::fread(segments_[k], sizeof(int), size, spill_) != size)
+		throw std::runtime_error("VariableLengthItemsetStack: reload failed");
+}
+
+void VariableLengthItemsetStack::CopyItemsets(std::vector<int> * dst) const {
+	for (int k = 0; k <= cur_; k++) {
+		std::size_t begin = (k == 0) ? SENTINEL + 1 : 1;
+		std::size_t end =
+				(k == cur_) ? next_ - segments_[k] : segment_used_[k];
+		if (segments_[k]) {
+			dst->insert(dst->end(), segments_[k] + begin, segments_[k] + end);
+			continue;
+		}
+		std::size_t size = dst->size();
+		dst->resize(size + end - begin);
+		if (end > begin
+				&& (fseeko(spill_,
+						((off_t) k * segment_size_ + begin) * sizeof(int),
+						SEEK_SET) != 0
+						|| std::fread(&((*dst)[size]), sizeof(int),
+								end - begin, spill_) != end - begin))
+			throw std::runtime_error(
+					"VariableLengthItemsetStack: reload failed");
+	}
+}
+
+long long int VariableLengthItemsetStack::Offset(const int * index) const {
+	if (growth_ != SEGMENTED)
+		return index - stack_;
+	std::less<const int *> less;
+	for (int k = cur_; k >= 0; k--)
+		if (segments_[k] && !less(index, segments_[k])
+				&& less(index, segments_[k] + segment_size_))
+			return (long long int) k * segment_size_ + (index - segments_[k]);
+	assert(0);
+	return -1ll;
+}
+
+const int * VariableLengthItemsetStack::At(long long int offset) const {
+	int k = (int) (offset / segment_size_);
+	if (segments_[k])
+		return segments_[k] + (offset - (long long int) k * segment_size_);
+	// spilled. the head, then the items
+	reload_.resize(ITM);
+	if (fseeko(spill_, (off_t) offset * sizeof(int), SEEK_SET) != 0
+			|| std::fread(&(reload_[0]), sizeof(int), ITM, spill_) != ITM)
+		throw std::runtime_error("VariableLengthItemsetStack: reload failed");
+	std::size_t num = GetItemNum(&(reload_[0]));
+	reload_.resize(ITM + num);
+	if (num > 0 && std::fread(&(reload_[ITM]), sizeof(int), num, spill_) != num)
+		throw std::runtime_error("VariableLengthItemsetStack: reload failed");
+	return &(reload_[0]);
+}
+
 //// NoSort?
 //int* VariableLengthItemsetStack::Push(int * item, int support_num) {
 //	PushPre();
@@ -72,15 +293,17 @@ VariableLengthItemsetStack::~VariableLengthItemsetStack() {
 //	return ret;
 //}
 
-std::vector<int> VariableLengthItemsetStack::getItems(int* index) {
+std::vector<int> VariableLengthItemsetStack::getItems(const int* index) {
 	int numberOfItems = GetItemNum(index);
-	int* array = GetItemArray(index);
+	const int* array = GetItemArray(index);
 	std::vector<int> items(array, array + numberOfItems);
 	return items;
 }
 
 void VariableLengthItemsetStack::PushPre() {
-	top_ = &(stack_[used_capacity_]);
+	if (growth_ != FIXED && next_ + reserve_ >= end_)
+		Grow();
+	top_ = next_;
 	SetItemNum(top_, 0); // clear item num
 	SetSup(top_, 0); // clear sup
 	nu_itemset_++;
@@ -89,6 +312,7 @@ void VariableLengthItemsetStack::PushPre() {
 void VariableLengthItemsetStack::PushPost() {
 	int * index = Top();
 	used_capacity_ += ITM + GetItemNum(index);
+	next_ = index + ITM + GetItemNum(index);
 	SortOneSet(index);
 	// IncSupHistogram(index);
 }
@@ -96,6 +320,7 @@ void VariableLengthItemsetStack::PushPost() {
 void VariableLengthItemsetStack::PushPostNoSort() {
 	int * index = Top();
 	used_capacity_ += ITM + GetItemNum(index);
+	next_ = index + ITM + GetItemNum(index);
 	// IncSupHistogram(index);
 }
 
@@ -215,7 +440,12 @@ int * VariableLengthItemsetStack::NextItemset(int * index) const {
 	if (index == top_)
 		return NULL;
 	int num = GetItemNum(index);
-	return index + num + ITM;
+	int * next = index + num + ITM;
+	if (*next >= 0) { // continues in the next segment
+		assert(segments_[*next] != NULL);
+		next = segments_[*next] + 1;
+	}
+	return next;
 }
 
 bool VariableLengthItemsetStack::Exist(const int * index,
@@ -239,7 +469,12 @@ int * VariableLengthItemsetStack::Top() const {
 int * VariableLengthItemsetStack::FirstItemset() const {
 	if (NuItemset() == 0)
 		return NULL;
-	return &(stack_[SENTINEL + 1]);
+	int * first = &(stack_[SENTINEL + 1]);
+	if (*first >= 0) { // the first segment is empty
+		assert(segments_[*first] != NULL);
+		first = segments_[*first] + 1;
+	}
+	return first;
 }
 
 void VariableLengthItemsetStack::RemoveOneItemset() {
@@ -249,9 +484,17 @@ void VariableLengthItemsetStack::RemoveOneItemset() {
 	// DecSupHistogram(index);
 	used_capacity_ -= ITM + GetItemNum(index);
 	nu_itemset_--;
+	next_ = index;
 	top_--;
 	while (*top_ >= 0)
 		top_--;
+	// the sentinel of an empty segment: the top is in the one below
+	while (cur_ > 0 && top_ == segments_[cur_]) {
+		PrevSegment();
+		top_ = next_ - 1;
+		while (*top_ >= 0)
+			top_--;
+	}
 	assert(Top()[NUM] < 0);
 }
 
@@ -265,82 +508,86 @@ void VariableLengthItemsetStack::RemoveOneItemset() {
 
 int VariableLengthItemsetStack::Split(
 		VariableLengthItemsetStack * dst) {
-	if (NuItemset() == 0)
-		return 0;
-
-	int * first = FirstItemset();
-	int * next_top = first;
-	int * head = NextItemset(first);
-	int * give = head;
-	if (give == NULL)
+	// give the 2nd, 4th, ... itemsets from the bottom
+	std::size_t n = NuItemset();
+	if (n < 2)
 		return 0;
-	int * keep = NextItemset(give);
-	int * next;
-	if (keep == NULL)
-		next = NULL;
-	else
-		next = NextItemset(keep);
+	std::vector<bool> give(n, false);
+	for (std::size_t i = 1; i < n; i += 2)
+		give[i] = true;
+	return SplitSelect(dst, give);
+}
 
-	int * dst_head = dst->FirstItemset();
+int VariableLengthItemsetStack::SplitSelect(
+		VariableLengthItemsetStack * dst, const std::vector<bool> & give) {
+	assert((int) give.size() == NuItemset());
 	assert(dst->NuItemset() == 0);
 
+	int * src = FirstItemset();
+	// next position for kept itemsets, never after src
+	int w = 0;
+	int * head = &(stack_[SENTINEL + 1]);
+	int * next_top = NULL;
 	int given_num = 0;
-
-	while (true) {
-		dst->PushPre();
-		dst_head = dst->Top();
-		CopyItem(give, dst_head);
-		dst->PushPostNoSort();
-		given_num++;
-
-		// DecSupHistogram(give);
-		used_capacity_ -= ITM + GetItemNum(give);
-		nu_itemset_--;
-
-		if (keep == NULL)
-			break;
-
-		next_top = head;
-		CopyItem(keep, head);
-		head = NextItemset(head);
-
-		if (next == NULL)
-			break;
-
-		give = next;
-		keep = NextItemset(give);
-		if (keep == NULL)
-			next = NULL;
-		else
-			next = NextItemset(keep);
+	std::vector<int> used;
+
+	std::size_t n = NuItemset();
+	for (std::size_t i = 0; i < n; i++) {
+		int * next = NextItemset(src);
+		int size = ITM + GetItemNum(src);
+		if (give[i]) {
+			dst->PushPre();
+			CopyItem(src, dst->Top());
+			dst->PushPostNoSort();
+			given_num++;
+
+			used_capacity_ -= size;
+			nu_itemset_--;
+		} else {
+			if (growth_ == SEGMENTED
+					&& head + size + 1 > segments_[w] + segment_size_) {
+				// src is in a later segment
+				*head = w + 1;
+				used.push_back(head - segments_[w]);
+				w++;
+				head = segments_[w] + 1;
+			}
+			next_top = head;
+			if (head != src)
+				CopyItem(src, head); // head < src, forward copy is safe
+			head += size;
+		}
+		src = next;
 	}
-	top_ = next_top;
-	// update
-	// top_, used_capacity_, nu_itemset_, sup_hist_
+	if (next_top != NULL)
+		top_ = next_top;
+	else
+		top_ = &(stack_[SENTINEL]); // all given
+	// the segments after w are empty
+	used_capacity_ -= cur_ - w; // their sentinels
+	cur_ = w;
+	segment_used_.swap(used);
+	next_ = head;
+	end_ = segments_[cur_] + segment_size_;
+	FreeSpare();
 	return given_num;
 }
 
 bool VariableLengthItemsetStack::Merge(
 		VariableLengthItemsetStack * src) {
 	// check capacity
-	if (this->UsedCapacity() + (src->UsedCapacity() - SENTINEL - 1)
-			> this->TotalCapacity())
+	std::vector<int> sizes;
+	for (int * p = src->FirstItemset(); p != NULL; p = src->NextItemset(p))
+		sizes.push_back(ITM + GetItemNum(p));
+	if (!CanPush(sizes))
 		return false;
 
-	int * next_top = this->top_;
-	int di = this->used_capacity_;
-	// note: si starts from (SENTINEL+1) to skip timestamp and sentinel
-	for (int si = SENTINEL + 1; si < src->used_capacity_; si++) {
-		this->stack_[di] = src->stack_[si];
-		if (this->stack_[di] < 0)
-			next_top = &(this->stack_[di]);
-		di++;
+	for (int * p = src->FirstItemset(); p != NULL; p = src->NextItemset(p)) {
+		PushPre();
+		CopyItem(p, Top());
+		PushPostNoSort();
 	}
 
-	this->top_ = next_top;
-	this->used_capacity_ += src->UsedCapacity() - SENTINEL - 1;
-	this->nu_itemset_ += src->nu_itemset_;
-
 	// for (int i=0;i<sup_max_;i++)
 	//   this->sup_hist_[i] += src->sup_hist_[i];
 
@@ -351,28 +598,21 @@ bool VariableLengthItemsetStack::Merge(
 
 bool VariableLengthItemsetStack::MergeStack(int * src_st, int size) {
 	// check capacity
-	if ((this->UsedCapacity() + size) > this->TotalCapacity())
+	std::vector<int> sizes;
+	for (int si = 0; si < size; si += sizes.back())
+		sizes.push_back(ITM + GetItemNum(&(src_st[si])));
+	if (!CanPush(sizes))
 		return false;
 
-	int * next_top = this->top_;
-	int di = this->used_capacity_;
-
-	for (int si = 0; si < size; si++) {
-		this->stack_[di] = src_st[si];
-
-		// update nu_itemset_ and sup_hist_
-		if (src_st[si] < 0) {
-			next_top = &(this->stack_[di]);
-			// IncSupHistogram(&(src_st[si]));
-			nu_itemset_++;
-		}
-
-		di++;
+	// itemsets start with negative NUM
+	int si = 0;
+	while (si < size) {
+		PushPre();
+		CopyItem(&(src_st[si]), Top());
+		PushPostNoSort();
+		si += ITM + GetItemNum(&(src_st[si]));
 	}
 
-	this->top_ = next_top;
-	this->used_capacity_ += size;
-
 	return true;
 
 	// todo: limit maximum amount of give to (stack size) / z ???
@@ -382,6 +622,11 @@ void VariableLengthItemsetStack::Clear() {
 	nu_itemset_ = 0;
 	used_capacity_ = SENTINEL + 1; // including sentinel
 	top_ = &(stack_[SENTINEL]); // is this correct?
+	cur_ = 0;
+	segment_used_.clear();
+	next_ = &(stack_[SENTINEL + 1]);
+	end_ = stack_ + segment_size_;
+	FreeSpare();
 
 	// for (int i=0;i<sup_max_;i++)
 	//   sup_hist_[i] = 0;
@@ -30,6 +30,7 @@
 #ifndef _LAMP_SEARCH_VARIABLE_LENGTH_ITEMSET_H_
 #define _LAMP_SEARCH_VARIABLE_LENGTH_ITEMSET_H_
 
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -42,9 +43,28 @@ namespace lamp_search {
 // It hardly makes sense without any comments.
 
 /** variable length itemset data
- *  packed to a continuous memory region */
+ *  packed to a continuous memory region
+ *
+ *  A growable stack (not FIXED) checks the room for the largest itemset in
+ *  PushPre and grows up to its maximum size, or throws std::runtime_error.
+ *  SEGMENTED keeps a list of arrays of segment_size ints. An itemset never
+ *  crosses two segments, and the head of the next itemset in a finished
+ *  segment is the index of the next segment (non-negative, unlike NUM), so
+ *  pointers into the stack stay valid and NextItemset follows the segments.
+ *  Stack() is then only the first segment: use CopyItemsets, Offset and At
+ *  instead of the array.
+ *
+ *  With Spill, a SEGMENTED stack writes each finished segment to a file and
+ *  frees it, keeping only the first and the current segment in memory. Push
+ *  and Pop work as usual and At reads the itemset back from the file, but
+ *  FirstItemset / NextItemset must not reach a spilled segment. */
 class VariableLengthItemsetStack {
 public:
+	enum Growth {
+		FIXED = 0, // one array of size ints, no check
+		CONTIGUOUS, // one array, reallocated. pointers into it change
+		SEGMENTED, // list of arrays. pointers stay valid
+	};
 
 	static const int TIMESTAMP = 0;
 	static const int FLAG = 1; // used for lifeline flag
@@ -65,6 +85,10 @@ public:
 	// todo: add check. size must be greater than kMaxItemsPerSet
 	// should be like 256 * kMaxItemsPerSet or something
 	VariableLengthItemsetStack(std::size_t size);
+	// grows up to max_size ints from an array of segment_size ints.
+	// max_items: the most items in one itemset
+	VariableLengthItemsetStack(Growth growth, std::size_t segment_size,
+			std::size_t max_size, int max_items);
 
 	// VariableLengthItemsetStack(std::size_t size, int sup_max);
 
@@ -72,7 +96,7 @@ public:
 
 //	int* Push(int * item, int support_num);
 
-	std::vector<int> getItems(int* index);
+	std::vector<int> getItems(const int* index);
 
 	// move top_ and inc nu_itemset_;
 	void PushPre();
@@ -104,10 +128,19 @@ public:
 	// todo: test
 	bool Exist(const int * index, int item) const;
 
-	// return ptr to stack_
+	// return ptr to stack_ (the first segment if SEGMENTED)
 	int * Stack() const {
 		return stack_;
 	}
+	// CONTIGUOUS: make Stack() hold at least size ints, e.g. to receive
+	void Reserve(int size);
+
+	// append the itemsets from the bottom to dst, as for MergeStack
+	void CopyItemsets(std::vector<int> * dst) const;
+	// position of an itemset in ints from the bottom, for At
+	long long int Offset(const int * index) const;
+	// the itemset at Offset. if it is spilled, a copy valid until the next At
+	const int * At(long long int offset) const;
 
 	// return ptr to top item
 	int * Top() const;
@@ -124,6 +157,11 @@ public:
 	// give half of entries to dst (dst should be empty)
 	// return given itemset num
 	int Split(VariableLengthItemsetStack * dst);
+	// give itemsets with give[i] == true (i-th from the bottom) to dst
+	// (dst should be empty), keep the rest in order
+	// return given itemset num
+	int SplitSelect(VariableLengthItemsetStack * dst,
+			const std::vector<bool> & give);
 	// merge with entries in another stack
 	bool Merge(VariableLengthItemsetStack * src);
 	// merge with entries in array
@@ -145,6 +183,7 @@ public:
 	// when to call this? every time adding item?
 	bool Full() const;
 
+	// the most ints the stack can hold
 	int TotalCapacity() const {
 		return total_capacity_;
 	}
@@ -171,6 +210,21 @@ public:
 		return stack_[FLAG];
 	}
 
+	// SEGMENTED: write finished segments to file_name (removed at once,
+	// the space is freed when the stack is deleted). false if not opened
+	bool Spill(const std::string & file_name);
+	// allocated bytes: current, largest so far
+	long long int Bytes() const {
+		return bytes_;
+	}
+	long long int PeakBytes() const {
+		return peak_bytes_;
+	}
+	// bytes written by Spill
+	long long int SpilledBytes() const {
+		return spilled_bytes_;
+	}
+
 	// idea
 	// push procedure
 	// PushPre() (just increase nu_itemset and return next pointer)
@@ -201,6 +255,39 @@ private:
 
 	std::size_t nu_itemset_;
 
+	Growth growth_;
+	int segment_size_; // ints of each segment. the array size if not SEGMENTED
+	int reserve_; // room checked by PushPre: the largest itemset and a marker
+	std::vector<int *> segments_; // segments_[0] == stack_. NULL if freed
+	std::vector<int> segment_used_; // ints used in the segments below cur_
+	int cur_; // segment of next_
+	int * next_; // the head of the next itemset
+	int * end_; // end of the segment of next_
+	long long int bytes_;
+	long long int peak_bytes_;
+
+	std::FILE * spill_;
+	long long int spilled_bytes_;
+	mutable std::vector<int> reload_; // itemset read back by At
+
+	void Init(std::size_t size);
+	int * Allocate(std::size_t size);
+	void Free(int * array, std::size_t size);
+	// make room for reserve_ ints at next_
+	void Grow();
+	// true if itemsets of these sizes (ITM + item num) can be pushed
+	// without Grow failing, so that Merge never stops halfway
+	bool CanPush(const std::vector<int> & sizes) const;
+	void NextSegment();
+	void PrevSegment();
+	void SpillSegment(int k);
+	void LoadSegment(int k);
+	// free segments above cur_, but one
+	void FreeSpare();
+
+	VariableLengthItemsetStack(const VariableLengthItemsetStack&);
+	VariableLengthItemsetStack& operator=(const VariableLengthItemsetStack&);
+
 	// int sup_max_;
 	// int * sup_hist_; // sup histogram
 };
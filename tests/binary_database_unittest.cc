@@ -0,0 +1,195 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "database.h"
+#include "binary_database.h"
+
+using namespace lamp_search;
+
+namespace {
+const char * kItemFile = "../../../samples/sample_data/sample_item.csv";
+const char * kPosFile = "../../../samples/sample_data/sample_expression_over1.csv";
+const char * kBinFile = "binary_database_unittest.bin";
+
+std::string ReadAll(const char * file_name) {
+  std::ifstream ifs(file_name, std::ios::in | std::ios::binary);
+  std::stringstream s;
+  s << ifs.rdbuf();
+  return s.str();
+}
+
+void WriteAll(const char * file_name, const std::string & s) {
+  std::ofstream ofs(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  ofs << s;
+}
+}
+
+// the sample files, also written to kBinFile
+struct Sample {
+  Sample() {
+    item_names_ = new std::vector< std::string >;
+    trans_names_ = new std::vector< std::string >;
+    std::ifstream ifs1(kItemFile, std::ios::in);
+    reader_.ReadItems(ifs1, &nu_trans_, &nu_items_, &bsh_, &data_,
+                      item_names_, trans_names_, &max_item_in_transaction_);
+    std::ifstream ifs2(kPosFile, std::ios::in);
+    reader_.ReadPosNeg(ifs2, nu_trans_, trans_names_, &nu_pos_total_, bsh_,
+                       &positive_);
+    BinaryDatabase<uint64>::Write(kBinFile, bsh_, data_, nu_trans_, nu_items_,
+                                  positive_, nu_pos_total_,
+                                  max_item_in_transaction_,
+                                  item_names_, trans_names_);
+  }
+
+  ~Sample() {
+    std::remove(kBinFile);
+    bsh_->Delete(data_);
+    bsh_->Delete(positive_);
+    delete bsh_;
+    delete item_names_;
+    delete trans_names_;
+  }
+
+  DatabaseReader<uint64> reader_;
+  VariableBitsetHelper<uint64> * bsh_;
+  uint64 * data_;
+  uint64 * positive_;
+  int nu_trans_;
+  int nu_items_;
+  int nu_pos_total_;
+  int max_item_in_transaction_;
+  std::vector< std::string > * item_names_;
+  std::vector< std::string > * trans_names_;
+};
+
+TEST (BinaryDatabaseTest, MapTest) {
+  Sample f;
+  EXPECT_TRUE(BinaryDatabase<uint64>::IsBinary(kBinFile));
+  EXPECT_FALSE(BinaryDatabase<uint64>::IsBinary(kItemFile));
+
+  BinaryDatabase<uint64> b;
+  b.Map(kBinFile);
+  ASSERT_TRUE(b.Mapped());
+  EXPECT_EQ((int)f.bsh_->nu_bits, b.NuBits());
+  EXPECT_EQ(f.nu_trans_, b.NuTransaction());
+  EXPECT_EQ(f.nu_items_, b.NuItems());
+  EXPECT_EQ(f.nu_pos_total_, b.PosTotal());
+  EXPECT_EQ(f.max_item_in_transaction_, b.MaxItemInTransaction());
+  EXPECT_EQ(0u, (std::size_t)b.Data() % 64);
+  EXPECT_EQ(0u, (std::size_t)b.PosNeg() % 64);
+  EXPECT_EQ(0, std::memcmp(f.data_, b.Data(),
+                           f.bsh_->NewArraySize(f.nu_items_) * sizeof(uint64)));
+  EXPECT_EQ(0, std::memcmp(f.positive_, b.PosNeg(),
+                           f.bsh_->NuBlocks() * sizeof(uint64)));
+
+  std::vector< std::string > names;
+  b.ItemNames(&names);
+  EXPECT_EQ(*f.item_names_, names);
+  b.TransactionNames(&names);
+  EXPECT_EQ(*f.trans_names_, names);
+
+  // same database as from the text files
+  VariableBitsetHelper<uint64> bsh(b.NuBits());
+  {
+    Database<uint64> d(&bsh, const_cast<uint64 *>(b.Data()),
+                       b.NuTransaction(), b.NuItems(),
+                       const_cast<uint64 *>(b.PosNeg()), b.PosTotal(),
+                       b.MaxItemInTransaction(), NULL, NULL, false);
+    std::stringstream s1, s2;
+    d.DumpItems(s1);
+    d.DumpPosNeg(s2);
+    EXPECT_EQ("100000111111\n"
+              "100001101011\n"
+              "100010101011\n"
+              "011101100100\n", s1.str());
+    EXPECT_EQ("110000101011\n", s2.str());
+    EXPECT_EQ(5, d.MaxT());
+  }
+
+  b.Unmap();
+  EXPECT_FALSE(b.Mapped());
+}
+
+TEST (BinaryDatabaseTest, NoPositiveTest) {
+  Sample f;
+  BinaryDatabase<uint64>::Write(kBinFile, f.bsh_, f.data_, f.nu_trans_, f.nu_items_,
+                                NULL, 0, f.max_item_in_transaction_, NULL, NULL);
+  BinaryDatabase<uint64> b;
+  b.Map(kBinFile);
+  EXPECT_EQ(NULL, b.PosNeg());
+  EXPECT_EQ(0, std::memcmp(f.data_, b.Data(),
+                           f.bsh_->NewArraySize(f.nu_items_) * sizeof(uint64)));
+  std::vector< std::string > names;
+  b.ItemNames(&names);
+  EXPECT_TRUE(names.empty());
+}
+
+TEST (BinaryDatabaseTest, BrokenTest) {
+  Sample f;
+  std::string s = ReadAll(kBinFile);
+  BinaryDatabase<uint64> b;
+
+  // one bit of the item bitsets
+  std::string broken = s;
+  broken[128] ^= 1;
+  WriteAll(kBinFile, broken);
+  EXPECT_THROW(b.Map(kBinFile), std::runtime_error);
+  EXPECT_FALSE(b.Mapped());
+
+  // written with the other byte order
+  broken = s;
+  std::swap(broken[8], broken[11]);
+  std::swap(broken[9], broken[10]);
+  WriteAll(kBinFile, broken);
+  EXPECT_TRUE(BinaryDatabase<uint64>::IsBinary(kBinFile));
+  EXPECT_THROW(b.Map(kBinFile), std::runtime_error);
+
+  // truncated
+  WriteAll(kBinFile, s.substr(0, s.size() - 64));
+  EXPECT_THROW(b.Map(kBinFile), std::runtime_error);
+
+  WriteAll(kBinFile, s);
+  b.Map(kBinFile);
+  EXPECT_TRUE(b.Mapped());
+}
+
+/* Local Variables:  */
+/* compile-command: "scons -u" */
+/* End:              */
@@ -0,0 +1,186 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "database.h"
+
+using namespace lamp_search;
+
+namespace {
+const char * kTmpFile = "database_mapped_unittest.txt";
+
+// xorshift, so that the files are the same everywhere
+struct Rand {
+  explicit Rand(uint64 seed) : x_(seed * 2654435761ull + 1) {}
+  int Int(int n) {
+    x_ ^= x_ << 13;
+    x_ ^= x_ >> 7;
+    x_ ^= x_ << 17;
+    return (int)(x_ % n);
+  }
+  uint64 x_;
+};
+
+// reads file_name with the stream reader and with ReadItemsMapped on
+// 1, 2, 3 and 8 threads, and compares all results
+void ExpectSameAsStream(const char * file_name, bool lcm) {
+  DatabaseReader<uint64> r1;
+  VariableBitsetHelper<uint64> * bsh1 = NULL;
+  uint64 * data1 = NULL;
+  int nu_trans1, nu_items1, max1;
+  std::vector< std::string > items1, trans1;
+  {
+    std::ifstream ifs(file_name, std::ios::in);
+    if (lcm)
+      r1.ReadItemsLCM(ifs, &nu_trans1, &nu_items1, &bsh1, &data1, &items1, &max1);
+    else
+      r1.ReadItems(ifs, &nu_trans1, &nu_items1, &bsh1, &data1, &items1, &trans1, &max1);
+  }
+
+  const int threads[] = { 1, 2, 3, 8 };
+  for (std::size_t i=0 ; i<sizeof(threads) / sizeof(threads[0]) ; i++) {
+    DatabaseReader<uint64> r2;
+    VariableBitsetHelper<uint64> * bsh2 = NULL;
+    uint64 * data2 = NULL;
+    int nu_trans2, nu_items2, max2;
+    std::vector< std::string > items2, trans2;
+    r2.ReadItemsMapped(file_name, lcm, threads[i], &nu_trans2, &nu_items2,
+                       &bsh2, &data2, &items2, &trans2, &max2);
+
+    EXPECT_EQ(nu_trans1, nu_trans2) << threads[i];
+    EXPECT_EQ(nu_items1, nu_items2) << threads[i];
+    EXPECT_EQ(max1, max2) << threads[i];
+    EXPECT_EQ(items1, items2) << threads[i];
+    EXPECT_EQ(trans1, trans2) << threads[i];
+    EXPECT_EQ(r1.non_zero_trans_list_, r2.non_zero_trans_list_) << threads[i];
+    EXPECT_EQ(r1.item_name_id_map_, r2.item_name_id_map_) << threads[i];
+    ASSERT_EQ(bsh1->nu_bits, bsh2->nu_bits) << threads[i];
+    if (data1 != NULL) {
+      EXPECT_EQ(0, std::memcmp(data1, data2, bsh1->NewArraySize(nu_items1)
+                               * sizeof(uint64))) << threads[i];
+    }
+
+    if (data2 != NULL) bsh2->Delete(data2);
+    delete bsh2;
+  }
+  if (data1 != NULL) bsh1->Delete(data1);
+  delete bsh1;
+}
+}
+
+TEST (DatabaseMappedTest, SampleTest) {
+  ExpectSameAsStream("../../../samples/sample_data/sample_item.csv", false);
+  ExpectSameAsStream("../../../samples/sample_data/sample_item4lcm.csv", true);
+}
+
+TEST (DatabaseMappedTest, DatabaseTest) {
+  // the positive file and Database on top of the mapped reader
+  DatabaseReader<uint64> reader;
+  VariableBitsetHelper<uint64> * bsh = NULL;
+  uint64 * data = NULL;
+  uint64 * positive = NULL;
+  int nu_trans, nu_items, nu_pos_total, max_item_in_transaction;
+  std::vector< std::string > * item_names = new std::vector< std::string >;
+  std::vector< std::string > * transaction_names = new std::vector< std::string >;
+  reader.ReadItemsMapped("../../../samples/sample_data/sample_item.csv", false, 4,
+                         &nu_trans, &nu_items, &bsh, &data, item_names,
+                         transaction_names, &max_item_in_transaction);
+  std::ifstream ifs("../../../samples/sample_data/sample_expression_over1.csv",
+                    std::ios::in);
+  reader.ReadPosNeg(ifs, nu_trans, transaction_names, &nu_pos_total, bsh, &positive);
+
+  Database<uint64> d(bsh, data, nu_trans, nu_items, positive, nu_pos_total,
+                     max_item_in_transaction, item_names, transaction_names);
+  std::stringstream s1, s2;
+  d.DumpItems(s1);
+  d.DumpPosNeg(s2);
+  EXPECT_EQ("100000111111\n"
+            "100001101011\n"
+            "100010101011\n"
+            "011101100100\n", s1.str());
+  EXPECT_EQ("110000101011\n", s2.str());
+  EXPECT_EQ(4, d.MaxItemInTransaction());
+  EXPECT_EQ(5, d.MaxT());
+  EXPECT_EQ(15, d.NuTransaction());
+  EXPECT_EQ(7, d.PosTotal());
+  delete bsh;
+}
+
+TEST (DatabaseMappedTest, RandomCSVTest) {
+  // more transactions than one block per thread, extra separators, \r\n,
+  // all zero lines and a last line without \n
+  Rand rand(1);
+  {
+    std::ofstream ofs(kTmpFile, std::ios::out | std::ios::trunc);
+    ofs << "#gene";
+    for (int i=0 ; i<20 ; i++) ofs << ",i" << i;
+    ofs << "\n";
+    for (int t=0 ; t<1000 ; t++) {
+      ofs << "t" << t;
+      bool zero = (rand.Int(10) == 0);
+      for (int i=0 ; i<20 ; i++) {
+        ofs << (rand.Int(7) == 0 ? ", " : ",");
+        ofs << ((zero || rand.Int(3) != 0) ? "0" : "1");
+      }
+      ofs << ((t % 5 == 0) ? " \r\n" : "\n");
+    }
+    ofs << "t1000,1,1";
+  }
+  ExpectSameAsStream(kTmpFile, false);
+  std::remove(kTmpFile);
+}
+
+TEST (DatabaseMappedTest, RandomLCMTest) {
+  Rand rand(2);
+  {
+    std::ofstream ofs(kTmpFile, std::ios::out | std::ios::trunc);
+    for (int t=0 ; t<1000 ; t++) {
+      int n = rand.Int(6);
+      for (int i=0 ; i<n ; i++)
+        ofs << (rand.Int(5) == 0 ? "\t" : " ") << "a" << rand.Int(50);
+      ofs << ((t % 7 == 0) ? " \n" : "\n");
+    }
+    ofs << "a1 a2";
+  }
+  ExpectSameAsStream(kTmpFile, true);
+  std::remove(kTmpFile);
+}
+
+/* Local Variables:  */
+/* compile-command: "scons -u" */
+/* End:              */
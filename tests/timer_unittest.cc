@@ -0,0 +1,69 @@
+// Copyright (c) 2016, Kazuki Yoshizoe
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// AREDISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <time.h>
+
+#include "gtest/gtest.h"
+
+#include "timer.h"
+
+using namespace lamp_search;
+
+TEST (TimerTest, FastClockTest) {
+  // monotonic
+  long long int prev = FastClock::Now();
+  for (int i = 0; i < 100000; i++) {
+    long long int t = FastClock::Now();
+    EXPECT_LE(prev, t);
+    prev = t;
+  }
+  if (FastClock::UsesTsc()) {
+    EXPECT_LT(0.0, FastClock::NsPerTick());
+  }
+}
+
+TEST (TimerTest, WallAndCpuTest) {
+  Timer * timer = Timer::GetInstance();
+  timer->Start();
+
+  // sleeping counts in wall time but not in cpu time
+  struct timespec req = { 0, 50000000 }; // 50 milli sec
+  nanosleep(&req, NULL);
+  long long int wall = timer->Elapsed();
+  long long int cpu = timer->CpuElapsed();
+  EXPECT_LE(50000000ll, wall);
+  EXPECT_GT(500000000ll, wall);
+  EXPECT_GT(wall / 2, cpu);
+
+  // within 5% of CLOCK_MONOTONIC
+  long long int m0 = FastClock::Monotonic(), f0 = FastClock::Now();
+  nanosleep(&req, NULL);
+  long long int m1 = FastClock::Monotonic(), f1 = FastClock::Now();
+  EXPECT_NEAR((double) (m1 - m0), (double) (f1 - f0), 0.05 * (m1 - m0));
+}
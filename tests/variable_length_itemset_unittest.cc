@@ -29,6 +29,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <stdexcept>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -348,6 +350,59 @@ TEST (VariableLengthItemsetTest, SplitTestOne) {
   delete dst;
 }
 
+TEST (VariableLengthItemsetTest, SplitSelectTest) {
+  VariableLengthItemsetStack * src;
+  src = new VariableLengthItemsetStack(32); // capacity
+  VariableLengthItemsetStack * dst;
+  dst = new VariableLengthItemsetStack(32); // capacity
+  int * p;
+
+  // itemsets {0}, {1,2}, {3}, {4,5,6} with sup 4, 3, 2, 1
+  int items[][3] = { { 0 }, { 1, 2 }, { 3 }, { 4, 5, 6 } };
+  int nums[] = { 1, 2, 1, 3 };
+  for (int i = 0; i < 4; i++) {
+    src->PushPre();
+    p = src->Top();
+    for (int j = 0; j < nums[i]; j++)
+      src->PushOneItem(items[i][j]);
+    src->SetSup(p, 4 - i);
+    src->PushPost();
+  }
+  EXPECT_EQ(4, src->NuItemset());
+
+  std::vector<bool> give(4, false);
+  give[0] = true;
+  give[2] = true;
+  EXPECT_EQ(2, src->SplitSelect(dst, give));
+
+  EXPECT_EQ(2, src->NuItemset());
+  EXPECT_EQ(3 + (2 + 2) + (2 + 3), src->UsedCapacity());
+  p = src->FirstItemset();
+  EXPECT_EQ(3, src->GetSup(p));
+  EXPECT_EQ(2, src->GetItemNum(p));
+  p = src->NextItemset(p);
+  EXPECT_EQ(1, src->GetSup(p));
+  EXPECT_EQ(6, src->GetNthItem(p, 2));
+  EXPECT_EQ(p, src->Top());
+  EXPECT_EQ(NULL, src->NextItemset(p));
+
+  EXPECT_EQ(2, dst->NuItemset());
+  EXPECT_EQ(3 + (2 + 1) + (2 + 1), dst->UsedCapacity());
+  p = dst->FirstItemset();
+  EXPECT_EQ(4, dst->GetSup(p));
+  p = dst->NextItemset(p);
+  EXPECT_EQ(2, dst->GetSup(p));
+  EXPECT_EQ(3, dst->GetNthItem(p, 0));
+
+  // pop still works on the compacted stack
+  src->Pop();
+  EXPECT_EQ(1, src->NuItemset());
+  EXPECT_EQ(3, src->GetSup(src->Top()));
+
+  delete src;
+  delete dst;
+}
+
 TEST (VariableLengthItemsetTest, MergeTest) {
   VariableLengthItemsetStack * src;
   src = new VariableLengthItemsetStack(20); // capacity
@@ -527,6 +582,184 @@ TEST (VariableLengthItemsetTest, MergeStackTest) {
   delete dst;
 }
 
+namespace {
+// itemset {i, i + 1} with sup i
+int * PushPair(VariableLengthItemsetStack * s, int i) {
+  s->PushPre();
+  int * p = s->Top();
+  s->PushOneItem(i);
+  s->PushOneItem(i + 1);
+  s->SetSup(p, i);
+  s->PushPostNoSort();
+  return p;
+}
+}
+
+TEST (VariableLengthItemsetTest, SegmentedTest) {
+  // room for 2 itemsets of 3 items per segment
+  VariableLengthItemsetStack s(VariableLengthItemsetStack::SEGMENTED, 16,
+                               1000, 3);
+  std::vector<int *> sets;
+  std::vector<long long int> offsets;
+  for (int i = 0; i < 20; i++) {
+    sets.push_back(PushPair(&s, i));
+    offsets.push_back(s.Offset(sets.back()));
+  }
+  EXPECT_EQ(20, s.NuItemset());
+  EXPECT_LT(16 * (long long int)sizeof(int), s.Bytes());
+
+  // pointers stay valid
+  for (int i = 0; i < 20; i++) {
+    EXPECT_EQ(i, s.GetSup(sets[i]));
+    EXPECT_EQ(i + 1, s.GetNthItem(sets[i], 1));
+    EXPECT_EQ(sets[i], s.At(offsets[i]));
+  }
+  int i = 0;
+  for (int * p = s.FirstItemset(); p != NULL; p = s.NextItemset(p))
+    EXPECT_EQ(i++, s.GetSup(p));
+  EXPECT_EQ(20, i);
+
+  std::vector<int> all;
+  s.CopyItemsets(&all);
+  EXPECT_EQ(20u * 4u, all.size());
+  VariableLengthItemsetStack copy(100);
+  EXPECT_TRUE(copy.MergeStack(&(all[0]), all.size()));
+  EXPECT_EQ(20, copy.NuItemset());
+  EXPECT_EQ(19, copy.GetSup(copy.Top()));
+
+  for (int i = 19; i >= 0; i--) {
+    EXPECT_EQ(i, s.GetSup(s.Top()));
+    s.Pop();
+  }
+  EXPECT_TRUE(s.Empty());
+  EXPECT_EQ(3, s.UsedCapacity());
+  EXPECT_EQ(NULL, s.FirstItemset());
+
+  // reused after pop
+  PushPair(&s, 7);
+  EXPECT_EQ(7, s.GetSup(s.FirstItemset()));
+}
+
+TEST (VariableLengthItemsetTest, SegmentedSplitTest) {
+  VariableLengthItemsetStack src(VariableLengthItemsetStack::SEGMENTED, 16,
+                                 1000, 3);
+  VariableLengthItemsetStack dst(VariableLengthItemsetStack::CONTIGUOUS, 16,
+                                 1000, 3);
+  for (int i = 0; i < 20; i++)
+    PushPair(&src, i);
+  EXPECT_EQ(10, src.Split(&dst));
+  EXPECT_EQ(10, src.NuItemset());
+  EXPECT_EQ(10, dst.NuItemset());
+  EXPECT_EQ(3 + 10 * 4, dst.UsedCapacity());
+
+  int i = 0;
+  for (int * p = src.FirstItemset(); p != NULL; p = src.NextItemset(p)) {
+    EXPECT_EQ(2 * i, src.GetSup(p));
+    EXPECT_EQ(2 * i + 1, src.GetNthItem(p, 1));
+    i++;
+  }
+  EXPECT_EQ(10, i);
+  i = 0;
+  for (int * p = dst.FirstItemset(); p != NULL; p = dst.NextItemset(p))
+    EXPECT_EQ(2 * (i++) + 1, dst.GetSup(p));
+
+  // the compacted stack grows and pops as before
+  PushPair(&src, 100);
+  EXPECT_EQ(100, src.GetSup(src.Top()));
+  src.Pop();
+  for (int i = 9; i >= 0; i--) {
+    EXPECT_EQ(2 * i, src.GetSup(src.Top()));
+    src.Pop();
+  }
+  EXPECT_TRUE(src.Empty());
+}
+
+TEST (VariableLengthItemsetTest, ContiguousTest) {
+  VariableLengthItemsetStack s(VariableLengthItemsetStack::CONTIGUOUS, 16,
+                               1000, 3);
+  for (int i = 0; i < 20; i++)
+    PushPair(&s, i);
+  EXPECT_EQ(3 + 20 * 4, s.UsedCapacity());
+
+  // still one array
+  VariableLengthItemsetStack copy(100);
+  EXPECT_TRUE(copy.MergeStack(s.Stack() + VariableLengthItemsetStack::SENTINEL + 1,
+                              s.UsedCapacity() - VariableLengthItemsetStack::SENTINEL - 1));
+  EXPECT_EQ(20, copy.NuItemset());
+
+  s.Reserve(500);
+  EXPECT_EQ(19, s.GetSup(s.Top()));
+  EXPECT_EQ(500 * (long long int)sizeof(int), s.Bytes());
+  EXPECT_THROW(s.Reserve(2000), std::runtime_error);
+}
+
+TEST (VariableLengthItemsetTest, FullTest) {
+  VariableLengthItemsetStack s(VariableLengthItemsetStack::SEGMENTED, 16, 40,
+                               3);
+  EXPECT_THROW({
+      for (int i = 0; i < 20; i++)
+        PushPair(&s, i);
+    }, std::runtime_error);
+  EXPECT_GE(40, s.UsedCapacity());
+}
+
+TEST (VariableLengthItemsetTest, FullMergeTest) {
+  // 8 itemsets fill 36 of 40, the 9th needs a new segment
+  VariableLengthItemsetStack s(VariableLengthItemsetStack::SEGMENTED, 16, 40,
+                               10);
+  for (int i = 0; i < 8; i++)
+    PushPair(&s, i);
+  EXPECT_EQ(36, s.UsedCapacity());
+
+  VariableLengthItemsetStack give(100);
+  PushPair(&give, 100);
+  // the items fit, the segment reserve does not: nothing is pushed
+  EXPECT_FALSE(s.MergeStack(give.Stack() + VariableLengthItemsetStack::SENTINEL + 1,
+                            give.UsedCapacity() - VariableLengthItemsetStack::SENTINEL - 1));
+  EXPECT_FALSE(s.Merge(&give));
+  EXPECT_EQ(8, s.NuItemset());
+  EXPECT_EQ(36, s.UsedCapacity());
+  EXPECT_EQ(7, s.GetSup(s.Top()));
+
+  // room again after pops
+  s.Pop();
+  s.Pop();
+  EXPECT_TRUE(s.Merge(&give));
+  EXPECT_EQ(7, s.NuItemset());
+  EXPECT_EQ(100, s.GetSup(s.Top()));
+}
+
+TEST (VariableLengthItemsetTest, SpillTest) {
+  VariableLengthItemsetStack s(VariableLengthItemsetStack::SEGMENTED, 16,
+                               1000, 3);
+  ASSERT_TRUE(s.Spill("variable_length_itemset_unittest.spill"));
+  std::vector<long long int> offsets;
+  for (int i = 0; i < 20; i++)
+    offsets.push_back(s.Offset(PushPair(&s, i)));
+  EXPECT_LT(0, s.SpilledBytes());
+  // the first and the current segment
+  EXPECT_EQ(2 * 16 * (long long int)sizeof(int), s.Bytes());
+
+  for (int i = 0; i < 20; i++) {
+    const int * p = s.At(offsets[i]);
+    EXPECT_EQ(i, s.GetSup(p));
+    EXPECT_EQ(2, s.GetItemNum(p));
+    EXPECT_EQ(i + 1, s.GetNthItem(p, 1));
+  }
+  std::vector<int> all;
+  s.CopyItemsets(&all);
+  ASSERT_EQ(20u * 4u, all.size());
+  for (int i = 0; i < 20; i++)
+    EXPECT_EQ(i, all[4 * i + VariableLengthItemsetStack::SUP]);
+
+  // pop reads the segments back
+  for (int i = 19; i >= 0; i--) {
+    EXPECT_EQ(i, s.GetSup(s.Top()));
+    s.Pop();
+  }
+  EXPECT_TRUE(s.Empty());
+}
+
 /* Local Variables:  */
 /* compile-command: "scons -u" */
 /* End:              */